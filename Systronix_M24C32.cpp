@@ -1,4 +1,6 @@
+#if defined (ARDUINO)
 #include <Arduino.h>
+#endif
 #include <Systronix_M24C32.h>
 
 
@@ -10,7 +12,30 @@
 Systronix_M24C32::Systronix_M24C32 (void)
 	{
 	_base = EEP_BASE_MIN;
-	error.total_error_count = 0;				// clear the error counter
+	_part = EEP_M24C32;
+	_addr = 0;
+#if defined (ARDUINO)
+	_wire = &_i2c_t3;							// Wire until setup() says otherwise
+#else
+	_wire = NULL;								// host: setup() must supply a transport
+#endif
+#if EEP_INSTRUMENT
+	_meter.bus_set (_wire);
+	if (_wire)
+		_wire = &_meter;
+	_instr_depth = 0;
+	_poll_spins = 0;
+	instr_clear ();
+#endif
+	_write_pending = false;						// no write cycle in progress
+	_ptr = 0;
+	_ptr_valid = false;							// device pointer unknown until a read sets it
+	_ptr_epoch = 0;
+	_tw_ms = EEP_TW_MS;
+	_compare = false;
+	_queue_head = 0;
+	_queue_count = 0;
+	memset (&stats, 0, sizeof(stats));
 	}
 
 
@@ -31,7 +56,22 @@ Systronix_M24C32::~Systronix_M24C32 (void)
 // redundant and some params must be effectively specified again in begin (Wire net and pins are not independent).	what parameters are specified again? [wsk]
 //
 
-uint8_t Systronix_M24C32::setup (uint8_t base, i2c_t3 wire, char* name)
+#if defined (ARDUINO)
+uint8_t Systronix_M24C32::setup (uint8_t base, i2c_t3& wire, char* name)
+	{
+	_i2c_t3.bus_set (wire);				// the i2c_t3 transport refers to wire; it does not copy it
+	return setup (base, _i2c_t3, name);
+	}
+#endif
+
+
+//---------------------------< S E T U P   ( T R A N S P O R T ) >--------------------------------------------
+//
+// bind this instance to any Systronix_M24C32_transport: the i2c_t3 transport on target or the simulated bus
+// on the host.
+//
+
+uint8_t Systronix_M24C32::setup (uint8_t base, Systronix_M24C32_transport& transport, char* name)
 	{
 	if ((EEP_BASE_MIN > base) || (EEP_BASE_MAX < base))
 		{
@@ -40,8 +80,13 @@ uint8_t Systronix_M24C32::setup (uint8_t base, i2c_t3 wire, char* name)
 		}
 
 	_base = base;
-	_wire = wire;
+	_wire = &transport;
+#if EEP_INSTRUMENT
+	_meter.bus_set (&transport);
+	_wire = &_meter;							// count the traffic on its way to the transport
+#endif
 	_wire_name = wire_name = name;		// protected and public
+	_ptr_valid = false;
 	return SUCCESS;
 	}
 
@@ -53,9 +98,8 @@ uint8_t Systronix_M24C32::setup (uint8_t base, i2c_t3 wire, char* name)
 
 void Systronix_M24C32::begin (i2c_pins pins, i2c_rate rate)
 	{
-	_wire.begin (I2C_MASTER, 0x00, pins, I2C_PULLUP_EXT, rate);	// join I2C as master
-//	Serial.printf ("275 lib begin %s\r\n", _wire_name);
-	_wire.setDefaultTimeout (200000); 							// 200ms
+	_wire->begin (pins, rate);									// join I2C as master; transport sets its own timeout
+	_ptr_valid = false;
 	}
 
 
@@ -66,7 +110,8 @@ void Systronix_M24C32::begin (i2c_pins pins, i2c_rate rate)
 
 void Systronix_M24C32::begin (void)
 	{
-	_wire.begin();				// initialize I2C as master
+	_wire->begin();				// initialize I2C as master
+	_ptr_valid = false;
 	}
 
 
@@ -89,6 +134,7 @@ uint8_t Systronix_M24C32::base_get(void)
 uint8_t Systronix_M24C32::init (void)
 	{
 	error.exists = true;					// necessary to presume that the device exists
+	_ptr_valid = false;						// power cycle or another master may have moved it
 
 	if (SUCCESS != ping_eeprom())
 		{
@@ -100,6 +146,76 @@ uint8_t Systronix_M24C32::init (void)
 	}
 
 
+//---------------------------< P A R T _ S E T >--------------------------------------------------------------
+//
+// Set the device geometry (one of the EEP_M24Cxx parts in Systronix_M24C32_parts.h); call after setup().
+// Sets the write cycle time to the part's tW.  A part with block bits answers at 2, 4, or 8 consecutive slave
+// addresses beginning at _base; _base must be aligned to that many and they must all lie within 0x50 - 0x57.
+//
+
+uint8_t Systronix_M24C32::part_set (const struct eep_part& part)
+	{
+	uint8_t	blocks = 1 << part.block_bits;
+
+	if ((EEP_PAGE_MAX < part.page_size) || (3 < part.block_bits) || (_base & (blocks - 1)) || (EEP_BASE_MAX < (_base + blocks - 1)))
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+		return DENIED;
+		}
+
+	_part = part;
+	_tw_ms = part.tw_ms;
+	_ptr_valid = false;
+	return set_addr (0);
+	}
+
+
+//---------------------------< S L A V E >--------------------------------------------------------------------
+//
+// slave address for a transaction at _addr: on parts with block bits the memory address bits above the
+// address bytes replace the low bits of _base
+//
+
+uint8_t Systronix_M24C32::slave (void)
+	{
+	return _base | ((_addr >> (8 * _part.addr_bytes)) & ((1 << _part.block_bits) - 1));
+	}
+
+
+//---------------------------< A D D R _ P U T >--------------------------------------------------------------
+//
+// put the memory address (both bytes of control.addr, or only the low byte on one-address-byte parts) in the
+// tx buffer; returns the number of bytes added.  Every transaction that sends a memory address comes through
+// here so this is where the device pointer model is dropped; a read that completes sets it again.
+//
+
+size_t Systronix_M24C32::addr_put (void)
+	{
+	_ptr_valid = false;
+	return _wire->write (&control.addr.as_array[2 - _part.addr_bytes], _part.addr_bytes);
+	}
+
+
+//---------------------------< S E T _ A D D R >--------------------------------------------------------------
+//
+// Set the full memory address (up to 18 bits on the M24M02).  The low 16 bits are also kept in control.addr;
+// bits above the address bytes go out as block bits in the slave address; see slave().
+//
+
+uint8_t Systronix_M24C32::set_addr (uint32_t addr)
+	{
+	if (_part.size <= addr)
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+		return DENIED;										// memory address out of bounds
+		}
+
+	_addr = addr;
+	control.addr.as_u16 = __builtin_bswap16 ((uint16_t)addr);	// byte swap and set the address
+	return SUCCESS;
+	}
+
+
 //---------------------------< S E T _ A D D R 1 6 >----------------------------------------------------------
 //
 // byte order is important.  In Teensy memory, a uint16_t is stored least-significant byte in the lower of two
@@ -113,17 +229,12 @@ uint8_t Systronix_M24C32::init (void)
 //		eep.control.addr_as_array[0]:		0x01
 //		eep.control.addr_as_array[1]:		0x23
 //
+// Addresses above 0xFFFF (M24M01, M24M02) need set_addr().
+//
 
 uint8_t Systronix_M24C32::set_addr16 (uint16_t addr)
 	{
-	if (addr & (ADDRESS_MAX+1))
-		{
-		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
-		return DENIED;										// memory address out of bounds
-		}
-
-	control.addr.as_u16 = __builtin_bswap16 (addr);			// byte swap and set the address
-	return SUCCESS;
+	return set_addr (addr);
 	}
 
 
@@ -152,15 +263,14 @@ uint16_t Systronix_M24C32::get_addr16 (void)
 //
 // This function simplifies keeping track of the current eep address pointer when using current_address_read()
 // which uses the eep's internal address pointer.  Increments the address by one and makes sure that the address
-// properly wraps from 0x0FFF to 0x0000 instead of going to 0x1000.
+// properly wraps from the top of the array (0x0FFF on the M24C32) to 0x0000.
 //
 // See set_addr16() for additional explanation.
 //
 
 void Systronix_M24C32::inc_addr16 (void)
 	{
-	uint16_t addr = __builtin_bswap16 (control.addr.as_u16);
-	control.addr.as_u16 = __builtin_bswap16 ((++addr & ADDRESS_MAX));
+	set_addr ((_addr + 1) & (_part.size - 1));
 	}
 
 
@@ -168,13 +278,12 @@ void Systronix_M24C32::inc_addr16 (void)
 //
 // This function advances the current eep address pointer by rd_wr_len when using page_read() or page_write()
 // to track the eep's internal address pointer.  Advances the address and makes sure that the address
-// properly wraps from 0x0FFF to 0x0000 instead of going to 0x1000.
+// properly wraps from the top of the array (0x0FFF on the M24C32) to 0x0000.
 //
 
 void Systronix_M24C32::adv_addr16 (void)
 	{
-	uint16_t addr = __builtin_bswap16 (control.addr.as_u16);
-	control.addr.as_u16 = __builtin_bswap16 ((addr + control.rd_wr_len) & ADDRESS_MAX);
+	set_addr ((_addr + control.rd_wr_len) & (_part.size - 1));
 	}
 
 
@@ -190,8 +299,8 @@ uint8_t Systronix_M24C32::ping_eeprom (void)
 	if (!error.exists)										// exit immediately if device does not exist
 		return ABSENT;
 
-	_wire.beginTransmission(_base);							// init tx buff for xmit to slave at _base address
-	ret_val = _wire.endTransmission();						// xmit slave address
+	_wire->beginTransmission(_base);							// init tx buff for xmit to slave at _base address
+	ret_val = _wire->endTransmission();						// xmit slave address
 	if (SUCCESS != ret_val)
 		return FAIL;										// device did not ack the address
 
@@ -208,21 +317,98 @@ uint8_t Systronix_M24C32::ping_eeprom (void)
 uint8_t Systronix_M24C32::ping_eeprom_timed (uint32_t t_wait)
 	{
 	uint8_t		ret_val;
+	boolean		last = false;
 //	uint32_t	start_time = millis ();
-	uint32_t	end_time = millis () + t_wait;
-	
-	while (millis () <= end_time)
+	uint32_t	end_time = _wire->millis () + t_wait;
+
+#if EEP_INSTRUMENT
+	_poll_spins = 0;
+#endif
+	while (!last)
 		{													// spin
-		_wire.beginTransmission(_base);						// init tx buff for xmit to slave at _base address
-		ret_val = _wire.endTransmission();					// xmit slave address
+		last = (_wire->millis () > end_time);				// one poll after t_wait: on a shared bus the wait for
+		_wire->beginTransmission(_base);						// the bus itself may have used t_wait up
+		ret_val = _wire->endTransmission();					// xmit slave address
 		if (SUCCESS == ret_val)
 			return SUCCESS;
+#if EEP_INSTRUMENT
+		_poll_spins++;
+#endif
 		}
 
 	return FAIL;											// device did not ack the address within the allotted time
 	}
 
 
+//---------------------------< T W _ S E T >------------------------------------------------------------------
+//
+// set the write cycle time used by write_wait() and write(); EEP_TW_MS (5mS) by default; M24C32-X parts (1.6V-
+// 5.5V) need 10.
+//
+
+void Systronix_M24C32::tw_set (uint32_t t_wait)
+	{
+	_tw_ms = t_wait;
+	}
+
+
+//---------------------------< W R I T E _ M A R K >----------------------------------------------------------
+//
+// record that a write transaction just completed and that the device is now in its tW write cycle
+//
+
+void Systronix_M24C32::write_mark (void)
+	{
+	_write_us = _wire->micros ();
+	_write_pending = true;
+	}
+
+
+//---------------------------< W R I T E _ B U S Y >----------------------------------------------------------
+//
+// returns true while a write cycle started by this instance may still be running: a write was issued less
+// than tW ago and the device has not since acked an ack poll.
+//
+
+boolean Systronix_M24C32::write_busy (void)
+	{
+	if (!_write_pending)
+		return false;
+
+	if ((uint32_t)(_wire->micros () - _write_us) >= (_tw_ms * 1000))
+		_write_pending = false;								// tW has certainly elapsed
+
+	return _write_pending;
+	}
+
+
+//---------------------------< W R I T E _ W A I T >----------------------------------------------------------
+//
+// Ack poll the device only when a write cycle may still be running.  When the most recent write is more than
+// tW in the past the poll is skipped and the caller goes straight to its address phase; each skipped poll is
+// one or more transactions saved and is counted in stats.polls_skipped.
+//
+
+uint8_t Systronix_M24C32::write_wait (void)
+	{
+	if (!write_busy ())
+		{
+		stats.polls_skipped++;
+		return SUCCESS;
+		}
+
+	stats.polls_sent++;
+	if (SUCCESS != ping_eeprom_timed (_tw_ms))
+		return FAIL;
+#if EEP_INSTRUMENT
+	instr_wait (_poll_spins);
+#endif
+
+	_write_pending = false;									// device acked; write cycle complete
+	return SUCCESS;
+	}
+
+
 //---------------------------< B Y T E _ W R I T E >----------------------------------------------------------
 // TODO: make this work
 // i2c_t3 error returns
@@ -246,33 +432,36 @@ uint8_t Systronix_M24C32::byte_write (void)
 	{
 	uint8_t ret_val;
 	
+	EEP_OP_SCOPE (EEP_OP_BYTE_WRITE, 1);
+
 	if (!error.exists)										// exit immediately if device does not exist
-		return ABSENT;
+		EEP_OP_RETURN (ABSENT);
 
-	if (SUCCESS != ping_eeprom_timed ())					// device should become available within the next 5mS
+	if (SUCCESS != write_wait ())							// ack poll only while a write cycle may still be running
 		{													// it didn't
 		i2c_common.tally_transaction (I2C_TIMEOUT, &error);					// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
 		}
 
-	_wire.beginTransmission(_base);							// init tx buff for xmit to slave at _base address
-	control.bytes_written = _wire.write (control.addr.as_array, 2);	// put the memory address in the tx buffer
-	control.bytes_written += _wire.write (control.wr_byte);			// add data byte to the tx buffer
-	if (3 != control.bytes_written)
+	_wire->beginTransmission (slave ());					// init tx buff for xmit to slave at _base address
+	control.bytes_written = addr_put ();					// put the memory address in the tx buffer
+	control.bytes_written += _wire->write (control.wr_byte);			// add data byte to the tx buffer
+	if ((_part.addr_bytes + 1U) != control.bytes_written)
 		{
 		i2c_common.tally_transaction (WR_INCOMPLETE, &error);					// only here 0 is error value since we expected to write more than 0 bytes
-		return FAIL;
+		EEP_OP_RETURN (FAIL);
 		}
 
-	ret_val = _wire.endTransmission();						// xmit memory address and data byte
+	ret_val = _wire->endTransmission();						// xmit memory address and data byte
 	if (SUCCESS != ret_val)
 		{
 		i2c_common.tally_transaction (ret_val, &error);						// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
 		}
+	write_mark ();											// tW starts now
 
 	i2c_common.tally_transaction (SUCCESS, &error);
-	return SUCCESS;
+	EEP_OP_RETURN (SUCCESS);
 	}
 
 
@@ -320,8 +509,8 @@ uint8_t Systronix_M24C32::int32_write (void)
 
 //---------------------------< P A G E _ W R I T E >----------------------------------------------------------
 // TODO make this work
-// writes an array of control.rd_wr_len number of bytes to eep beginning at address in control.addr.  32 bytes
-// per page write max
+// writes an array of control.rd_wr_len number of bytes to eep beginning at address in control.addr.  One page
+// (page_size() bytes; 32 on the M24C32) per page write max
 //
 // To use this function:
 //		1. use set_addr16 (addr) to set the address in the control.addr union
@@ -332,36 +521,44 @@ uint8_t Systronix_M24C32::int32_write (void)
 
 uint8_t Systronix_M24C32::page_write (void)
 	{
-	uint8_t ret_val;
+	uint8_t		ret_val;
+	uint32_t	addr;
+
+	EEP_OP_SCOPE (EEP_OP_PAGE_WRITE, control.rd_wr_len);
 
 	if (!error.exists)										// exit immediately if device does not exist
-		return ABSENT;
+		EEP_OP_RETURN (ABSENT);
+
+	addr = _addr;
+	if (_compare && (_part.page_size >= ((addr & (_part.page_size-1)) + control.rd_wr_len)))
+		EEP_OP_RETURN (compare_write (addr, control.wr_buf_ptr, control.rd_wr_len));	// does not cross a page; skip what matches
 	
-	if (SUCCESS != ping_eeprom_timed ())					// device should become available within the next 5mS
+	if (SUCCESS != write_wait ())							// ack poll only while a write cycle may still be running
 		{													// it didn't
 		i2c_common.tally_transaction (I2C_TIMEOUT, &error);					// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
 		}
 
-	_wire.beginTransmission(_base);							// init tx buff for xmit to slave at _base address
-	control.bytes_written = _wire.write (control.addr.as_array, 2);					// put the memory address in the tx buffer
-	control.bytes_written += _wire.write (control.wr_buf_ptr, control.rd_wr_len);	// copy source to wire tx buffer data
-	if (control.bytes_written < (2 + control.rd_wr_len))	// did we try to write too many bytes to the i2c_t3 tx buf?
+	_wire->beginTransmission (slave ());					// init tx buff for xmit to slave at _base address
+	control.bytes_written = addr_put ();					// put the memory address in the tx buffer
+	control.bytes_written += _wire->write (control.wr_buf_ptr, control.rd_wr_len);	// copy source to wire tx buffer data
+	if (control.bytes_written < (_part.addr_bytes + control.rd_wr_len))	// did we try to write too many bytes to the i2c_t3 tx buf?
 		{
 		i2c_common.tally_transaction (WR_INCOMPLETE, &error);					// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
 		}
 		
-	ret_val = _wire.endTransmission();						// xmit memory address followed by data
+	ret_val = _wire->endTransmission();						// xmit memory address followed by data
 	if (SUCCESS != ret_val)
 		{
 		i2c_common.tally_transaction (ret_val, &error);						// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
 		}
+	write_mark ();											// tW starts now
 	adv_addr16 ();											// advance our copy of the address
 
 	i2c_common.tally_transaction (SUCCESS, &error);
-	return SUCCESS;
+	EEP_OP_RETURN (SUCCESS);
 	}
 
 
@@ -384,29 +581,38 @@ uint8_t Systronix_M24C32::page_write (void)
 uint8_t Systronix_M24C32::current_address_read (void)
 	{
 	uint8_t ret_val;
+	boolean	known = ptr_known ();
+
+	EEP_OP_SCOPE (EEP_OP_CURRENT_READ, 1);
 
 	if (!error.exists)										// exit immediately if device does not exist
-		return ABSENT;
+		EEP_OP_RETURN (ABSENT);
 	
-	control.bytes_received = _wire.requestFrom(_base, 1, I2C_STOP);
+	_ptr_valid = false;										// until the byte arrives
+	control.bytes_received = _wire->requestFrom (slave (), 1, I2C_STOP);
 	if (1 != control.bytes_received)						// if we got more than or less than 1 byte
 		{
-		ret_val = _wire.status();							// to get error value
+		ret_val = _wire->status();							// to get error value
 		i2c_common.tally_transaction (ret_val, &error);						// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
 		}
 
-	control.rd_byte = _wire.readByte();						// get the byte
+	control.rd_byte = _wire->readByte();						// get the byte
 	inc_addr16 ();											// bump our copy of the address
+	if (known)
+		{
+		ptr_set ((_ptr + 1) & (_part.size - 1));			// the device's pointer moved on by one
+		}
 
 	i2c_common.tally_transaction (SUCCESS, &error);
-	return SUCCESS;
+	EEP_OP_RETURN (SUCCESS);
 	}
 
 
 //---------------------------< B Y T E _ R E A D >------------------------------------------------------------
 //
-// Read a byte from a specified address.
+// Read a byte from a specified address.  No address phase when the device pointer is known to be there
+// already; see read().
 //
 // To use this function:
 //		1. use set_addr16 (addr) to set the address in the control.addr union
@@ -418,32 +624,41 @@ uint8_t Systronix_M24C32::byte_read (void)
 	{
 	uint8_t ret_val;
 
+	EEP_OP_SCOPE (EEP_OP_BYTE_READ, 1);
+
 	if (!error.exists)										// exit immediately if device does not exist
-		return ABSENT;
+		EEP_OP_RETURN (ABSENT);
 
-	if (SUCCESS != ping_eeprom_timed ())					// device should become available within the next 5mS
+	if (SUCCESS != write_wait ())							// ack poll only while a write cycle may still be running
 		{													// it didn't
 		i2c_common.tally_transaction (I2C_TIMEOUT, &error);					// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
 		}
 
-	_wire.beginTransmission(_base);							// init tx buff for xmit to slave at _base address
-	control.bytes_written = _wire.write (control.addr.as_array, 2);	// put the memory address in the tx buffer
-	if (2 != control.bytes_written)							// did we get correct number of bytes into the i2c_t3 tx buf?
+	if (ptr_at ())
+		{
+		stats.addr_skipped++;								// device pointer is already at control.addr
+		EEP_OP_RETURN (current_address_read ());
+		}
+
+	_wire->beginTransmission (slave ());					// init tx buff for xmit to slave at _base address
+	control.bytes_written = addr_put ();					// put the memory address in the tx buffer
+	if (_part.addr_bytes != control.bytes_written)							// did we get correct number of bytes into the i2c_t3 tx buf?
 		{
 		i2c_common.tally_transaction (WR_INCOMPLETE, &error);					// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
 		}
 
-	ret_val = _wire.endTransmission();						// xmit memory address; will fail if device is busy
+	ret_val = _wire->endTransmission();						// xmit memory address; will fail if device is busy
 	
 	if (SUCCESS != ret_val)
 		{
 		i2c_common.tally_transaction (ret_val, &error);						// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
 		}
-	
-	return current_address_read ();							// use current_address_read() to fetch the byte
+
+	ptr_set (_addr);										// the device pointer is now at control.addr
+	EEP_OP_RETURN (current_address_read ());				// use current_address_read() to fetch the byte
 	}
 
 
@@ -495,6 +710,8 @@ uint8_t Systronix_M24C32::int32_read (void)
 // a single operation is limited by the I2C_RX_BUFFER_LENGTH #define in i2c_t3.h.  Setting control.rd_wr_len to
 // 256 is a convenient max (max size of the i2c_t3 buffer).
 //
+// No address phase when the device pointer is known to be there already; see read().
+//
 // To use this function:
 //		1. use set_addr16 (addr) to set the address in the control.addr union
 //		2. set control.rd_wr_len to the number of bytes to be read
@@ -505,47 +722,396 @@ uint8_t Systronix_M24C32::int32_read (void)
 uint8_t Systronix_M24C32::page_read (void)
 	{
 	uint8_t		ret_val;
-	size_t 		i;
 	uint8_t*	ptr = control.rd_buf_ptr;					// a copy so we don't disturb the original
 
+	EEP_OP_SCOPE (EEP_OP_PAGE_READ, control.rd_wr_len);
+
 	if (!error.exists)										// exit immediately if device does not exist
-		return ABSENT;
+		EEP_OP_RETURN (ABSENT);
 
-	if (SUCCESS != ping_eeprom_timed ())					// device should become available within the next 5mS
+	if (SUCCESS != write_wait ())							// ack poll only while a write cycle may still be running
 		{													// it didn't
 		i2c_common.tally_transaction (I2C_TIMEOUT, &error);					// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
 		}
 
-	_wire.beginTransmission(_base);							// init tx buff for xmit to slave at _base address
-	control.bytes_written = _wire.write (control.addr.as_array, 2);	// put the memory address in the tx buffer
-	if (2 != control.bytes_written)							// did we get correct number of bytes into the i2c_t3 tx buf?
+	if (ptr_at ())
 		{
-		i2c_common.tally_transaction (WR_INCOMPLETE, &error);					// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		stats.addr_skipped++;								// device pointer is already at control.addr; current address read
+		_ptr_valid = false;									// until the read completes
+		}
+	else
+		{
+		_wire->beginTransmission (slave ());				// init tx buff for xmit to slave at _base address
+		control.bytes_written = addr_put ();				// put the memory address in the tx buffer
+		if (_part.addr_bytes != control.bytes_written)		// did we get correct number of bytes into the i2c_t3 tx buf?
+			{
+			i2c_common.tally_transaction (WR_INCOMPLETE, &error);				// increment the appropriate counter
+			EEP_OP_RETURN (FAIL);							// calling function decides what to do with the error
+			}
+
+		ret_val = _wire->endTransmission (I2C_NOSTOP);		// xmit memory address
+
+		if (SUCCESS != ret_val)
+			{
+			i2c_common.tally_transaction (ret_val, &error);					// increment the appropriate counter
+			EEP_OP_RETURN (FAIL);							// calling function decides what to do with the error
+			}
 		}
 
-	ret_val = _wire.endTransmission (I2C_NOSTOP);			// xmit memory address
+	control.bytes_received = _wire->requestFrom (slave (), control.rd_wr_len, I2C_STOP);	// read the bytes
+	if (control.bytes_received != control.rd_wr_len)
+		{
+		ret_val = _wire->status();							// to get error value
+		i2c_common.tally_transaction (ret_val, &error);						// increment the appropriate counter
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
+		}
 
+	_wire->read (ptr, control.rd_wr_len);					// copy wire rx buffer data to destination
+
+	adv_addr16 ();											// advance our copy of the address
+	ptr_set (_addr);										// and the device's, which followed the read
+
+	i2c_common.tally_transaction (SUCCESS, &error);
+	EEP_OP_RETURN (SUCCESS);
+	}
+
+
+//---------------------------< W R I T E >--------------------------------------------------------------------
+//
+// Writes len bytes from buf to eep beginning at addr.  Any length (to the top of the array) and any alignment
+// are allowed; the data are split into chunks that do not cross a page boundary so that nothing wraps
+// inside a page.  Each chunk is its own write cycle.
+//
+// There is no separate ack poll before each chunk.  Instead, chunk_write() sends the whole chunk and, if the
+// device nacks its slave address because the previous chunk's tW is still running, sends it again.  The next
+// chunk therefore goes out on the first address phase that the device acks.
+//
+// control.addr is left pointing at the location following the last byte written.
+//
+// returns:
+//		SUCCESS when all bytes were written
+//		ABSENT when the device failed the detection test in init()
+//		DENIED when addr + len runs past the end of the array
+//		FAIL when the i2c_t3 library reports an error
+//
+
+uint8_t Systronix_M24C32::write (uint32_t addr, const uint8_t* buf, size_t len)
+	{
+	uint8_t	ret_val;
+	size_t	chunk;
+
+	EEP_OP_SCOPE (EEP_OP_WRITE, len);
+
+	if (!error.exists)										// exit immediately if device does not exist
+		EEP_OP_RETURN (ABSENT);
+
+	if ((_part.size <= addr) || ((size_t)(_part.size - addr) < len))
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+		EEP_OP_RETURN (DENIED);								// write would run off the end of the array
+		}
+
+	while (len)
+		{
+		chunk = _part.page_size - (addr & (_part.page_size-1));	// room left in this page
+		if (chunk > len)
+			chunk = len;
+
+		if (_compare)
+			ret_val = compare_write (addr, buf, chunk);		// skip what already matches
+		else
+			ret_val = chunk_write (addr, buf, chunk);
+		if (SUCCESS != ret_val)
+			EEP_OP_RETURN (FAIL);							// chunk_write() has tallied the error
+
+		crc_run (buf, chunk);
+		addr += chunk;
+		buf += chunk;
+		len -= chunk;
+		}
+
+	EEP_OP_RETURN (SUCCESS);
+	}
+
+
+//---------------------------< P A G E _ P U T >--------------------------------------------------------------
+//
+// Fast path for the typed write() templates: len bytes known (at compile time or by page_fit()) to lie within a
+// single page and inside the array, so there is no range check and no split loop.
+//
+
+uint8_t Systronix_M24C32::page_put (uint32_t addr, const uint8_t* buf, size_t len)
+	{
+	uint8_t		ret_val;
+
+	EEP_OP_SCOPE (EEP_OP_WRITE, len);
+
+	if (!error.exists)										// exit immediately if device does not exist
+		EEP_OP_RETURN (ABSENT);
+
+	if (_compare)
+		ret_val = compare_write (addr, buf, len);			// skip what already matches
+	else
+		ret_val = chunk_write (addr, buf, len);
 	if (SUCCESS != ret_val)
+		EEP_OP_RETURN (ret_val);							// chunk_write() has tallied the error
+
+	crc_run (buf, len);										// as write(): only data that went out
+	EEP_OP_RETURN (SUCCESS);
+	}
+
+
+//---------------------------< C H U N K _ W R I T E >--------------------------------------------------------
+//
+// Write len bytes that lie within a single page.  The write transaction doubles as the ack poll: an address
+// nack (endTransmission() returns 2) means that the device is still in tW so the same transaction is sent
+// again until the device acks or tW (EEP_TW_MS unless set with tw_set()) expires.  Any other failure is reported immediately.
+//
+
+uint8_t Systronix_M24C32::chunk_write (uint32_t addr, const uint8_t* buf, size_t len)
+	{
+	uint8_t		ret_val;
+	uint32_t	end_time;
+	uint32_t	spins = 0;								// address nacks: the device was in tW
+
+	set_addr (addr);
+	end_time = _wire->millis () + _tw_ms;
+
+	do
 		{
-		i2c_common.tally_transaction (ret_val, &error);						// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		_wire->beginTransmission (slave ());				// init tx buff for xmit to slave at _base address
+		control.bytes_written = addr_put ();				// put the memory address in the tx buffer
+		control.bytes_written += _wire->write (buf, len);	// copy source to wire tx buffer data
+		if (control.bytes_written < (_part.addr_bytes + len))
+			{
+			i2c_common.tally_transaction (WR_INCOMPLETE, &error);
+			return FAIL;
+			}
+
+		ret_val = _wire->endTransmission();					// xmit memory address followed by data
+		if (2 != ret_val)									// anything but an address nack ends the poll
+			break;
+		spins++;
 		}
+	while (_wire->millis () <= end_time);
 
-	control.bytes_received = _wire.requestFrom(_base, control.rd_wr_len, I2C_STOP);	// read the bytes
-	if (control.bytes_received != control.rd_wr_len)
+	if (2 == ret_val)										// still nacking after tW
 		{
-		ret_val = _wire.status();							// to get error value
-		i2c_common.tally_transaction (ret_val, &error);						// increment the appropriate counter
-		return FAIL;										// calling function decides what to do with the error
+		i2c_common.tally_transaction (I2C_TIMEOUT, &error);
+		return FAIL;
 		}
 
-	for (i=0;i<control.rd_wr_len; i++)						// copy wire rx buffer data to destination
-		*ptr++ = _wire.readByte();
+	if (SUCCESS != ret_val)
+		{
+		i2c_common.tally_transaction (ret_val, &error);		// increment the appropriate counter
+		return FAIL;
+		}
 
+#if EEP_INSTRUMENT
+	instr_wait (spins);										// before write_mark() moves _write_us
+#endif
+	control.rd_wr_len = len;
+	write_mark ();											// tW starts now
 	adv_addr16 ();											// advance our copy of the address
 
 	i2c_common.tally_transaction (SUCCESS, &error);
 	return SUCCESS;
 	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+//
+// Reads len bytes from eep beginning at addr into buf.  len may be anything up to the size of the array; the
+// device's address pointer rolls over from the top of the array to 0x0000 as it does for any sequential read.
+//
+// The memory address is sent once.  The data then come back in chunks of at most I2C_RX_BUFFER_LENGTH bytes;
+// every chunk but the last ends with I2C_NOSTOP so the next chunk begins with a repeated start and continues
+// from the device's auto-incremented address pointer.  No address phase is re-sent between chunks.  Each
+// chunk is bulk-copied from the i2c_t3 rx buffer into buf.
+//
+// When the driver's model of the device pointer says the pointer is already at addr (the previous read ended
+// there and nothing has written an address since) the address phase is left out too and the read is a
+// current address read: a sequential scan costs one transaction per read instead of two.  ptr_drop() forgets
+// the model when something other than this instance may have moved the pointer.  The model is also not
+// trusted once the transport's epoch() has changed, which on a bus shared through Systronix_M24C32_sched means
+// another client has had the bus since the pointer was last set.
+//
+// control.addr is left pointing at the location following the last byte read.
+//
+// returns:
+//		SUCCESS when all bytes were read
+//		ABSENT when the device failed the detection test in init()
+//		DENIED when len is larger than the array
+//		FAIL when the i2c_t3 library reports an error
+//
+
+uint8_t Systronix_M24C32::read (uint32_t addr, uint8_t* buf, size_t len)
+	{
+	return read_stream (addr, buf, len, NULL, 0);
+	}
+
+
+//---------------------------< R E A D _ S T R E A M >--------------------------------------------------------
+//
+// The body of read().  len data bytes go to buf (or, when buf is NULL, only through the running CRC by way of
+// a page-sized scratch buffer) and are followed in the same sequential read by tail_len bytes that go to tail
+// and are not included in the running CRC; crc_read() and verify() use the tail for the stored checksum.
+//
+
+uint8_t Systronix_M24C32::read_stream (uint32_t addr, uint8_t* buf, size_t len, uint8_t* tail, size_t tail_len)
+	{
+	uint8_t		ret_val;
+	uint8_t		scratch[EEP_PAGE_SIZE];
+	size_t		chunk;
+	size_t		data;
+	size_t		n;
+
+	EEP_OP_SCOPE (EEP_OP_READ, len);
+
+	if (!error.exists)										// exit immediately if device does not exist
+		EEP_OP_RETURN (ABSENT);
+
+	if (_part.size < (len + tail_len))
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+		EEP_OP_RETURN (DENIED);
+		}
+
+	if (DENIED == set_addr (addr))
+		EEP_OP_RETURN (DENIED);
+
+	if (0 == (len + tail_len))
+		EEP_OP_RETURN (SUCCESS);
+
+	if (SUCCESS != write_wait ())							// ack poll only while a write cycle may still be running
+		{													// it didn't
+		i2c_common.tally_transaction (I2C_TIMEOUT, &error);	// increment the appropriate counter
+		EEP_OP_RETURN (FAIL);								// calling function decides what to do with the error
+		}
+
+	if (ptr_at ())
+		{
+		stats.addr_skipped++;								// device pointer is already at addr; current address read
+		_ptr_valid = false;									// until the read completes
+		}
+	else
+		{
+		_wire->beginTransmission (slave ());				// init tx buff for xmit to slave at _base address
+		control.bytes_written = addr_put ();				// put the memory address in the tx buffer
+		if (_part.addr_bytes != control.bytes_written)
+			{
+			i2c_common.tally_transaction (WR_INCOMPLETE, &error);
+			EEP_OP_RETURN (FAIL);
+			}
+
+		ret_val = _wire->endTransmission (I2C_NOSTOP);		// xmit memory address; hold the bus
+		if (SUCCESS != ret_val)
+			{
+			i2c_common.tally_transaction (ret_val, &error);
+			EEP_OP_RETURN (FAIL);
+			}
+		}
+
+	while (len + tail_len)
+		{
+		chunk = ((len + tail_len) > I2C_RX_BUFFER_LENGTH) ? I2C_RX_BUFFER_LENGTH : (len + tail_len);
+
+		control.bytes_received = _wire->requestFrom (slave (), chunk, (chunk == (len + tail_len)) ? I2C_STOP : I2C_NOSTOP);
+		if (control.bytes_received != chunk)
+			{
+			ret_val = _wire->status();						// to get error value
+			i2c_common.tally_transaction (ret_val, &error);
+			EEP_OP_RETURN (FAIL);
+			}
+
+		data = (chunk > len) ? len : chunk;					// data bytes in this chunk; the rest are tail
+		if (buf)
+			{
+			_wire->read (buf, data);						// bulk copy from the wire rx buffer
+			crc_run (buf, data);							// while the bytes are still in cache
+			buf += data;
+			}
+		else
+			{
+			for (size_t i=0; i<data; i+=n)
+				{
+				n = ((data - i) > EEP_PAGE_SIZE) ? EEP_PAGE_SIZE : (data - i);
+				_wire->read (scratch, n);
+				crc_run (scratch, n);
+				}
+			}
+		if (chunk > data)
+			{
+			_wire->read (tail, chunk - data);
+			tail += chunk - data;
+			tail_len -= chunk - data;
+			}
+
+		control.rd_wr_len = chunk;
+		adv_addr16 ();										// track the device's address pointer
+		len -= data;
+		}
+
+	ptr_set (_addr);										// the device pointer followed the read
+	i2c_common.tally_transaction (SUCCESS, &error);
+	EEP_OP_RETURN (SUCCESS);
+	}
+
+
+//---------------------------< C O M P A R E _ S E T >--------------------------------------------------------
+//
+// Turn compare-before-write on or off.  When on, page_write() and write() read each target page span first,
+// skip the write entirely when the eep already holds the data, and otherwise write only the smallest
+// contiguous span that differs.  Each skipped or shortened write saves a tW and an endurance cycle at the
+// cost of reading the span.
+//
+
+void Systronix_M24C32::compare_set (boolean enable)
+	{
+	_compare = enable;
+	}
+
+
+//---------------------------< C O M P A R E _ W R I T E >----------------------------------------------------
+//
+// Write len bytes (within a single page) only where they differ from what the eep holds.  control.addr is
+// left pointing at addr + len whether or not anything was written.
+//
+
+uint8_t Systronix_M24C32::compare_write (uint32_t addr, const uint8_t* buf, size_t len)
+	{
+	uint8_t		current[EEP_PAGE_MAX];
+	size_t		lo = 0;
+	size_t		hi = len;
+	uint8_t		saved_type = _crc_type;
+
+	_crc_type = EEP_CRC_NONE;								// the compare read is not part of the running CRC
+	if (SUCCESS != read (addr, current, len))
+		{
+		_crc_type = saved_type;
+		return FAIL;										// read() has tallied the error
+		}
+	_crc_type = saved_type;
+
+	while ((lo < len) && (current[lo] == buf[lo]))			// first byte that differs
+		lo++;
+
+	if (lo == len)
+		{													// everything matches; no write at all
+		stats.writes_avoided++;
+		stats.bytes_saved += len;
+		set_addr ((addr + len) & (_part.size - 1));
+		return SUCCESS;
+		}
+
+	while (current[hi-1] == buf[hi-1])						// last byte that differs
+		hi--;
+
+	stats.bytes_saved += len - (hi - lo);
+	if (SUCCESS != chunk_write (addr + lo, buf + lo, hi - lo))
+		return FAIL;
+
+	set_addr ((addr + len) & (_part.size - 1));
+	return SUCCESS;
+	}
@@ -4,40 +4,113 @@
 
 //---------------------------< I N C L U D E S >--------------------------------------------------------------
 
+#if defined (ARDUINO)
 #include <Arduino.h>
 #include <Systronix_i2c_common.h>
+#include <Systronix_M24C32_i2c_t3.h>
+#else
+#include <Systronix_M24C32_host.h>
+#endif
+#include <Systronix_M24C32_transport.h>
+#include <Systronix_M24C32_parts.h>
+#include <Systronix_M24C32_nvram.h>
+#include <Systronix_M24C32_instr.h>
 
 
 //---------------------------< D E F I N E S >----------------------------------------------------------------
 #define RSVD_SLAVE_ID	(0xF8)
 
-#define		DENIED				0xFE
-
 #define		EEP_BASE_MIN 		0x50					// 7-bit address not including R/W bit
 #define		EEP_BASE_MAX 		0x57					// 7-bit address not including R/W bit
 
 #define		EEP_ID_BASE_MIN		0x58					// M24C32-D only; not currently supported in this code
 #define		EEP_ID_BASE_MAX		0x5F					// M24C32-D only
 
-#define		ADDRESS_MAX			0x0FFF
+#define		ADDRESS_MAX			0x0FFF					// M24C32; size() - 1 for the part set with part_set()
+
+#define		EEP_PAGE_SIZE		32						// M24C32 bytes per page; page_size() for the part set with part_set()
+#define		EEP_TW_MS			5						// write cycle time; M24C32-X parts (1.6V-5.5V) are 10
+
+#define		EEP_QUEUE_DEPTH		8						// outstanding submit_read() / submit_write() requests
+#define		EEP_POLL_US			100						// minimum interval between nacked async attempts during tW
+#define		PENDING				0xFC					// eep_request.status while queued or in progress
+
+#define		ASYNC_READ			0						// eep_request.op
+#define		ASYNC_WRITE			1
+
+#define		ASYNC_START			0						// eep_request.state; next chunk not yet started
+#define		ASYNC_ADDR			1						// read address phase on the bus
+#define		ASYNC_DATA			2						// read data or write chunk on the bus
+#define		ASYNC_TW			3						// device nacked; waiting out a write cycle
 
 
 //---------------------------< C L A S S >--------------------------------------------------------------------
 //
-//
+// the eeprom backend of Systronix_M24C32_nvram
 //
 
-class Systronix_M24C32
+class Systronix_M24C32 : public Systronix_M24C32_nvram
 	{
 	protected:
 		uint8_t		_base;								// base address, eight possible values
+		struct eep_part	_part;							// geometry; EEP_M24C32 unless changed with part_set()
+		uint32_t	_addr;								// full memory address; control.addr holds its low 16 bits
+
+		uint8_t		slave (void);						// _base plus the block bits of _addr
+		size_t		addr_put (void);					// put the 1 or 2 memory address bytes in the tx buffer
+
+		uint32_t	_ptr;								// model of the device's internal address pointer
+		boolean		_ptr_valid;							// _ptr is known; dropped by any address write, write, or error
+		uint32_t	_ptr_epoch;							// _wire->epoch() when _ptr was last set
+		boolean		ptr_known (void) {return _ptr_valid && (_wire->epoch () == _ptr_epoch);}	// and no other client has had the bus since
+		boolean		ptr_at (void) {return ptr_known () && (_ptr == _addr);}	// a read at _addr needs no address phase
+		void		ptr_set (uint32_t ptr) {_ptr = ptr; _ptr_valid = true; _ptr_epoch = _wire->epoch ();}
 
 		void		adv_addr16 (void);					// advance control.addr.u16 by control.rd_wr_len
 		void		inc_addr16 (void);					// increment control.addr.u16 by 1
 		void		tally_transaction (uint8_t);		// maintains the i2c_t3 error counters
+		uint8_t		chunk_write (uint32_t addr, const uint8_t* buf, size_t len);	// one page-bounded write; ack polls with the write itself
+
+		boolean		_write_pending;						// a write cycle may be running
+		uint32_t	_write_us;							// transport micros() when the most recent write completed
+		uint32_t	_tw_ms;								// write cycle time; EEP_TW_MS unless changed with tw_set()
+		void		write_mark (void);					// record the start of a write cycle
+		uint8_t		write_wait (void);					// ack poll only when a write cycle may still be running
+
+		boolean		_compare;							// compare-before-write; see compare_set()
+		uint8_t		compare_write (uint32_t addr, const uint8_t* buf, size_t len);	// write only what differs within one page
+		uint8_t		page_put (uint32_t addr, const uint8_t* buf, size_t len);		// single-page write; no range check, no split
+		uint8_t		read_stream (uint32_t addr, uint8_t* buf, size_t len, uint8_t* tail, size_t tail_len);	// read() plus an uncounted tail
 
 		char* 		_wire_name = (char*)"empty";
-		i2c_t3		_wire = Wire;						// why is this assigned value = Wire? [bab]
+		Systronix_M24C32_transport*	_wire;				// the bus; i2c_t3 on target, the simulator on the host
+#if defined (ARDUINO)
+		Systronix_M24C32_i2c_t3	_i2c_t3;				// default transport; refers to (does not copy) Wire, Wire1, ...
+#endif
+
+#if EEP_INSTRUMENT
+		Systronix_M24C32_meter	_meter;					// _wire points here; counts traffic and forwards to the transport
+		struct eep_instr	_instr;
+		uint8_t		_instr_depth;						// nesting of timed operations; only the outermost is recorded
+		uint32_t	_poll_spins;						// nacked polls in the most recent ping_eeprom_timed()
+
+		struct op_scope									// records one operation when it goes out of scope
+			{
+			Systronix_M24C32*	eep;
+			uint8_t		op;
+			size_t		payload;
+			uint32_t	t0_us;
+			uint32_t	bytes0;
+			uint32_t	transactions0;
+			uint8_t		ret_val;						// what the operation returned; FAIL until result()
+
+			op_scope (Systronix_M24C32* e, uint8_t o, size_t p);
+			~op_scope (void);
+			uint8_t		result (uint8_t r) {ret_val = r; return r;}
+			};
+
+		void		instr_wait (uint32_t spins);		// record an ack poll wait that ended just now
+#endif
 
 	public:
 		union eep_addr
@@ -51,10 +124,24 @@ class Systronix_M24C32
 			uint8_t			as_array[2];				// [0]: 0x12; [1]: 0x34
 			};
 
+		struct eep_request								// one submit_read() / submit_write() request
+			{
+			uint8_t				op;						// ASYNC_READ or ASYNC_WRITE
+			uint8_t				state;					// ASYNC_START ... ASYNC_TW
+			volatile uint8_t	status;					// PENDING until complete; then SUCCESS or FAIL
+			uint32_t			addr;					// eep address of the first byte
+			uint8_t*			buf;					// caller's buffer; must remain valid until complete
+			size_t				len;
+			size_t				done;					// bytes transferred so far
+			size_t				chunk;					// bytes in the transaction on the bus
+			uint32_t			t_nack;					// micros() of the most recent nacked attempt
+			void				(*callback) (struct eep_request* req);	// called on completion; may be NULL
+			};
+
 		struct
 			{
 			union eep_addr		addr;
-			uint8_t				wr_byte;				// a place to put write bytes, unit16s, and uint32s
+			uint8_t				wr_byte;				// a place to put write bytes, unit16s, and uint32s; legacy: use write<T>() and read<T>()
 			uint16_t			wr_int16;
 			uint32_t			wr_int32;
 			uint8_t				rd_byte;				// a place to put read bytes, unit16s, and uint32s
@@ -67,7 +154,15 @@ class Systronix_M24C32
 			size_t				bytes_received;			// number of bytes read by Wire.requestFrom()
 			} control;
 
-		error_t		error;								// error struct typdefed in Systronix_i2c_common.h
+		struct
+			{
+			uint32_t	polls_sent;						// write_wait() ack polls that were necessary
+			uint32_t	polls_skipped;					// ack polls (and their transactions) saved because no tW could be running
+			uint32_t	async_nacks;					// async attempts nacked because the device was in tW
+			uint32_t	writes_avoided;					// compare-before-write: writes skipped because the data matched
+			uint32_t	bytes_saved;					// compare-before-write: data bytes not written
+			uint32_t	addr_skipped;					// read address phases not sent because the device pointer was already there
+			} stats;
 
 		char*		wire_name;							// name of Wire, Wire1, etc in use
 
@@ -76,12 +171,23 @@ class Systronix_M24C32
 
 		uint8_t		base_get(void);						// return this instances _base address
 
-		uint8_t		setup (uint8_t base, i2c_t3 wire = Wire, char* name = (char*)"Wire");
+#if defined (ARDUINO)
+		uint8_t		setup (uint8_t base, i2c_t3& wire = Wire, char* name = (char*)"Wire");
+#endif
+		uint8_t		setup (uint8_t base, Systronix_M24C32_transport& transport, char* name = (char*)"transport");
 
 		void 		begin (i2c_pins pins, i2c_rate rate);
 		void		begin (void);						// default begin
 		uint8_t		init (void);						// determines if the device at _base is correct and communicating
 
+		uint8_t		part_set (const struct eep_part& part);	// device geometry; EEP_M24C32 by default
+		uint32_t	size (void) {return _part.size;}
+		uint16_t	page_size (void) {return _part.page_size;}
+		uint32_t	bus_micros (void) {return _wire->micros ();}	// the transport's clock (simulated time on the host)
+
+		uint8_t		set_addr (uint32_t addr);
+		uint32_t	get_addr (void) {return _addr;}
+		void		ptr_drop (void) {_ptr_valid = false;}	// the device pointer may have moved behind this instance's back
 		uint8_t		set_addr16 (uint16_t addr);
 		uint16_t	get_addr16 (void);
 
@@ -96,10 +202,35 @@ class Systronix_M24C32
 		uint8_t		default_byte_read (void);			// read 1 byte from eep's current address pointer
 		uint8_t		page_read (void);					// read n number of bytes beginning at address
 
+		uint8_t		write (uint32_t addr, const uint8_t* buf, size_t len);	// write any length; split at page boundaries
+		uint8_t		read (uint32_t addr, uint8_t* buf, size_t len);			// read any length up to the whole array
+		using		Systronix_M24C32_nvram::write;		// typed write<T>() and write<ADDR>()
+		using		Systronix_M24C32_nvram::read;
+
 		uint8_t		ping_eeprom (void);
-		uint8_t		ping_eeprom_timed (uint32_t t_wait = 5);	// call with t_wait for M32C32-X devices set to 10
+		uint8_t		ping_eeprom_timed (uint32_t t_wait = EEP_TW_MS);	// call with t_wait for M32C32-X devices set to 10
+		boolean		write_busy (void);					// true while a write cycle issued by this instance may be running
+		void		tw_set (uint32_t t_wait);			// write cycle time in mS; default EEP_TW_MS
+		void		compare_set (boolean enable);		// read-compare-skip for page_write() and write()
+
+#if EEP_INSTRUMENT
+		void		instr_snapshot (struct eep_instr* out);	// copy of everything measured so far
+		void		instr_clear (void);
+		void		instr_dump (void (*line) (const char* text));	// formatted report, one line per call
+#endif
+
+		struct eep_request*	submit_read (uint32_t addr, uint8_t* buf, size_t len, void (*callback) (struct eep_request*) = NULL);
+		struct eep_request*	submit_write (uint32_t addr, const uint8_t* buf, size_t len, void (*callback) (struct eep_request*) = NULL);
+		uint8_t		poll (void);						// advance the request at the head of the queue; never blocks
 
 	private:
+		struct eep_request	_queue[EEP_QUEUE_DEPTH];	// circular; _queue_head is the request on the bus
+		uint8_t		_queue_head;
+		uint8_t		_queue_count;
+
+		struct eep_request*	queue_slot (void);			// next free queue slot or NULL
+		void		async_start (struct eep_request* req);	// put the next chunk of req on the bus
+		void		async_finish (struct eep_request* req, uint8_t status);
 	};
 	
 extern Systronix_M24C32 eep;
@@ -0,0 +1,231 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_array.h>
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_array::Systronix_M24C32_array (void)
+	{
+	begin (EEP_ARRAY_STRIPE);
+	}
+
+
+//---------------------------< B E G I N >--------------------------------------------------------------------
+//
+//
+//
+
+uint8_t Systronix_M24C32_array::begin (uint8_t layout)
+	{
+	if ((EEP_ARRAY_CONCAT != layout) && (EEP_ARRAY_STRIPE != layout))
+		return DENIED;
+
+	_count = 0;
+	_layout = layout;
+	_part_size = 0;
+	_page = 0;
+	memset (&stats, 0, sizeof(stats));
+	return SUCCESS;
+	}
+
+
+//---------------------------< A D D >------------------------------------------------------------------------
+//
+// add a part that has been set up with setup() and found by init()
+//
+
+uint8_t Systronix_M24C32_array::add (Systronix_M24C32& eep)
+	{
+	if (EEP_ARRAY_MAX <= _count)
+		return DENIED;
+
+	if (!eep.error.exists)
+		return ABSENT;
+
+	if (0 == _count)
+		{
+		_part_size = eep.size ();
+		_page = eep.page_size ();
+		}
+	else if ((_part_size != eep.size ()) || (_page != eep.page_size ()))
+		return DENIED;										// parts must match
+
+	_eep[_count++] = &eep;
+	return SUCCESS;
+	}
+
+
+//---------------------------< M A P >------------------------------------------------------------------------
+//
+// return the part that holds linear address addr; *local gets the address within that part
+//
+
+uint8_t Systronix_M24C32_array::map (uint32_t addr, uint32_t* local)
+	{
+	uint32_t	page = addr / _page;
+
+	if (EEP_ARRAY_CONCAT == _layout)
+		{
+		*local = addr & (_part_size - 1);
+		return addr / _part_size;
+		}
+
+	*local = ((page / _count) * _page) + (addr & (_page-1));
+	return page % _count;
+	}
+
+
+//---------------------------< N E X T >----------------------------------------------------------------------
+//
+// Given a chunk of len bytes at linear addr that ends at or before the end of its page, return the linear
+// address of the next byte that lives on the same part: the next byte when concatenated, the start of the
+// page _count pages on when striped.
+//
+
+uint32_t Systronix_M24C32_array::next (uint32_t addr, size_t len)
+	{
+	if (EEP_ARRAY_CONCAT == _layout)
+		return addr + len;
+
+	return ((addr / _page) + _count) * _page;
+	}
+
+
+//---------------------------< W R I T E >--------------------------------------------------------------------
+//
+// Write len bytes from buf beginning at linear address addr.  Each part keeps a cursor to the next of its
+// bytes in [addr, addr + len).  Every step picks, round robin, a part with work left that is not in a write
+// cycle and sends it one page-bounded chunk; when every part with work left is in tW the next one in turn is
+// written anyway and its write ack polls until the part is ready.
+//
+// returns SUCCESS, DENIED when the write would run past the end of the array, or the failing part's return value
+//
+
+uint8_t Systronix_M24C32_array::write (uint32_t addr, const uint8_t* buf, size_t len)
+	{
+	uint32_t	cursor[EEP_ARRAY_MAX];					// linear address of each part's next byte
+	uint32_t	end = addr + len;
+	uint32_t	a;
+	uint32_t	local;
+	size_t		chunk;
+	uint8_t		part = 0;
+	uint8_t		pick;
+	uint8_t		ret_val;
+
+	if ((0 == _count) || (size () < end) || (size () < addr))
+		return DENIED;
+
+	for (uint8_t i=0; i<_count; i++)
+		cursor[i] = end;									// end: nothing to do on this part
+
+	if (EEP_ARRAY_CONCAT == _layout)
+		{
+		for (uint8_t i=0; i<_count; i++)
+			{
+			a = (uint32_t)i * _part_size;					// first byte of part i ...
+			if (a < addr)
+				a = addr;									// ... or of the range if that is later
+			if ((a < end) && (a < ((uint32_t)(i + 1) * _part_size)))
+				cursor[i] = a;
+			}
+		}
+	else
+		{
+		a = addr;
+		for (uint8_t i=0; (i<_count) && (a < end); i++)		// the first _count pages go to different parts
+			{
+			cursor[map (a, &local)] = a;
+			a = ((a / _page) + 1) * _page;
+			}
+		}
+
+	part = 0;
+	while (1)
+		{
+		pick = EEP_ARRAY_MAX;
+		for (uint8_t i=0; i<_count; i++)					// next part in turn with work left; prefer idle
+			{
+			uint8_t	p = (part + i) % _count;
+			if (cursor[p] >= end)
+				continue;
+			if (EEP_ARRAY_MAX == pick)
+				pick = p;									// first with work left; used if all are busy
+			if (!_eep[p]->write_busy ())
+				{
+				pick = p;
+				break;
+				}
+			}
+
+		if (EEP_ARRAY_MAX == pick)
+			return SUCCESS;									// nothing left anywhere
+
+		a = cursor[pick];
+		chunk = _page - (a & (_page-1));					// room left in this page
+		if (chunk > (end - a))
+			chunk = end - a;
+
+		for (uint8_t i=0; i<_count; i++)
+			if ((i != pick) && _eep[i]->write_busy ())
+				{
+				stats.overlapped++;
+				break;
+				}
+
+		map (a, &local);
+		ret_val = _eep[pick]->write (local, buf + (a - addr), chunk);
+		if (SUCCESS != ret_val)
+			return ret_val;
+		stats.page_writes++;
+
+		cursor[pick] = next (a, chunk);
+		if ((EEP_ARRAY_CONCAT == _layout) && (0 == (cursor[pick] & (_part_size - 1))))
+			cursor[pick] = end;								// ran off the end of this part
+		part = pick + 1;
+		}
+	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+//
+// Read len bytes beginning at linear address addr into buf.  A concatenated array reads each part's share in
+// one sequential read; a striped array reads a page-bounded chunk at a time.
+//
+// returns SUCCESS, DENIED when the read would run past the end of the array, or the failing part's return value
+//
+
+uint8_t Systronix_M24C32_array::read (uint32_t addr, uint8_t* buf, size_t len)
+	{
+	uint32_t	local;
+	uint8_t		part;
+	size_t		chunk;
+	uint8_t		ret_val;
+
+	if ((0 == _count) || (size () < (addr + len)) || (size () < addr))
+		return DENIED;
+
+	while (len)
+		{
+		part = map (addr, &local);
+		if (EEP_ARRAY_CONCAT == _layout)
+			chunk = _part_size - local;						// the rest of this part
+		else
+			chunk = _page - (addr & (_page-1));				// the rest of this page
+		if (chunk > len)
+			chunk = len;
+
+		ret_val = _eep[part]->read (local, buf, chunk);
+		if (SUCCESS != ret_val)
+			return ret_val;
+
+		addr += chunk;
+		buf += chunk;
+		len -= chunk;
+		}
+	return SUCCESS;
+	}
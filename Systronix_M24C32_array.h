@@ -0,0 +1,71 @@
+#ifndef M24C32_ARRAY_H_
+#define	M24C32_ARRAY_H_
+
+//
+// Systronix_M24C32_array.h
+//
+// Presents up to EEP_ARRAY_MAX eep parts as one linear address space.  Each part is an ordinary
+// Systronix_M24C32 instance, already set up and initialized, so the parts may sit on one bus (bases 0x50 -
+// 0x57) or be spread over several (Wire, Wire1, ...).  Every part must have the same geometry (part_set());
+// the first part added sets it.
+//
+// layouts:
+//		EEP_ARRAY_CONCAT	with M24C32 parts, part 0 holds 0x0000 - 0x0FFF, part 1 holds 0x1000 - 0x1FFF, ...
+//		EEP_ARRAY_STRIPE	consecutive pages go to consecutive parts: page 0 to part 0, page 1 to part 1, ...
+//							page n to part 0 again
+//
+// write() sends each page to a part that is not in its write cycle whenever there is one, so the tW of one
+// part is spent writing pages to the others.  With striping a long sequential write keeps every part busy;
+// with concatenation only writes that span several parts overlap.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_ARRAY_MAX		8						// one bus holds eight M24C32 (0x50 - 0x57)
+
+#define		EEP_ARRAY_CONCAT	0						// layout
+#define		EEP_ARRAY_STRIPE	1
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_array
+	{
+	protected:
+		Systronix_M24C32*	_eep[EEP_ARRAY_MAX];
+		uint8_t		_count;								// parts added
+		uint8_t		_layout;
+		uint32_t	_part_size;							// bytes per part
+		uint16_t	_page;								// page size of every part
+
+		uint8_t		map (uint32_t addr, uint32_t* local);	// part that holds linear addr and the address within it
+		uint32_t	next (uint32_t addr, size_t len);	// linear address of the next byte on the same part
+
+	public:
+		struct
+			{
+			uint32_t	page_writes;					// page (or partial page) writes sent
+			uint32_t	overlapped;						// page writes sent while another part was in tW
+			} stats;
+
+		Systronix_M24C32_array (void);
+
+		uint8_t		begin (uint8_t layout = EEP_ARRAY_STRIPE);	// forget all parts; set the layout
+		uint8_t		add (Systronix_M24C32& eep);		// append a part; parts are numbered in the order added; DENIED if its geometry differs
+
+		uint8_t		write (uint32_t addr, const uint8_t* buf, size_t len);
+		uint8_t		read (uint32_t addr, uint8_t* buf, size_t len);
+
+		uint32_t	size (void) {return (uint32_t)_count * _part_size;}
+		uint8_t		count (void) {return _count;}
+	};
+
+#endif	// M24C32_ARRAY_H_
@@ -0,0 +1,288 @@
+//
+// Systronix_M24C32_async.cpp
+//
+// Non-blocking request queue for Systronix_M24C32.  submit_read() and submit_write() put a request in a
+// fixed-size queue and return immediately; poll(), called from the main loop, moves the request at the head of
+// the queue through its address, data, and tW-wait phases using the transport's non-blocking sendTransmission()
+// / sendRequest() / done() calls.  poll() never spins: each call does at most one step and returns.
+//
+// Completion is reported two ways: the request's status member changes from PENDING to SUCCESS or FAIL, and
+// the request's callback (if any) is called from within poll().  A request slot is reused once
+// EEP_QUEUE_DEPTH more requests have been submitted so a caller that polls status must look before then.
+//
+// Do not mix blocking calls (read(), write(), page_read(), ...) with queued requests on the same bus while the
+// queue is not empty.
+//
+
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32.h>
+
+
+//---------------------------< Q U E U E _ S L O T >----------------------------------------------------------
+//
+// returns the next free slot at the tail of the queue or NULL when the queue is full
+//
+
+struct Systronix_M24C32::eep_request* Systronix_M24C32::queue_slot (void)
+	{
+	if (EEP_QUEUE_DEPTH <= _queue_count)
+		return NULL;
+
+	return &_queue[(_queue_head + _queue_count) % EEP_QUEUE_DEPTH];
+	}
+
+
+//---------------------------< S U B M I T _ R E A D >--------------------------------------------------------
+//
+// Queue a read of len bytes from addr into buf.  Returns a pointer to the request (watch its status member) or
+// NULL when the queue is full, the device is absent, or the request is out of bounds.  buf must remain valid
+// until the request completes.
+//
+
+struct Systronix_M24C32::eep_request* Systronix_M24C32::submit_read (uint32_t addr, uint8_t* buf, size_t len, void (*callback) (struct eep_request*))
+	{
+	struct eep_request*	req;
+
+	if (!error.exists)										// exit immediately if device does not exist
+		return NULL;
+
+	if ((_part.size <= addr) || (_part.size < len) || (0 == len))
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+		return NULL;
+		}
+
+	req = queue_slot ();
+	if (!req)
+		return NULL;										// queue full; caller should poll() and try again
+
+	req->op = ASYNC_READ;
+	req->state = ASYNC_START;
+	req->status = PENDING;
+	req->addr = addr;
+	req->buf = buf;
+	req->len = len;
+	req->done = 0;
+	req->callback = callback;
+	_queue_count++;
+	return req;
+	}
+
+
+//---------------------------< S U B M I T _ W R I T E >------------------------------------------------------
+//
+// Queue a write of len bytes from buf to addr.  As with write(), the data are split at page boundaries; each
+// chunk is a separate write cycle.  Returns a pointer to the request or NULL.  buf must remain valid until
+// the request completes.
+//
+
+struct Systronix_M24C32::eep_request* Systronix_M24C32::submit_write (uint32_t addr, const uint8_t* buf, size_t len, void (*callback) (struct eep_request*))
+	{
+	struct eep_request*	req;
+
+	if (!error.exists)										// exit immediately if device does not exist
+		return NULL;
+
+	if ((_part.size <= addr) || ((size_t)(_part.size - addr) < len) || (0 == len))
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+		return NULL;
+		}
+
+	req = queue_slot ();
+	if (!req)
+		return NULL;
+
+	req->op = ASYNC_WRITE;
+	req->state = ASYNC_START;
+	req->status = PENDING;
+	req->addr = addr;
+	req->buf = (uint8_t*)buf;								// never written through for ASYNC_WRITE
+	req->len = len;
+	req->done = 0;
+	req->callback = callback;
+	_queue_count++;
+	return req;
+	}
+
+
+//---------------------------< A S Y N C _ S T A R T >--------------------------------------------------------
+//
+// Put the next chunk of req on the bus without waiting.  For a read this is the memory address (the data
+// follow in ASYNC_DATA); for a write it is the address and up to the end of the current page.  Either one
+// doubles as an ack poll: if the device is still in tW it nacks and poll() tries again.
+//
+
+void Systronix_M24C32::async_start (struct eep_request* req)
+	{
+	uint32_t	addr = (req->addr + req->done) & (_part.size - 1);	// reads roll over like read()
+
+	set_addr (addr);
+	_wire->beginTransmission (slave ());
+	addr_put ();
+
+	if (ASYNC_READ == req->op)
+		{
+		_wire->sendTransmission (I2C_NOSTOP);				// address only; hold the bus for the repeated start
+		req->state = ASYNC_ADDR;
+		return;
+		}
+
+	req->chunk = _part.page_size - (addr & (_part.page_size-1));	// room left in this page
+	if (req->chunk > (req->len - req->done))
+		req->chunk = req->len - req->done;
+
+	_wire->write (req->buf + req->done, req->chunk);
+	_wire->sendTransmission (I2C_STOP);
+	req->state = ASYNC_DATA;
+	}
+
+
+//---------------------------< A S Y N C _ F I N I S H >------------------------------------------------------
+//
+// retire the request at the head of the queue and report
+//
+
+void Systronix_M24C32::async_finish (struct eep_request* req, uint8_t status)
+	{
+	req->status = status;
+	_queue_head = (_queue_head + 1) % EEP_QUEUE_DEPTH;
+	_queue_count--;
+
+	if (req->callback)
+		req->callback (req);
+	}
+
+
+//---------------------------< P O L L >----------------------------------------------------------------------
+//
+// Advance the request at the head of the queue by at most one step and return the number of requests still
+// queued.  Call as often as convenient from the main loop; poll() returns immediately when the bus is busy.
+//
+//		ASYNC_START		start the next chunk (async_start())
+//		ASYNC_ADDR		read address phase finished: nack -> ASYNC_TW; ack -> request the data
+//		ASYNC_DATA		data finished: copy out (read) or mark the write cycle (write); next chunk or done
+//		ASYNC_TW		device nacked during tW; retry no more often than every EEP_POLL_US
+//
+// A nack while no write cycle can be running (write_busy() is false) is an error.
+//
+
+uint8_t Systronix_M24C32::poll (void)
+	{
+	struct eep_request*	req;
+	uint8_t				ret_val;
+	size_t				chunk;
+
+	if (0 == _queue_count)
+		return 0;
+
+	req = &_queue[_queue_head];
+
+	switch (req->state)
+		{
+		case ASYNC_START:
+			async_start (req);
+			break;
+
+		case ASYNC_TW:
+			if ((uint32_t)(_wire->micros () - req->t_nack) >= EEP_POLL_US)
+				async_start (req);							// try again
+			break;
+
+		case ASYNC_ADDR:
+			if (!_wire->done ())
+				break;
+
+			ret_val = _wire->status ();
+			if (I2C_WAITING != ret_val)
+				{
+				if ((I2C_ADDR_NAK == ret_val) && write_busy ())
+					{
+					stats.async_nacks++;
+					req->t_nack = _wire->micros ();
+					req->state = ASYNC_TW;
+					break;
+					}
+				i2c_common.tally_transaction (ret_val, &error);
+				async_finish (req, FAIL);
+				break;
+				}
+
+			_write_pending = false;							// device acked; no write cycle running
+			chunk = req->len;								// read the first chunk
+			if (chunk > I2C_RX_BUFFER_LENGTH)
+				chunk = I2C_RX_BUFFER_LENGTH;
+			req->chunk = chunk;
+			_wire->sendRequest (slave (), chunk, (chunk == req->len) ? I2C_STOP : I2C_NOSTOP);
+			req->state = ASYNC_DATA;
+			break;
+
+		case ASYNC_DATA:
+			if (!_wire->done ())
+				break;
+
+			ret_val = _wire->status ();
+
+			if (ASYNC_WRITE == req->op)
+				{
+				if ((I2C_ADDR_NAK == ret_val) && write_busy ())
+					{										// previous chunk's tW still running
+					stats.async_nacks++;
+					req->t_nack = _wire->micros ();
+					req->state = ASYNC_TW;
+					break;
+					}
+				if (I2C_WAITING != ret_val)
+					{
+					i2c_common.tally_transaction (ret_val, &error);
+					async_finish (req, FAIL);
+					break;
+					}
+
+				write_mark ();								// tW starts now
+				req->done += req->chunk;
+				control.rd_wr_len = req->chunk;
+				adv_addr16 ();
+				i2c_common.tally_transaction (SUCCESS, &error);
+
+				if (req->done >= req->len)
+					async_finish (req, SUCCESS);
+				else
+					{
+					req->t_nack = _wire->micros ();			// don't bother the device for EEP_POLL_US
+					req->state = ASYNC_TW;
+					}
+				break;
+				}
+
+			if (I2C_WAITING != ret_val)						// read data
+				{
+				i2c_common.tally_transaction (ret_val, &error);
+				async_finish (req, FAIL);
+				break;
+				}
+
+			_wire->read (req->buf + req->done, req->chunk);	// bulk copy from the wire rx buffer
+			req->done += req->chunk;
+			control.rd_wr_len = req->chunk;
+			adv_addr16 ();
+
+			if (req->done >= req->len)
+				{
+				i2c_common.tally_transaction (SUCCESS, &error);
+				async_finish (req, SUCCESS);
+				break;
+				}
+
+			chunk = req->len - req->done;					// next chunk continues from the device's pointer
+			if (chunk > I2C_RX_BUFFER_LENGTH)
+				chunk = I2C_RX_BUFFER_LENGTH;
+			req->chunk = chunk;
+			_wire->sendRequest (slave (), chunk, (req->done + chunk == req->len) ? I2C_STOP : I2C_NOSTOP);
+			break;
+		}
+
+	return _queue_count;
+	}
@@ -0,0 +1,205 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_atomic.h>
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_atomic::Systronix_M24C32_atomic (void)
+	{
+	_nv = NULL;
+	_len = 0;
+	_slot_size = 0;
+	memset (_slot, 0, sizeof(_slot));
+	_active = EEP_AB_NONE;
+	memset (&stats, 0, sizeof(stats));
+	}
+
+
+//---------------------------< B E G I N >--------------------------------------------------------------------
+//
+// Two slots for a len-byte block from addr in nv (set up and initialized).  On an eeprom addr must be on a
+// page boundary so that each header has a page write of its own.  Nothing is read; call mount().
+//
+// returns SUCCESS, ABSENT, or DENIED (misaligned, pages smaller than a header, or span() runs past the end)
+//
+
+uint8_t Systronix_M24C32_atomic::begin (Systronix_M24C32_nvram& nv, uint32_t addr, uint16_t len)
+	{
+	uint16_t	page = nv.page_size ();
+	uint16_t	unit = page ? page : (EEP_AB_HEADER_LEN + 4);	// no pages: the header is its own write anyway
+
+	_nv = &nv;
+	_active = EEP_AB_NONE;
+	memset (_slot, 0, sizeof(_slot));
+
+	if (!nv.error.exists)
+		return ABSENT;
+
+	if ((0 == len) || (page && ((page < (EEP_AB_HEADER_LEN + 4)) || (addr & (page - 1)))))
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &nv.error);
+		return DENIED;
+		}
+
+	_addr = addr;
+	_len = len;
+	_data_offset = unit;
+	_slot_size = unit + (((uint32_t)len + 4 + unit - 1) / unit) * unit;	// header page, then data and trailer in whole pages
+
+	if ((nv.size () <= addr) || ((nv.size () - addr) < span ()))
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &nv.error);
+		return DENIED;
+		}
+	return SUCCESS;
+	}
+
+
+//---------------------------< H E A D E R _ R E A D >--------------------------------------------------------
+//
+// Read and check one slot's header.  An invalid header (CRC, length, or slot number wrong; never written; or
+// torn by a power loss) is kept as generation 0.
+//
+// returns SUCCESS, CRC_ERROR when the header is not valid, or as crc_read()
+//
+
+uint8_t Systronix_M24C32_atomic::header_read (uint8_t slot)
+	{
+	struct header	hdr;
+	uint8_t			ret_val;
+
+	stats.header_reads++;
+	ret_val = _nv->crc_read (slot_addr (slot), (uint8_t*)&hdr, EEP_AB_HEADER_LEN, EEP_CRC32);
+	if ((SUCCESS == ret_val) && ((_len != hdr.len) || (slot != hdr.slot) || (0 == hdr.gen) || (0xFFFFFFFF == hdr.gen)))
+		ret_val = CRC_ERROR;
+
+	if (SUCCESS == ret_val)
+		_slot[slot] = hdr;
+	else
+		_slot[slot].gen = 0;
+	return ret_val;
+	}
+
+
+//---------------------------< M O U N T >--------------------------------------------------------------------
+//
+// Read both headers (two short reads; the data are not touched) and take the valid one with the larger
+// generation as the current copy.
+//
+// returns SUCCESS, CRC_ERROR when neither header is valid (nothing committed yet), or a bus failure
+//
+
+uint8_t Systronix_M24C32_atomic::mount (void)
+	{
+	uint8_t	ret_val;
+
+	_active = EEP_AB_NONE;
+	for (uint8_t slot=0; slot<2; slot++)
+		{
+		ret_val = header_read (slot);
+		if ((SUCCESS != ret_val) && (CRC_ERROR != ret_val))
+			return ret_val;
+		}
+
+	if (_slot[0].gen || _slot[1].gen)
+		_active = (_slot[1].gen > _slot[0].gen) ? 1 : 0;
+	return (EEP_AB_NONE == _active) ? CRC_ERROR : SUCCESS;
+	}
+
+
+//---------------------------< C O M M I T >------------------------------------------------------------------
+//
+// Make data (len bytes) the current copy: data into the other slot, verified, then that slot's header.
+// Returns once the header's write cycle has finished and the header has been read back, so the new copy
+// survives a power loss from then on.  On any failure the previous copy remains the current one.
+//
+// returns SUCCESS, CRC_ERROR (data or header did not read back as written), DENIED (before begin()), or a bus
+// failure
+//
+
+uint8_t Systronix_M24C32_atomic::commit (const uint8_t* data)
+	{
+	uint8_t			target = (0 == _active) ? 1 : 0;
+	uint32_t		data_addr;
+	struct header	hdr;
+	struct header	check;
+	uint8_t			ret_val;
+
+	if (0 == _slot_size)
+		return DENIED;
+
+	data_addr = slot_addr (target) + _data_offset;
+	hdr.gen = ((_slot[0].gen > _slot[1].gen) ? _slot[0].gen : _slot[1].gen) + 1;	// above both, valid or damaged
+	hdr.len = _len;
+	hdr.slot = target;
+	hdr.reserved = 0;
+	hdr.data_crc = eep_crc32 (0, data, _len);
+	_slot[target].gen = 0;								// its old copy is about to be overwritten
+
+	ret_val = _nv->crc_write (data_addr, data, _len, EEP_CRC32);
+	if (SUCCESS == ret_val)
+		ret_val = _nv->verify (data_addr, _len, EEP_CRC32);	// waits out the last write cycle
+	if (SUCCESS != ret_val)
+		return ret_val;
+
+	ret_val = _nv->crc_write (slot_addr (target), (const uint8_t*)&hdr, EEP_AB_HEADER_LEN, EEP_CRC32);	// the commit point
+	if (SUCCESS == ret_val)
+		ret_val = _nv->crc_read (slot_addr (target), (uint8_t*)&check, EEP_AB_HEADER_LEN, EEP_CRC32);
+	if ((SUCCESS == ret_val) && memcmp (&hdr, &check, EEP_AB_HEADER_LEN))
+		ret_val = CRC_ERROR;
+	if (SUCCESS != ret_val)
+		return ret_val;
+
+	_slot[target] = hdr;
+	_active = target;
+	stats.commits++;
+	return SUCCESS;
+	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+//
+// Read the current copy (len bytes) into data; its trailer and the header's data CRC must both match.  If the
+// current copy is damaged and the other slot holds a valid older copy, that one is read instead and becomes
+// current (generation() tells which was read); the next commit() overwrites the damaged slot.
+//
+// returns SUCCESS, CRC_ERROR when no copy reads back intact, or a bus failure
+//
+
+uint8_t Systronix_M24C32_atomic::read (uint8_t* data)
+	{
+	uint8_t	slot;
+	uint8_t	ret_val = CRC_ERROR;
+
+	if (EEP_AB_NONE == _active)
+		return CRC_ERROR;
+
+	for (uint8_t i=0; i<2; i++)
+		{
+		slot = i ? (1 - _active) : _active;
+		if (0 == _slot[slot].gen)
+			continue;
+
+		ret_val = _nv->crc_read (slot_addr (slot) + _data_offset, data, _len, EEP_CRC32);
+		if ((SUCCESS == ret_val) && (eep_crc32 (0, data, _len) != _slot[slot].data_crc))
+			ret_val = CRC_ERROR;						// intact, but not the copy this header committed
+
+		if (SUCCESS == ret_val)
+			{
+			if (i)
+				{
+				stats.fallbacks++;
+				_active = slot;
+				}
+			return SUCCESS;
+			}
+		if (CRC_ERROR != ret_val)
+			return ret_val;								// bus failure; the copy may be fine
+		}
+	return ret_val;
+	}
@@ -0,0 +1,92 @@
+#ifndef M24C32_ATOMIC_H_
+#define	M24C32_ATOMIC_H_
+
+//
+// Systronix_M24C32_atomic.h
+//
+// Power-fail-atomic configuration block: a block of len bytes kept in two slots (A and B) on any nvram.  A
+// commit writes the slot not holding the current copy and only then, in a page write of its own, that slot's
+// header: the commit marker.  A power loss at any point leaves either the previous copy or the new one; never a
+// mix.  mount() reads the two 16-byte headers and nothing else, so boot costs the same whatever the block size
+// and whether or not the last commit was interrupted.
+//
+// slot layout (a slot starts on a page boundary; 'page' is the part's page size, or 16 bytes on FRAM):
+//		+0x00 - 0x03:		generation; uint32_t little endian; the first commit is 1; 0 and 0xFFFFFFFF are never used
+//		+0x04 - 0x05:		block length
+//		+0x06:				slot number; 0 or 1
+//		+0x07:				reserved; 0
+//		+0x08 - 0x0B:		CRC-32 of the data
+//		+0x0C - 0x0F:		CRC-32 of +0x00 - +0x0B (crc_write())
+//		+page:				the data followed by its CRC-32 (crc_write())
+//
+// commit():
+//		1	data and trailer into the other slot; that slot's old header (an older generation) is left alone
+//		2	verify() the data: the wait for the last write cycle and one sequential read
+//		3	the header, generation one above the newest valid header, in one page write: the commit point
+//		4	read the header back: the wait for its write cycle and a check that it landed
+//
+// A header is valid when its CRC matches and its length and slot number are this block's; the valid header
+// with the larger generation names the current copy.  A cut before step 3 completes leaves the new slot's
+// header torn (invalid) or as it was (an older generation), so the previous copy is still the newest valid.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32_nvram.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_AB_HEADER_LEN	12						// header bytes ahead of its CRC-32
+#define		EEP_AB_NONE			0xFF					// active(): nothing committed
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_atomic
+	{
+	protected:
+		Systronix_M24C32_nvram*	_nv;
+		uint32_t	_addr;								// slot A; slot B follows it
+		uint16_t	_len;								// block length
+		uint32_t	_slot_size;
+		uint16_t	_data_offset;						// header page; the data start on the next page
+
+		struct header
+			{
+			uint32_t	gen;
+			uint16_t	len;
+			uint8_t		slot;
+			uint8_t		reserved;
+			uint32_t	data_crc;
+			} _slot[2];									// as read by mount() or written by commit(); gen 0 when invalid
+		uint8_t		_active;							// slot holding the current copy, or EEP_AB_NONE
+
+		uint32_t	slot_addr (uint8_t slot) {return _addr + (slot * _slot_size);}
+		uint8_t		header_read (uint8_t slot);			// into _slot[slot]; invalid headers read as gen 0
+
+	public:
+		struct
+			{
+			uint32_t	commits;
+			uint32_t	header_reads;					// by mount()
+			uint32_t	fallbacks;						// read() found the current copy damaged and used the other
+			} stats;
+
+		Systronix_M24C32_atomic (void);
+
+		uint8_t		begin (Systronix_M24C32_nvram& nv, uint32_t addr, uint16_t len);	// addr on a page boundary
+		uint8_t		mount (void);						// find the current copy from the headers; call after begin()
+
+		uint8_t		commit (const uint8_t* data);		// len bytes; returns once the new copy is in place
+		uint8_t		read (uint8_t* data);				// the current copy; CRC-checked
+
+		uint8_t		active (void) {return _active;}		// 0, 1, or EEP_AB_NONE
+		uint32_t	generation (void) {return (EEP_AB_NONE == _active) ? 0 : _slot[_active].gen;}
+		uint32_t	span (void) {return 2 * _slot_size;}	// nvram used, from addr
+	};
+
+#endif	// M24C32_ATOMIC_H_
@@ -0,0 +1,233 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_cache.h>
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_cache::Systronix_M24C32_cache (void)
+	{
+	_eep = NULL;
+	_pages = 0;
+	_tick = 0;
+	memset (&stats, 0, sizeof(stats));
+	invalidate ();
+	}
+
+
+//---------------------------< B E G I N >--------------------------------------------------------------------
+//
+// attach the cache to an eeprom or FRAM and set the number of pages to hold.  Slots are EEP_PAGE_SIZE bytes so
+// only eeproms with 32-byte pages (M24C32, M24C64), or FRAM, up to 64 KB can be cached.
+//
+
+uint8_t Systronix_M24C32_cache::begin (Systronix_M24C32_nvram& eep, uint8_t pages)
+	{
+	if ((0 == pages) || (EEP_CACHE_PAGES_MAX < pages) || (eep.page_size () && (EEP_PAGE_SIZE != eep.page_size ())) || (0x10000 < eep.size ()))
+		return DENIED;
+
+	_eep = &eep;
+	_pages = pages;
+	invalidate ();
+	return SUCCESS;
+	}
+
+
+//---------------------------< I N V A L I D A T E >----------------------------------------------------------
+//
+// forget every cached page without writing anything
+//
+
+void Systronix_M24C32_cache::invalidate (void)
+	{
+	for (uint8_t i=0; i<EEP_CACHE_PAGES_MAX; i++)
+		{
+		_slot[i].page = EEP_CACHE_EMPTY;
+		_slot[i].dirty_lo = EEP_PAGE_SIZE;					// lo > hi: clean
+		_slot[i].dirty_hi = 0;
+		_slot[i].used = 0;
+		}
+	}
+
+
+//---------------------------< D I R T Y >--------------------------------------------------------------------
+//
+//
+//
+
+boolean Systronix_M24C32_cache::dirty (void)
+	{
+	for (uint8_t i=0; i<_pages; i++)
+		if (_slot[i].dirty_lo <= _slot[i].dirty_hi)
+			return true;
+	return false;
+	}
+
+
+//---------------------------< S L O T _ F L U S H >----------------------------------------------------------
+//
+// write the dirty span of a slot to the eep.  The span never crosses the page so this is one write cycle.
+//
+
+uint8_t Systronix_M24C32_cache::slot_flush (uint8_t slot)
+	{
+	uint8_t	lo = _slot[slot].dirty_lo;
+	uint8_t	hi = _slot[slot].dirty_hi;
+
+	if (lo > hi)
+		return SUCCESS;										// clean
+
+	if (SUCCESS != _eep->write ((_slot[slot].page * EEP_PAGE_SIZE) + lo, &_slot[slot].data[lo], hi - lo + 1))
+		return FAIL;
+
+	_slot[slot].dirty_lo = EEP_PAGE_SIZE;
+	_slot[slot].dirty_hi = 0;
+	stats.flushes++;
+	return SUCCESS;
+	}
+
+
+//---------------------------< L O O K U P >------------------------------------------------------------------
+//
+// Find the slot holding page.  On a miss the least recently used slot is flushed (if dirty) and reused; when
+// load is true the page is read from the eep into the slot.  load is false only when the caller is about to
+// overwrite the whole page.
+//
+
+uint8_t Systronix_M24C32_cache::lookup (uint16_t page, boolean load, uint8_t* slot)
+	{
+	uint8_t	victim = 0;
+
+	for (uint8_t i=0; i<_pages; i++)
+		{
+		if (page == _slot[i].page)
+			{
+			stats.hits++;
+			_slot[i].used = ++_tick;
+			*slot = i;
+			return SUCCESS;
+			}
+		if (_slot[i].used < _slot[victim].used)
+			victim = i;
+		}
+
+	stats.misses++;
+	if (EEP_CACHE_EMPTY != _slot[victim].page)
+		{
+		if (SUCCESS != slot_flush (victim))
+			return FAIL;
+		stats.evictions++;
+		}
+
+	_slot[victim].page = EEP_CACHE_EMPTY;					// in case the fill fails
+	if (load)
+		{
+		if (SUCCESS != _eep->read (page * EEP_PAGE_SIZE, _slot[victim].data, EEP_PAGE_SIZE))
+			return FAIL;
+		stats.fills++;
+		}
+
+	_slot[victim].page = page;
+	_slot[victim].used = ++_tick;
+	*slot = victim;
+	return SUCCESS;
+	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+//
+// read len bytes beginning at addr through the cache; same arguments and returns as Systronix_M24C32::read()
+// except that reads do not roll over past the top of the array
+//
+
+uint8_t Systronix_M24C32_cache::read (uint16_t addr, uint8_t* buf, size_t len)
+	{
+	uint8_t	slot;
+	size_t	chunk;
+	uint8_t	offset;
+
+	if (!_eep)
+		return FAIL;
+
+	if ((_eep->size () <= addr) || ((size_t)(_eep->size () - addr) < len))
+		return DENIED;
+
+	while (len)
+		{
+		offset = addr & (EEP_PAGE_SIZE-1);
+		chunk = EEP_PAGE_SIZE - offset;
+		if (chunk > len)
+			chunk = len;
+
+		if (SUCCESS != lookup (addr / EEP_PAGE_SIZE, true, &slot))
+			return FAIL;
+
+		memcpy (buf, &_slot[slot].data[offset], chunk);
+		addr += chunk;
+		buf += chunk;
+		len -= chunk;
+		}
+
+	return SUCCESS;
+	}
+
+
+//---------------------------< W R I T E >--------------------------------------------------------------------
+//
+// merge len bytes from buf into the cached pages beginning at addr and mark them dirty; same arguments and
+// returns as Systronix_M24C32::write().  A page that is only partly overwritten is first read from the eep.
+//
+
+uint8_t Systronix_M24C32_cache::write (uint16_t addr, const uint8_t* buf, size_t len)
+	{
+	uint8_t	slot;
+	size_t	chunk;
+	uint8_t	offset;
+
+	if (!_eep)
+		return FAIL;
+
+	if ((_eep->size () <= addr) || ((size_t)(_eep->size () - addr) < len))
+		return DENIED;
+
+	while (len)
+		{
+		offset = addr & (EEP_PAGE_SIZE-1);
+		chunk = EEP_PAGE_SIZE - offset;
+		if (chunk > len)
+			chunk = len;
+
+		if (SUCCESS != lookup (addr / EEP_PAGE_SIZE, (EEP_PAGE_SIZE != chunk), &slot))
+			return FAIL;
+
+		memcpy (&_slot[slot].data[offset], buf, chunk);
+		if (offset < _slot[slot].dirty_lo)
+			_slot[slot].dirty_lo = offset;
+		if ((offset + chunk - 1) > _slot[slot].dirty_hi)
+			_slot[slot].dirty_hi = offset + chunk - 1;
+
+		addr += chunk;
+		buf += chunk;
+		len -= chunk;
+		}
+
+	return SUCCESS;
+	}
+
+
+//---------------------------< F L U S H >--------------------------------------------------------------------
+//
+// write every dirty page to the eep; one write cycle per dirty page
+//
+
+uint8_t Systronix_M24C32_cache::flush (void)
+	{
+	for (uint8_t i=0; i<_pages; i++)
+		if (SUCCESS != slot_flush (i))
+			return FAIL;
+	return SUCCESS;
+	}
@@ -0,0 +1,72 @@
+#ifndef M24C32_CACHE_H_
+#define	M24C32_CACHE_H_
+
+//
+// Systronix_M24C32_cache.h
+//
+// Optional write-back page cache over a Systronix_M24C32_nvram (eeprom or FRAM).  Holds up to
+// EEP_CACHE_PAGES_MAX 32-byte pages in RAM.  Reads are served from cached pages; writes are merged into cached
+// pages and marked dirty.  A dirty page reaches the eep as a single page write (one tW, one endurance cycle)
+// when it is evicted or when flush() is called, however many small writes were merged into it.
+//
+// Nothing is written to the eep until a page is evicted or flush() is called; call flush() before power-down
+// or before handing the eep to code that does not go through the cache.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_CACHE_PAGES_MAX		8					// RAM cost is (EEP_PAGE_SIZE + 8) bytes per page
+#define		EEP_CACHE_EMPTY			0xFFFF				// page number of an unused cache slot
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_cache
+	{
+	protected:
+		struct
+			{
+			uint16_t	page;							// eep page number held in this slot; EEP_CACHE_EMPTY if none
+			uint8_t		dirty_lo;						// first and last dirty byte offsets; dirty_lo > dirty_hi when clean
+			uint8_t		dirty_hi;
+			uint32_t	used;							// _tick at last access; least recently used is evicted
+			uint8_t		data[EEP_PAGE_SIZE];
+			} _slot[EEP_CACHE_PAGES_MAX];
+
+		Systronix_M24C32_nvram*	_eep;
+		uint8_t		_pages;								// number of slots in use; 1..EEP_CACHE_PAGES_MAX
+		uint32_t	_tick;
+
+		uint8_t		lookup (uint16_t page, boolean load, uint8_t* slot);	// find or allocate the slot for page
+		uint8_t		slot_flush (uint8_t slot);
+
+	public:
+		struct
+			{
+			uint32_t	hits;							// page accesses served from RAM
+			uint32_t	misses;							// page accesses that had to allocate a slot
+			uint32_t	fills;							// pages read from the eep to fill a slot
+			uint32_t	flushes;						// dirty pages written to the eep
+			uint32_t	evictions;						// slots reused for another page
+			} stats;
+
+		Systronix_M24C32_cache (void);
+
+		uint8_t		begin (Systronix_M24C32_nvram& eep, uint8_t pages = EEP_CACHE_PAGES_MAX);
+
+		uint8_t		read (uint16_t addr, uint8_t* buf, size_t len);
+		uint8_t		write (uint16_t addr, const uint8_t* buf, size_t len);
+		uint8_t		flush (void);						// write every dirty page
+		void		invalidate (void);					// drop everything; dirty data are lost
+		boolean		dirty (void);						// true if any page is waiting to be written
+	};
+
+#endif	// M24C32_CACHE_H_
@@ -0,0 +1,29 @@
+#ifndef M24C32_CONFIG_H_
+#define	M24C32_CONFIG_H_
+
+//
+// Systronix_M24C32_config.h
+//
+// Build switches for the whole library.  Each one changes the layout of library classes, so it must have the
+// same value in every translation unit that includes a library header, the library's own .cpp files among
+// them.  Set a switch here, or with -D on the compiler command line for the whole build (Arduino:
+// compiler.cpp.extra_flags in platform.local.txt); never with a #define in a sketch or source file before an
+// #include, which changes only that one file and leaves it disagreeing with the library about what is in the
+// objects they share.
+//
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#ifndef EEP_INSTRUMENT
+#define		EEP_INSTRUMENT		0						// 1 to compile in instr_dump() and friends (Systronix_M24C32_instr.h)
+#endif
+
+#ifndef EEP_TRACE
+#define		EEP_TRACE			1						// 0 to compile the recorder out of Systronix_M24C32_trace
+#endif
+
+#ifndef EEP_TRACE_DEPTH
+#define		EEP_TRACE_DEPTH		256						// trace records in the ring; a power of 2
+#endif
+
+#endif	// M24C32_CONFIG_H_
@@ -0,0 +1,43 @@
+#ifndef M24C32_CRC_H_
+#define	M24C32_CRC_H_
+
+//
+// Systronix_M24C32_crc.h
+//
+// Table-driven CRC kernels used by the driver's stored-checksum regions (crc_write(), crc_read(), verify()),
+// by the running CRC in read() / write() (crc_start()), and by Systronix_M24C32_log.  One 256-entry table per
+// CRC width, one table lookup per byte; the tables are const and so live in flash.
+//
+//		EEP_CRC16	CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, no final xor; check 0x29B1
+//		EEP_CRC32	CRC-32 (IEEE 802.3, zlib): reflected polynomial 0xEDB88320; check 0xCBF43926
+//
+// Both are incremental: start from eep_crc_init(type) and pass each result back in with the next block.  The
+// CRC of data split across any number of calls is the same as the CRC of the data in one call.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#if defined (ARDUINO)
+#include <Arduino.h>
+#else
+#include <Systronix_M24C32_host.h>
+#endif
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_CRC_NONE		0						// crc type
+#define		EEP_CRC16			1						// 2-byte stored checksum
+#define		EEP_CRC32			2						// 4-byte stored checksum
+
+
+//---------------------------< P R O T O T Y P E S >----------------------------------------------------------
+
+uint16_t	eep_crc16 (uint16_t crc, const uint8_t* data, size_t len);	// start with crc = 0xFFFF
+uint32_t	eep_crc32 (uint32_t crc, const uint8_t* data, size_t len);	// start with crc = 0
+
+uint32_t	eep_crc_init (uint8_t type);
+uint32_t	eep_crc_update (uint8_t type, uint32_t crc, const uint8_t* data, size_t len);
+uint8_t		eep_crc_size (uint8_t type);				// stored checksum bytes: 0, 2, or 4
+
+#endif	// M24C32_CRC_H_
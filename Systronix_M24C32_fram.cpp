@@ -0,0 +1,270 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_fram.h>
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+// default constructor assumes lowest base address and an MB85RC256V
+//
+
+Systronix_M24C32_fram::Systronix_M24C32_fram (void)
+	{
+	_base = FRAM_BASE_MIN;
+	_size = FRAM_MB85RC256V;
+#if defined (ARDUINO)
+	_wire = &_i2c_t3;							// Wire until setup() says otherwise
+#else
+	_wire = NULL;								// host: setup() must supply a transport
+#endif
+	wire_name = (char*)"empty";
+	memset (&stats, 0, sizeof(stats));
+	}
+
+
+//---------------------------< S E T U P >--------------------------------------------------------------------
+//
+//
+//
+
+#if defined (ARDUINO)
+uint8_t Systronix_M24C32_fram::setup (uint8_t base, i2c_t3& wire, char* name)
+	{
+	_i2c_t3.bus_set (wire);				// the i2c_t3 transport refers to wire; it does not copy it
+	return setup (base, _i2c_t3, name);
+	}
+#endif
+
+
+//---------------------------< S E T U P   ( T R A N S P O R T ) >--------------------------------------------
+//
+//
+//
+
+uint8_t Systronix_M24C32_fram::setup (uint8_t base, Systronix_M24C32_transport& transport, char* name)
+	{
+	if ((FRAM_BASE_MIN > base) || (FRAM_BASE_MAX < base))
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+		return FAIL;
+		}
+
+	_base = base;
+	_wire = &transport;
+	wire_name = name;
+	return SUCCESS;
+	}
+
+
+//---------------------------< B E G I N >--------------------------------------------------------------------
+//
+// I2C_PINS_18_19 or I2C_PINS_29_30
+//
+
+void Systronix_M24C32_fram::begin (i2c_pins pins, i2c_rate rate)
+	{
+	_wire->begin (pins, rate);									// join I2C as master
+	}
+
+
+//---------------------------< D E F A U L T   B E G I N >----------------------------------------------------
+//
+//
+//
+
+void Systronix_M24C32_fram::begin (void)
+	{
+	_wire->begin();				// initialize I2C as master
+	}
+
+
+//---------------------------< I N I T >----------------------------------------------------------------------
+//
+// determines if there is a device at _base address by attempting to get an address ack from it.  FRAM is
+// never busy so one attempt is enough.
+//
+
+uint8_t Systronix_M24C32_fram::init (void)
+	{
+	error.exists = true;					// necessary to presume that the device exists
+
+	_wire->beginTransmission (_base);
+	if (SUCCESS != _wire->endTransmission ())
+		{
+		error.exists = false;				// only place in this file where this can be set false
+		return FAIL;
+		}
+
+	return SUCCESS;
+	}
+
+
+//---------------------------< P A G E _ P U T >--------------------------------------------------------------
+//
+// One write transaction: slave address, two memory address bytes, and len (up to FRAM_CHUNK) data bytes.  The
+// data are in the array by the time the STOP is sent so there is nothing to wait for afterward.
+//
+
+uint8_t Systronix_M24C32_fram::page_put (uint32_t addr, const uint8_t* buf, size_t len)
+	{
+	uint8_t		ret_val;
+	uint8_t		mem_addr[2] = {(uint8_t)(addr >> 8), (uint8_t)addr};
+	size_t		bytes_written;
+
+	if (!error.exists)										// exit immediately if device does not exist
+		return ABSENT;
+
+	_wire->beginTransmission (_base);						// init tx buff for xmit to slave at _base address
+	bytes_written = _wire->write (mem_addr, 2);				// put the memory address in the tx buffer
+	bytes_written += _wire->write (buf, len);				// copy source to wire tx buffer data
+	if (bytes_written < (2 + len))
+		{
+		i2c_common.tally_transaction (WR_INCOMPLETE, &error);
+		return FAIL;
+		}
+
+	ret_val = _wire->endTransmission ();					// xmit memory address followed by data
+	if (SUCCESS != ret_val)
+		{
+		i2c_common.tally_transaction (ret_val, &error);
+		return FAIL;
+		}
+
+	crc_run (buf, len);										// only data that went out, as the eeprom's write()
+	stats.writes++;
+	i2c_common.tally_transaction (SUCCESS, &error);
+	return SUCCESS;
+	}
+
+
+//---------------------------< W R I T E >--------------------------------------------------------------------
+//
+// Writes len bytes from buf to the FRAM beginning at addr in transactions of up to FRAM_CHUNK bytes.  There
+// are no pages so chunks need no alignment, and no tW so each chunk follows the last immediately.
+//
+// returns SUCCESS, ABSENT, DENIED when addr + len runs past the end of the array, or FAIL
+//
+
+uint8_t Systronix_M24C32_fram::write (uint32_t addr, const uint8_t* buf, size_t len)
+	{
+	size_t	chunk;
+
+	if (!error.exists)										// exit immediately if device does not exist
+		return ABSENT;
+
+	if ((_size <= addr) || ((size_t)(_size - addr) < len))
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+		return DENIED;										// write would run off the end of the array
+		}
+
+	while (len)
+		{
+		chunk = (len > FRAM_CHUNK) ? FRAM_CHUNK : len;
+		if (SUCCESS != page_put (addr, buf, chunk))
+			return FAIL;									// page_put() has tallied the error
+		addr += chunk;
+		buf += chunk;
+		len -= chunk;
+		}
+
+	return SUCCESS;
+	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+//
+// Reads len bytes from the FRAM beginning at addr into buf; one address phase then sequential reads of up to
+// I2C_RX_BUFFER_LENGTH bytes joined by repeated starts.
+//
+// returns SUCCESS, ABSENT, DENIED when len is larger than the array, or FAIL
+//
+
+uint8_t Systronix_M24C32_fram::read (uint32_t addr, uint8_t* buf, size_t len)
+	{
+	return read_stream (addr, buf, len, NULL, 0);
+	}
+
+
+//---------------------------< R E A D _ S T R E A M >--------------------------------------------------------
+//
+// read() plus tail_len bytes to tail that are not part of the running CRC; buf may be NULL.  See
+// Systronix_M24C32_nvram.h.
+//
+
+uint8_t Systronix_M24C32_fram::read_stream (uint32_t addr, uint8_t* buf, size_t len, uint8_t* tail, size_t tail_len)
+	{
+	uint8_t		ret_val;
+	uint8_t		mem_addr[2] = {(uint8_t)(addr >> 8), (uint8_t)addr};
+	uint8_t		scratch[32];
+	size_t		chunk;
+	size_t		data;
+	size_t		n;
+
+	if (!error.exists)										// exit immediately if device does not exist
+		return ABSENT;
+
+	if ((_size <= addr) || (_size < (len + tail_len)))
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+		return DENIED;
+		}
+
+	if (0 == (len + tail_len))
+		return SUCCESS;
+
+	_wire->beginTransmission (_base);						// init tx buff for xmit to slave at _base address
+	if (2 != _wire->write (mem_addr, 2))					// put the memory address in the tx buffer
+		{
+		i2c_common.tally_transaction (WR_INCOMPLETE, &error);
+		return FAIL;
+		}
+
+	ret_val = _wire->endTransmission (I2C_NOSTOP);			// xmit memory address; hold the bus
+	if (SUCCESS != ret_val)
+		{
+		i2c_common.tally_transaction (ret_val, &error);
+		return FAIL;
+		}
+	stats.reads++;
+
+	while (len + tail_len)
+		{
+		chunk = ((len + tail_len) > I2C_RX_BUFFER_LENGTH) ? I2C_RX_BUFFER_LENGTH : (len + tail_len);
+
+		if (chunk != _wire->requestFrom (_base, chunk, (chunk == (len + tail_len)) ? I2C_STOP : I2C_NOSTOP))
+			{
+			ret_val = _wire->status();						// to get error value
+			i2c_common.tally_transaction (ret_val, &error);
+			return FAIL;
+			}
+
+		data = (chunk > len) ? len : chunk;					// data bytes in this chunk; the rest are tail
+		if (buf)
+			{
+			_wire->read (buf, data);						// bulk copy from the wire rx buffer
+			crc_run (buf, data);
+			buf += data;
+			}
+		else
+			{
+			for (size_t i=0; i<data; i+=n)
+				{
+				n = ((data - i) > sizeof(scratch)) ? sizeof(scratch) : (data - i);
+				_wire->read (scratch, n);
+				crc_run (scratch, n);
+				}
+			}
+		if (chunk > data)
+			{
+			_wire->read (tail, chunk - data);
+			tail += chunk - data;
+			tail_len -= chunk - data;
+			}
+		len -= data;
+		}
+
+	i2c_common.tally_transaction (SUCCESS, &error);
+	return SUCCESS;
+	}
@@ -0,0 +1,89 @@
+#ifndef M24C32_FRAM_H_
+#define	M24C32_FRAM_H_
+
+//
+// Systronix_M24C32_fram.h
+//
+// FRAM backend of Systronix_M24C32_nvram for the Fujitsu MB85RC family (MB85RC256V and friends; two memory
+// address bytes, slave addresses 0x50 - 0x57 like the eeprom).  FRAM writes complete at bus speed, so there
+// is no tW, no ack polling, and no page split: a write goes out in as few transactions as the i2c_t3 tx buffer
+// allows (FRAM_CHUNK data bytes each) and a read is one address phase followed by sequential reads.
+// Sequential access rolls over from the top of the array to 0x0000.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#if defined (ARDUINO)
+#include <Arduino.h>
+#include <Systronix_i2c_common.h>
+#include <Systronix_M24C32_i2c_t3.h>
+#endif
+#include <Systronix_M24C32_transport.h>
+#include <Systronix_M24C32_nvram.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		FRAM_MB85RC64		0x2000					// array sizes for size_set()
+#define		FRAM_MB85RC128		0x4000
+#define		FRAM_MB85RC256V		0x8000
+#define		FRAM_MB85RC512T		0x10000
+
+#define		FRAM_BASE_MIN		0x50					// 7-bit address not including R/W bit
+#define		FRAM_BASE_MAX		0x57
+
+#define		FRAM_CHUNK			(I2C_TX_BUFFER_LENGTH - 3)	// data bytes per write; the slave address and two address bytes use the rest
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_fram : public Systronix_M24C32_nvram
+	{
+	protected:
+		uint8_t		_base;								// base address, eight possible values
+		uint32_t	_size;								// bytes; FRAM_MB85RC256V unless changed with size_set()
+
+		Systronix_M24C32_transport*	_wire;				// the bus; i2c_t3 on target, the simulator on the host
+#if defined (ARDUINO)
+		Systronix_M24C32_i2c_t3	_i2c_t3;				// default transport; refers to (does not copy) Wire, Wire1, ...
+#endif
+
+		uint8_t		page_put (uint32_t addr, const uint8_t* buf, size_t len);	// one write transaction
+		uint8_t		read_stream (uint32_t addr, uint8_t* buf, size_t len, uint8_t* tail, size_t tail_len);
+
+	public:
+		struct
+			{
+			uint32_t	writes;							// write transactions
+			uint32_t	reads;							// read address phases
+			} stats;
+
+		char*		wire_name;							// name of Wire, Wire1, etc in use
+
+		Systronix_M24C32_fram (void);
+
+		uint8_t		base_get (void) {return _base;}
+
+#if defined (ARDUINO)
+		uint8_t		setup (uint8_t base, i2c_t3& wire = Wire, char* name = (char*)"Wire");
+#endif
+		uint8_t		setup (uint8_t base, Systronix_M24C32_transport& transport, char* name = (char*)"transport");
+
+		void 		begin (i2c_pins pins, i2c_rate rate);
+		void		begin (void);						// default begin
+		uint8_t		init (void);						// determines if a device at _base acks its address
+		void		size_set (uint32_t bytes) {_size = bytes;}	// FRAM_MB85RC64 ... FRAM_MB85RC512T
+
+		uint8_t		write (uint32_t addr, const uint8_t* buf, size_t len);
+		uint8_t		read (uint32_t addr, uint8_t* buf, size_t len);
+		using		Systronix_M24C32_nvram::write;		// typed write<T>() and write<ADDR>()
+		using		Systronix_M24C32_nvram::read;
+
+		uint32_t	size (void) {return _size;}
+		uint16_t	page_size (void) {return 0;}		// no pages
+	};
+
+#endif	// M24C32_FRAM_H_
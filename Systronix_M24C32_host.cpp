@@ -0,0 +1,56 @@
+#if !defined (ARDUINO)
+
+#include <Systronix_M24C32_host.h>
+
+Systronix_i2c_common i2c_common;
+
+
+//---------------------------< T A L L Y _ T R A N S A C T I O N >--------------------------------------------
+//
+// host version of the Systronix_i2c_common error tally.  Values 1-3 are i2c_t3 endTransmission() returns;
+// larger values are i2c_t3 status() values or the WR_INCOMPLETE / SILLY_PROGRAMMER codes.  endTransmission()
+// 'other error' (4) shares its value with I2C_TIMEOUT.
+//
+
+void Systronix_i2c_common::tally_transaction (uint8_t value, Systronix_i2c_error* error_ptr)
+	{
+	error_ptr->error_val = value;
+
+	if (SUCCESS == value)
+		{
+		error_ptr->successful_count++;
+		return;
+		}
+
+	switch (value)
+		{
+		case 1:												// data too long for the tx buffer
+		case I2C_BUF_OVF:
+			error_ptr->data_len_error_count++;
+			break;
+		case 2:												// endTransmission() address nack
+		case I2C_ADDR_NAK:
+			error_ptr->rcv_addr_nack_count++;
+			break;
+		case 3:												// endTransmission() data nack
+		case I2C_DATA_NAK:
+			error_ptr->rcv_data_nack_count++;
+			break;
+		case I2C_TIMEOUT:
+			error_ptr->timeout_count++;
+			break;
+		case WR_INCOMPLETE:
+			error_ptr->incomplete_write_count++;
+			break;
+		case SILLY_PROGRAMMER:
+			error_ptr->silly_programmer_error++;
+			break;
+		default:
+			error_ptr->other_error_count++;
+			break;
+		}
+
+	error_ptr->total_error_count++;
+	}
+
+#endif	// !ARDUINO
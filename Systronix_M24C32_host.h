@@ -0,0 +1,89 @@
+#ifndef M24C32_HOST_H_
+#define	M24C32_HOST_H_
+
+//
+// Systronix_M24C32_host.h
+//
+// Stand-ins for the handful of Arduino, i2c_t3, and Systronix_i2c_common definitions that the driver uses.
+// Included by Systronix_M24C32.h only when ARDUINO is not defined so that the driver and the simulated bus
+// (Systronix_M24C32_sim) can be compiled and measured on a Linux host.  Values here need not match the target
+// libraries bit-for-bit; they need only be self-consistent on the host.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+typedef bool	boolean;
+
+#define		SUCCESS				0
+#define		FAIL				(~SUCCESS)
+#define		ABSENT				0xFD
+
+#define		WR_INCOMPLETE		11						// tally_transaction() values beyond the i2c_t3 returns
+#define		SILLY_PROGRAMMER	12
+
+#define		I2C_TX_BUFFER_LENGTH	259					// same as i2c_t3 defaults
+#define		I2C_RX_BUFFER_LENGTH	259
+
+enum i2c_stop {I2C_NOSTOP, I2C_STOP};
+
+enum i2c_status {I2C_WAITING, I2C_SENDING, I2C_SEND_ADDR, I2C_RECEIVING, I2C_TIMEOUT, I2C_ADDR_NAK,
+				I2C_DATA_NAK, I2C_ARB_LOST, I2C_BUF_OVF, I2C_SLAVE_TX, I2C_SLAVE_RX};
+
+enum i2c_pins {I2C_PINS_16_17, I2C_PINS_18_19, I2C_PINS_29_30, I2C_PINS_37_38, I2C_PINS_3_4};
+
+enum i2c_rate {I2C_RATE_100, I2C_RATE_200, I2C_RATE_300, I2C_RATE_400, I2C_RATE_600, I2C_RATE_800,
+				I2C_RATE_1000, I2C_RATE_1200, I2C_RATE_1500, I2C_RATE_1800, I2C_RATE_2000, I2C_RATE_2400,
+				I2C_RATE_2800, I2C_RATE_3000};
+
+
+//---------------------------< S Y S T R O N I X _ I 2 C _ E R R O R >----------------------------------------
+//
+// the subset of the Systronix_i2c_common error struct (error_t there) that the driver touches.  glibc's
+// <errno.h> declares an error_t of its own under _GNU_SOURCE (g++ defines it), so the host struct has a name of
+// its own and library code names it eep_error_t (Systronix_M24C32_nvram.h).  error_t is an alias for it only
+// where the C library has not taken the name; <errno.h> is included first so that the test sees it whatever
+// the including file's order.
+//
+
+struct Systronix_i2c_error
+	{
+	boolean		exists;									// set false in init() when the device does not ack
+	uint8_t		error_val;								// the most recent value passed to tally_transaction()
+	uint32_t	successful_count;
+	uint32_t	incomplete_write_count;
+	uint32_t	data_len_error_count;
+	uint32_t	timeout_count;
+	uint32_t	rcv_addr_nack_count;
+	uint32_t	rcv_data_nack_count;
+	uint32_t	other_error_count;
+	uint32_t	silly_programmer_error;
+	uint64_t	total_error_count;
+	};
+
+#if !defined (__error_t_defined)
+typedef Systronix_i2c_error	error_t;
+#endif
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_i2c_common
+	{
+	public:
+		void		tally_transaction (uint8_t value, Systronix_i2c_error* error_ptr);
+	};
+
+extern Systronix_i2c_common i2c_common;
+
+#endif	// M24C32_HOST_H_
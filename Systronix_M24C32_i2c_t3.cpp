@@ -0,0 +1,29 @@
+#if defined (ARDUINO)
+
+#include <Arduino.h>
+#include <Systronix_M24C32_i2c_t3.h>
+
+
+//---------------------------< B E G I N >--------------------------------------------------------------------
+//
+// I2C_PINS_18_19 or I2C_PINS_29_30
+//
+
+void Systronix_M24C32_i2c_t3::begin (i2c_pins pins, i2c_rate rate)
+	{
+	_bus->begin (I2C_MASTER, 0x00, pins, I2C_PULLUP_EXT, rate);	// join I2C as master
+	_bus->setDefaultTimeout (200000); 							// 200ms
+	}
+
+
+//---------------------------< D E F A U L T   B E G I N >----------------------------------------------------
+//
+//
+//
+
+void Systronix_M24C32_i2c_t3::begin (void)
+	{
+	_bus->begin();				// initialize I2C as master
+	}
+
+#endif	// ARDUINO
@@ -0,0 +1,57 @@
+#ifndef M24C32_I2C_T3_H_
+#define	M24C32_I2C_T3_H_
+
+//
+// Systronix_M24C32_i2c_t3.h
+//
+// Systronix_M24C32_transport backed by a Teensy i2c_t3 bus object.  Holds a pointer to the bus (Wire, Wire1,
+// ...) rather than a copy so that every driver on a bus shares the one i2c_t3 instance and its state.
+//
+
+#if defined (ARDUINO)
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Arduino.h>
+#include <Systronix_i2c_common.h>
+#include <Systronix_M24C32_transport.h>
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_i2c_t3 : public Systronix_M24C32_transport
+	{
+	protected:
+		i2c_t3*		_bus;									// the Wire, Wire1, ... object this transport drives
+
+	public:
+		Systronix_M24C32_i2c_t3 (i2c_t3& bus = Wire) : _bus (&bus) {}
+
+		void		bus_set (i2c_t3& bus) {_bus = &bus;}
+
+		void		begin (void);
+		void		begin (i2c_pins pins, i2c_rate rate);
+
+		void		beginTransmission (uint8_t address) {_bus->beginTransmission (address);}
+		size_t		write (uint8_t data) {return _bus->write (data);}
+		size_t		write (const uint8_t* data, size_t quantity) {return _bus->write (data, quantity);}
+		uint8_t		endTransmission (i2c_stop sendStop = I2C_STOP) {return _bus->endTransmission (sendStop);}
+		void		sendTransmission (i2c_stop sendStop = I2C_STOP) {_bus->sendTransmission (sendStop);}
+
+		size_t		requestFrom (uint8_t address, size_t len, i2c_stop sendStop) {return _bus->requestFrom (address, len, sendStop);}
+		void		sendRequest (uint8_t address, size_t len, i2c_stop sendStop) {_bus->sendRequest (address, len, sendStop);}
+		uint8_t		readByte (void) {return _bus->readByte ();}
+		size_t		read (uint8_t* data, size_t count) {return _bus->read (data, count);}
+
+		uint8_t		done (void) {return _bus->done ();}
+		uint8_t		status (void) {return _bus->status ();}
+
+		uint32_t	millis (void) {return ::millis ();}
+		uint32_t	micros (void) {return ::micros ();}
+	};
+
+#endif	// ARDUINO
+#endif	// M24C32_I2C_T3_H_
@@ -0,0 +1,258 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32.h>
+#include <stdio.h>
+
+#if EEP_INSTRUMENT
+
+//---------------------------< B U C K E T >------------------------------------------------------------------
+//
+// log2 histogram bucket for value: 0 for 0, otherwise the number of significant bits, capped at the last bucket
+//
+
+static uint8_t bucket (uint32_t value)
+	{
+	uint8_t	n;
+
+	if (0 == value)
+		return 0;
+	n = 32 - __builtin_clz (value);
+	return (n < EEP_HIST_BUCKETS) ? n : (EEP_HIST_BUCKETS - 1);
+	}
+
+
+//---------------------------< M E T E R   W R I T E >--------------------------------------------------------
+//
+//
+//
+
+size_t Systronix_M24C32_meter::write (uint8_t data)
+	{
+	size_t	n = _bus->write (data);
+
+	_tx_len += n;
+	return n;
+	}
+
+size_t Systronix_M24C32_meter::write (const uint8_t* data, size_t quantity)
+	{
+	size_t	n = _bus->write (data, quantity);
+
+	_tx_len += n;
+	return n;
+	}
+
+
+//---------------------------< M E T E R   E N D T R A N S M I S S I O N >------------------------------------
+//
+// An address nack (2) puts only the slave address byte on the bus; anything else is counted as the whole
+// transmission.
+//
+
+uint8_t Systronix_M24C32_meter::endTransmission (i2c_stop sendStop)
+	{
+	uint8_t	ret_val = _bus->endTransmission (sendStop);
+
+	transactions++;
+	bytes += (2 == ret_val) ? 1 : (1 + _tx_len);
+	return ret_val;
+	}
+
+void Systronix_M24C32_meter::sendTransmission (i2c_stop sendStop)
+	{
+	transactions++;
+	bytes += 1 + _tx_len;									// outcome not yet known; counted as sent
+	_bus->sendTransmission (sendStop);
+	}
+
+
+//---------------------------< M E T E R   R E Q U E S T F R O M >--------------------------------------------
+//
+//
+//
+
+size_t Systronix_M24C32_meter::requestFrom (uint8_t address, size_t len, i2c_stop sendStop)
+	{
+	size_t	n = _bus->requestFrom (address, len, sendStop);
+
+	transactions++;
+	bytes += 1 + n;
+	return n;
+	}
+
+void Systronix_M24C32_meter::sendRequest (uint8_t address, size_t len, i2c_stop sendStop)
+	{
+	transactions++;
+	bytes += 1 + len;
+	_bus->sendRequest (address, len, sendStop);
+	}
+
+
+//---------------------------< O P _ S C O P E >--------------------------------------------------------------
+//
+// Constructed at the top of a timed operation and destroyed on any of its returns.  Operations called from
+// inside another timed operation (byte_read() calls current_address_read(), compare-before-write calls read(),
+// ...) are part of the outer one and are not recorded on their own.  Success is judged by the value the
+// operation returned, which EEP_OP_RETURN() hands to result(): a compare-before-write that finds nothing to
+// write or a zero-length read() succeeds without calling tally_transaction().
+//
+
+Systronix_M24C32::op_scope::op_scope (Systronix_M24C32* e, uint8_t o, size_t p)
+	{
+	eep = e;
+	op = (0 == e->_instr_depth++) ? o : EEP_OPS;			// EEP_OPS: nested; don't record
+	payload = p;
+	t0_us = e->_wire->micros ();
+	bytes0 = e->_meter.bytes;
+	transactions0 = e->_meter.transactions;
+	ret_val = FAIL;
+	}
+
+Systronix_M24C32::op_scope::~op_scope (void)
+	{
+	uint32_t	us;
+
+	eep->_instr_depth--;
+	if (EEP_OPS == op)
+		return;
+
+	us = eep->_wire->micros () - t0_us;
+	eep->_instr.op[op].count++;
+	eep->_instr.op[op].total_us += us;
+	if (us > eep->_instr.op[op].max_us)
+		eep->_instr.op[op].max_us = us;
+	eep->_instr.op[op].hist[bucket (us)]++;
+	eep->_instr.op[op].bus_bytes += eep->_meter.bytes - bytes0;
+	eep->_instr.op[op].transactions += eep->_meter.transactions - transactions0;
+
+	if (SUCCESS == ret_val)
+		eep->_instr.op[op].payload += payload;
+	else
+		eep->_instr.op[op].failed++;
+	}
+
+
+//---------------------------< I N S T R _ W A I T >----------------------------------------------------------
+//
+// Called when the device has just acked after spins nacked polls (or nacked write attempts).  When spins is
+// not zero the device was in its write cycle and the time since the write that started it is the observed tW
+// (to within one poll).
+//
+
+void Systronix_M24C32::instr_wait (uint32_t spins)
+	{
+	uint32_t	tw_us;
+	uint32_t	n;
+
+	if (0 == spins)
+		return;												// ready on the first try; nothing observed
+
+	_instr.spins += spins;
+	_instr.waits++;
+	_instr.spin_hist[bucket (spins)]++;
+
+	tw_us = _wire->micros () - _write_us;
+	if (tw_us > _instr.tw_max_us)
+		_instr.tw_max_us = tw_us;
+	n = tw_us / EEP_TW_BUCKET_US;
+	_instr.tw_hist[(n < EEP_TW_BUCKETS) ? n : (EEP_TW_BUCKETS - 1)]++;
+	}
+
+
+//---------------------------< I N S T R _ S N A P S H O T >--------------------------------------------------
+//
+//
+//
+
+void Systronix_M24C32::instr_snapshot (struct eep_instr* out)
+	{
+	memcpy (out, &_instr, sizeof(_instr));
+	}
+
+
+//---------------------------< I N S T R _ C L E A R >--------------------------------------------------------
+//
+//
+//
+
+void Systronix_M24C32::instr_clear (void)
+	{
+	memset (&_instr, 0, sizeof(_instr));
+	}
+
+
+//---------------------------< H I S T _ D U M P >------------------------------------------------------------
+//
+// one or more lines listing the non-empty buckets of a histogram as upper bound:count.  step is 0 for log2
+// buckets (upper bound 2^n) or the width of linear buckets in us (upper bound printed in ms).
+//
+
+static void hist_dump (void (*line) (const char* text), const char* label, const uint32_t* hist, uint8_t buckets, uint32_t step)
+	{
+	char		text[96];
+	size_t		used;
+
+	used = snprintf (text, sizeof(text), "           %s <", label);
+	for (uint8_t b=0; b<buckets; b++)
+		{
+		if (!hist[b])
+			continue;
+		if (used > (sizeof(text) - 24))
+			{
+			snprintf (&text[used], sizeof(text) - used, "\n");
+			line (text);
+			used = snprintf (text, sizeof(text), "             ");
+			}
+		if ((buckets - 1) == b)
+			used += snprintf (&text[used], sizeof(text) - used, " inf:%lu", (unsigned long)hist[b]);
+		else if (step)
+			used += snprintf (&text[used], sizeof(text) - used, " %.1f:%lu", ((b + 1) * step) / 1000.0, (unsigned long)hist[b]);
+		else
+			used += snprintf (&text[used], sizeof(text) - used, " %lu:%lu", 1UL << b, (unsigned long)hist[b]);
+		}
+	snprintf (&text[used], sizeof(text) - used, "\n");
+	line (text);
+	}
+
+
+//---------------------------< I N S T R _ D U M P >----------------------------------------------------------
+//
+// Format everything measured as text and hand it to line() one line at a time, e.g.
+//		eep.instr_dump ([](const char* text){Serial.print (text);});
+//
+
+void Systronix_M24C32::instr_dump (void (*line) (const char* text))
+	{
+	static const char*	names[EEP_OPS] = {"byte_read", "byte_write", "page_read", "page_write", "current_read", "read", "write"};
+	char		text[96];
+
+	snprintf (text, sizeof(text), "eep 0x%.2X %-12s %8s %6s %8s %8s %8s %8s\n", _base, "op", "count", "failed", "avg_us", "max_us", "txn/op", "bus/byte");
+	line (text);
+
+	for (uint8_t i=0; i<EEP_OPS; i++)
+		{
+		if (0 == _instr.op[i].count)
+			continue;
+
+		snprintf (text, sizeof(text), "         %-12s %8lu %6lu %8lu %8lu %8.2f %8.2f\n", names[i],
+			(unsigned long)_instr.op[i].count, (unsigned long)_instr.op[i].failed,
+			(unsigned long)(_instr.op[i].total_us / _instr.op[i].count), (unsigned long)_instr.op[i].max_us,
+			(double)_instr.op[i].transactions / _instr.op[i].count,
+			_instr.op[i].payload ? (double)_instr.op[i].bus_bytes / _instr.op[i].payload : 0.0);
+		line (text);
+		hist_dump (line, "us", _instr.op[i].hist, EEP_HIST_BUCKETS, 0);
+		}
+
+	snprintf (text, sizeof(text), "         tW waits %lu; max %luus; nacked polls %lu\n",
+		(unsigned long)_instr.waits, (unsigned long)_instr.tw_max_us, (unsigned long)_instr.spins);
+	line (text);
+
+	if (!_instr.waits)
+		return;
+
+	hist_dump (line, "tW ms", _instr.tw_hist, EEP_TW_BUCKETS, EEP_TW_BUCKET_US);
+	hist_dump (line, "polls/wait", _instr.spin_hist, EEP_HIST_BUCKETS, 0);
+	}
+
+#endif	// EEP_INSTRUMENT
@@ -0,0 +1,115 @@
+#ifndef M24C32_INSTR_H_
+#define	M24C32_INSTR_H_
+
+//
+// Systronix_M24C32_instr.h
+//
+// Optional instrumentation for Systronix_M24C32: per-operation latency histograms, the observed write cycle
+// (tW) distribution, ack poll spin counts, and bytes on the bus per payload byte.  Off by default; set
+// EEP_INSTRUMENT to 1 in Systronix_M24C32_config.h or with -DEEP_INSTRUMENT=1 for the whole build.  With
+// EEP_INSTRUMENT 0 none of this code or RAM exists and the driver talks to its transport directly.
+//
+// Bus traffic is counted by Systronix_M24C32_meter, a transport that sits between the driver and the real
+// transport and forwards every call.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32_config.h>
+#include <Systronix_M24C32_transport.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_OP_BYTE_READ	0						// eep_instr.op[] index
+#define		EEP_OP_BYTE_WRITE	1
+#define		EEP_OP_PAGE_READ	2						// includes int16_read() and int32_read()
+#define		EEP_OP_PAGE_WRITE	3						// includes int16_write() and int32_write()
+#define		EEP_OP_CURRENT_READ	4
+#define		EEP_OP_READ			5						// read(), typed read(), crc_read(), verify()
+#define		EEP_OP_WRITE		6						// write(), typed write(), crc_write()
+#define		EEP_OPS				7
+
+#define		EEP_HIST_BUCKETS	16						// latency: bucket n counts [2^(n-1), 2^n) us; bucket 0 is < 1us
+#define		EEP_TW_BUCKETS		24						// observed tW: bucket n counts [n, n+1) * EEP_TW_BUCKET_US
+#define		EEP_TW_BUCKET_US	500
+
+
+#if EEP_INSTRUMENT
+#define		EEP_OP_SCOPE(op, payload)	op_scope instr_scope (this, op, payload)	// times the enclosing function
+#define		EEP_OP_RETURN(ret_val)		return instr_scope.result (ret_val)		// every return of a timed function
+#else
+#define		EEP_OP_SCOPE(op, payload)
+#define		EEP_OP_RETURN(ret_val)		return (ret_val)
+#endif
+
+
+#if EEP_INSTRUMENT
+
+//---------------------------< E E P _ I N S T R >------------------------------------------------------------
+//
+// everything measured; copy it with instr_snapshot() or print it with instr_dump()
+//
+
+struct eep_instr
+	{
+	struct
+		{
+		uint32_t	count;								// operations completed (successful or not)
+		uint32_t	failed;
+		uint32_t	max_us;
+		uint64_t	total_us;
+		uint32_t	payload;							// data bytes moved by successful operations
+		uint32_t	bus_bytes;							// bytes on the bus, slave address bytes included
+		uint32_t	transactions;						// address phases
+		uint32_t	hist[EEP_HIST_BUCKETS];				// latency histogram
+		} op[EEP_OPS];
+
+	uint32_t	tw_hist[EEP_TW_BUCKETS];				// write cycles that had to be waited out, by observed length
+	uint32_t	tw_max_us;
+	uint32_t	spin_hist[EEP_HIST_BUCKETS];			// nacked ack polls per wait; bucket n counts [2^(n-1), 2^n)
+	uint32_t	spins;									// nacked ack polls (and nacked write attempts) in total
+	uint32_t	waits;									// waits that needed at least one nacked poll
+	};
+
+
+//---------------------------< M E T E R >--------------------------------------------------------------------
+//
+// counting transport; forwards to bus
+//
+
+class Systronix_M24C32_meter : public Systronix_M24C32_transport
+	{
+	protected:
+		Systronix_M24C32_transport*	_bus;
+		size_t		_tx_len;							// bytes queued since beginTransmission()
+
+	public:
+		uint32_t	bytes;								// bytes on the bus including slave address bytes
+		uint32_t	transactions;						// address phases
+
+		Systronix_M24C32_meter (void) {_bus = NULL; _tx_len = 0; bytes = 0; transactions = 0;}
+		void		bus_set (Systronix_M24C32_transport* bus) {_bus = bus;}
+
+		void		begin (void) {_bus->begin ();}
+		void		begin (i2c_pins pins, i2c_rate rate) {_bus->begin (pins, rate);}
+		void		beginTransmission (uint8_t address) {_tx_len = 0; _bus->beginTransmission (address);}
+		size_t		write (uint8_t data);
+		size_t		write (const uint8_t* data, size_t quantity);
+		uint8_t		endTransmission (i2c_stop sendStop = I2C_STOP);
+		void		sendTransmission (i2c_stop sendStop = I2C_STOP);
+		size_t		requestFrom (uint8_t address, size_t len, i2c_stop sendStop);
+		void		sendRequest (uint8_t address, size_t len, i2c_stop sendStop);
+		uint8_t		readByte (void) {return _bus->readByte ();}
+		size_t		read (uint8_t* data, size_t count) {return _bus->read (data, count);}
+		uint8_t		done (void) {return _bus->done ();}
+		uint8_t		status (void) {return _bus->status ();}
+		uint32_t	millis (void) {return _bus->millis ();}
+		uint32_t	micros (void) {return _bus->micros ();}
+		void		hold (void) {_bus->hold ();}
+		void		release (void) {_bus->release ();}
+		uint32_t	epoch (void) {return _bus->epoch ();}
+	};
+
+#endif	// EEP_INSTRUMENT
+#endif	// M24C32_INSTR_H_
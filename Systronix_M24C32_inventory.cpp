@@ -0,0 +1,170 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_inventory.h>
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_inventory::Systronix_M24C32_inventory (void)
+	{
+	_map = NULL;
+	memset (&_image, 0, sizeof(_image));
+	memset (_state, EEP_INV_ABSENT, sizeof(_state));
+	_dirty = false;
+	memset (&stats, 0, sizeof(stats));
+	}
+
+
+//---------------------------< S E T U P >--------------------------------------------------------------------
+//
+//
+//
+
+uint8_t Systronix_M24C32_inventory::setup (Systronix_M24C32_mux& map)
+	{
+	_map = &map;
+	return SUCCESS;
+	}
+
+
+//---------------------------< C A N D I D A T E S >----------------------------------------------------------
+//
+// Add eep (set up on the map's bus) at ports 0 - 7 of the mux at mux_addr; every board on that mux's ports
+// answers at eep's base address.  Returns the number of nodes added.
+//
+
+uint8_t Systronix_M24C32_inventory::candidates (uint8_t mux_addr, Systronix_M24C32& eep)
+	{
+	uint8_t	added = 0;
+
+	for (uint8_t port=0; port<8; port++)
+		if (EEP_MUX_NONE != _map->add (mux_addr, port, eep))
+			added++;
+	return added;
+	}
+
+
+//---------------------------< S C A N >----------------------------------------------------------------------
+//
+// Probe every node of the map in node order (add candidates mux by mux so that each mux is opened once) by
+// reading its identity page; one sequential read per node.  Each node's state() is set; parse, if given, is
+// called with the page of every board that is EEP_INV_CHANGED.  The eeprom instances of boards found are left
+// with error.exists set so the map's read() and write() work on them; the others are left as init() would.
+//
+// A map that has grown or shrunk since the hashes were taken invalidates them: every board is then parsed.
+//
+// Returns the number of boards present.
+//
+
+uint8_t Systronix_M24C32_inventory::scan (void (*parse)(uint8_t node, const uint8_t* page))
+	{
+	uint8_t		page[EEP_INV_PAGE_LEN];
+	uint8_t		nodes = _map->nodes ();
+	uint8_t		ret_val;
+	uint32_t	h;
+	Systronix_M24C32*	eep;
+
+	if (_image.nodes != nodes)
+		{
+		memset (_image.hash, 0, sizeof(_image.hash));		// hashes belong to a different map
+		_image.nodes = nodes;
+		_dirty = true;
+		}
+
+	stats.present = 0;
+	stats.parsed = 0;
+	for (uint8_t n=0; n<nodes; n++)
+		{
+		eep = _map->eep (n);
+		ret_val = _map->select (n);						// ABSENT without bus traffic behind a missing mux
+		if (SUCCESS == ret_val)
+			{
+			eep->error.exists = true;						// the read is the probe
+			stats.probes++;
+			ret_val = eep->read (EEP_INV_PAGE_ADDR, page, EEP_INV_PAGE_LEN);
+			}
+
+		if (SUCCESS != ret_val)
+			{
+			eep->error.exists = false;
+			_state[n] = _image.hash[n] ? EEP_INV_REMOVED : EEP_INV_ABSENT;
+			if (_image.hash[n])
+				{
+				_image.hash[n] = 0;
+				_dirty = true;
+				}
+			continue;
+			}
+
+		stats.present++;
+		h = eep_crc32 (0, page, EEP_INV_PAGE_LEN);
+		if (h && (h == _image.hash[n]))
+			{
+			_state[n] = EEP_INV_SAME;
+			continue;
+			}
+
+		_state[n] = EEP_INV_CHANGED;
+		_image.hash[n] = h;
+		_dirty = true;
+		if (parse)
+			{
+			parse (n, page);
+			stats.parsed++;
+			}
+		}
+
+	for (uint8_t n=0; n<nodes; n++)						// an instance shared with absent nodes was cleared above
+		if ((EEP_INV_SAME == _state[n]) || (EEP_INV_CHANGED == _state[n]))
+			_map->eep (n)->error.exists = true;
+
+	return stats.present;
+	}
+
+
+//---------------------------< L O A D >----------------------------------------------------------------------
+//
+// Restore the hashes that save() wrote at addr in nv.  Returns SUCCESS, or CRC_ERROR (image torn, never
+// written, or saved for a different map) in which case the hashes are cleared and the next scan() parses every
+// board; other failures as nv.read().
+//
+
+uint8_t Systronix_M24C32_inventory::load (Systronix_M24C32_nvram& nv, uint32_t addr)
+	{
+	uint8_t	ret_val;
+
+	ret_val = nv.read (addr, (uint8_t*)&_image, 4);		// header: how many hashes follow
+	if ((SUCCESS == ret_val) && ((_map->nodes () != _image.nodes) || (EEP_MUX_NODES_MAX < _image.nodes)))
+		ret_val = CRC_ERROR;
+	if (SUCCESS == ret_val)
+		ret_val = nv.crc_read (addr, (uint8_t*)&_image, image_len (), EEP_CRC32);
+
+	if (SUCCESS != ret_val)
+		memset (&_image, 0, sizeof(_image));
+	_dirty = false;
+	return ret_val;
+	}
+
+
+//---------------------------< S A V E >----------------------------------------------------------------------
+//
+// Store the hashes at addr in nv with a CRC-32; needs save_size() bytes.  Nothing is written when no hash has
+// changed since the last load() or save(), so an unchanged system costs no write cycles at boot.
+//
+
+uint8_t Systronix_M24C32_inventory::save (Systronix_M24C32_nvram& nv, uint32_t addr)
+	{
+	uint8_t	ret_val;
+
+	if (!_dirty)
+		return SUCCESS;
+
+	ret_val = nv.crc_write (addr, (const uint8_t*)&_image, image_len (), EEP_CRC32);
+	if (SUCCESS == ret_val)
+		_dirty = false;
+	return ret_val;
+	}
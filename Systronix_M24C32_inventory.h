@@ -0,0 +1,78 @@
+#ifndef M24C32_INVENTORY_H_
+#define	M24C32_INVENTORY_H_
+
+//
+// Systronix_M24C32_inventory.h
+//
+// Boot-time inventory of board eeproms.  The candidate locations are the nodes of a Systronix_M24C32_mux map;
+// candidates() adds one eeprom instance (usually shared, at 0x57) at every port of a mux.  scan() visits every
+// node once and reads its identity page (EEP_INV_PAGE_LEN bytes at EEP_INV_PAGE_ADDR, the assembly page) with a
+// single sequential read; the read is also the probe, since a missing board nacks the address phase.  Nodes
+// behind a mux that is not fitted cost no bus traffic at all once Systronix_M24C32_mux::init() has run.
+//
+// A CRC-32 of each identity page is kept.  A board whose page hashes the same as at the last scan is reported
+// EEP_INV_SAME and is not handed to the parse callback; only new, replaced, or re-programmed boards are.  The
+// hashes live in RAM and can be kept across power cycles with save() and load() on any nvram (FRAM or eeprom);
+// the saved image has its own stored checksum so a torn or stale image only costs one full parse.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32_mux.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_INV_PAGE_ADDR	0						// identity (assembly) page
+#define		EEP_INV_PAGE_LEN	32
+
+#define		EEP_INV_ABSENT		0						// state(): nothing answered at this node
+#define		EEP_INV_SAME		1						// present; identity page unchanged since the last scan
+#define		EEP_INV_CHANGED		2						// present; new board or identity page differs
+#define		EEP_INV_REMOVED		3						// was present at the last scan, absent now
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_inventory
+	{
+	protected:
+		Systronix_M24C32_mux*	_map;
+
+		struct
+			{
+			uint8_t		nodes;							// map size when the hashes were taken
+			uint8_t		reserved[3];
+			uint32_t	hash[EEP_MUX_NODES_MAX];		// CRC-32 of the identity page; 0 when no board
+			} _image;									// what save() and load() move; only the used hashes are stored
+		uint8_t		_state[EEP_MUX_NODES_MAX];
+		uint8_t		_dirty;								// hashes changed since load() / save()
+
+		size_t		image_len (void) {return 4 + (4 * _image.nodes);}
+
+	public:
+		struct
+			{
+			uint32_t	probes;							// identity page reads attempted
+			uint32_t	present;						// boards found by the last scan
+			uint32_t	parsed;							// boards handed to the parse callback by the last scan
+			} stats;
+
+		Systronix_M24C32_inventory (void);
+
+		uint8_t		setup (Systronix_M24C32_mux& map);
+		uint8_t		candidates (uint8_t mux_addr, Systronix_M24C32& eep);	// eep at every port; returns nodes added
+
+		uint8_t		scan (void (*parse)(uint8_t node, const uint8_t* page) = NULL);	// returns boards present
+		uint8_t		state (uint8_t node) {return (node < EEP_MUX_NODES_MAX) ? _state[node] : EEP_INV_ABSENT;}
+		uint32_t	hash (uint8_t node) {return (node < _image.nodes) ? _image.hash[node] : 0;}
+
+		uint8_t		load (Systronix_M24C32_nvram& nv, uint32_t addr);	// hashes from the last boot
+		uint8_t		save (Systronix_M24C32_nvram& nv, uint32_t addr);	// no write when nothing changed
+		size_t		save_size (void) {return 4 + (4 * EEP_MUX_NODES_MAX) + 4;}	// nvram to set aside: image and CRC-32
+	};
+
+#endif	// M24C32_INVENTORY_H_
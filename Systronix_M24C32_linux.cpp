@@ -0,0 +1,292 @@
+#if defined (__linux__) && !defined (ARDUINO)
+
+#include <Systronix_M24C32_linux.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_linux::Systronix_M24C32_linux (void)
+	{
+	_fd = -1;
+	_tx_len = 0;
+	_tx_overflow = false;
+	_held = false;
+	_rx_len = 0;
+	_rx_pos = 0;
+	_status = I2C_WAITING;
+	_poll_nacked = false;
+	_poll_us = LINUX_POLL_US;
+	memset (&stats, 0, sizeof(stats));
+	}
+
+
+//---------------------------< D E S T R U C T O R >----------------------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_linux::~Systronix_M24C32_linux (void)
+	{
+	close ();
+	}
+
+
+//---------------------------< O P E N >----------------------------------------------------------------------
+//
+// open /dev/i2c-bus (or path); the slave address travels with each message so no I2C_SLAVE is needed
+//
+
+uint8_t Systronix_M24C32_linux::open (uint8_t bus)
+	{
+	char	path[20];
+
+	snprintf (path, sizeof(path), "/dev/i2c-%d", bus);
+	return open (path);
+	}
+
+uint8_t Systronix_M24C32_linux::open (const char* path)
+	{
+	close ();
+	_fd = ::open (path, O_RDWR | O_CLOEXEC);
+	return (0 > _fd) ? FAIL : SUCCESS;
+	}
+
+
+//---------------------------< C L O S E >--------------------------------------------------------------------
+
+void Systronix_M24C32_linux::close (void)
+	{
+	if (0 <= _fd)
+		::close (_fd);
+	_fd = -1;
+	}
+
+
+//---------------------------< S Y S T E M   C A L L S >------------------------------------------------------
+//
+//
+//
+
+int Systronix_M24C32_linux::sys_ioctl (unsigned long request, void* arg)
+	{
+	return ::ioctl (_fd, request, arg);
+	}
+
+void Systronix_M24C32_linux::sys_sleep_us (uint32_t us)
+	{
+	struct timespec	ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+
+	nanosleep (&ts, NULL);
+	}
+
+uint64_t Systronix_M24C32_linux::sys_now_ns (void)
+	{
+	struct timespec	ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+	}
+
+
+//---------------------------< T R A N S F E R >--------------------------------------------------------------
+//
+// One I2C_RDWR ioctl: START, the messages with a repeated start between each, STOP.  When the previous
+// transfer to the same address nacked, the device is most likely in a write cycle and this is a retry (an ack
+// poll, or a page write that is its own ack poll): sleep poll_us first.
+//
+// Adapters report a nack as ENXIO, EREMOTEIO, or EIO depending on the driver, and do not say which phase
+// nacked: any of these is returned as an address nack (2), anything else as 4.
+//
+
+uint8_t Systronix_M24C32_linux::transfer (struct i2c_msg* msgs, uint32_t count)
+	{
+	struct i2c_rdwr_ioctl_data	data = {msgs, count};
+
+	if (_poll_nacked && (msgs[0].addr == _poll_addr) && _poll_us)
+		{
+		stats.sleeps++;
+		sys_sleep_us (_poll_us);
+		}
+
+	stats.ioctls++;
+	if (1 < count)
+		stats.combined++;
+
+	_poll_addr = (uint8_t)msgs[0].addr;
+	_poll_nacked = false;
+	if (0 > sys_ioctl (I2C_RDWR, &data))
+		{
+		if ((ENXIO == errno) || (EREMOTEIO == errno) || (EIO == errno))
+			{
+			stats.nacks++;
+			_poll_nacked = true;
+			_status = I2C_ADDR_NAK;
+			return 2;
+			}
+		_status = (ETIMEDOUT == errno) ? I2C_TIMEOUT : I2C_ARB_LOST;
+		return 4;
+		}
+
+	for (uint32_t i=0; i<count; i++)
+		stats.bytes += msgs[i].len;
+	_status = I2C_WAITING;
+	return SUCCESS;
+	}
+
+
+//---------------------------< F L U S H >--------------------------------------------------------------------
+//
+// A held write that is not followed by its read goes out by itself.  Nobody is waiting for its result (the
+// caller's endTransmission (I2C_NOSTOP) has already returned SUCCESS), so this is best effort: a failure is
+// counted in stats.orphan_errors and left in _status, where status() sees it until the next transfer.
+//
+
+uint8_t Systronix_M24C32_linux::flush (void)
+	{
+	struct i2c_msg	msg = {_tx_addr, 0, (uint16_t)_tx_len, _tx_buf};
+	uint8_t			ret_val;
+
+	if (!_held)
+		return SUCCESS;
+	_held = false;
+	stats.orphans++;
+	ret_val = transfer (&msg, 1);
+	if (SUCCESS != ret_val)
+		stats.orphan_errors++;
+	return ret_val;
+	}
+
+
+//---------------------------< B E G I N T R A N S M I S S I O N >--------------------------------------------
+
+void Systronix_M24C32_linux::beginTransmission (uint8_t address)
+	{
+	flush ();											// an orphaned NOSTOP write; its result is in stats and _status
+	_tx_addr = address;
+	_tx_len = 0;
+	_tx_overflow = false;
+	}
+
+
+//---------------------------< W R I T E >--------------------------------------------------------------------
+//
+// add to the tx buffer; 0 when it is full (as i2c_t3)
+//
+
+size_t Systronix_M24C32_linux::write (uint8_t data)
+	{
+	if (I2C_TX_BUFFER_LENGTH <= _tx_len)
+		{
+		_tx_overflow = true;
+		return 0;
+		}
+	_tx_buf[_tx_len++] = data;
+	return 1;
+	}
+
+size_t Systronix_M24C32_linux::write (const uint8_t* data, size_t quantity)
+	{
+	for (size_t i=0; i<quantity; i++)
+		if (0 == write (data[i]))
+			return i;
+	return quantity;
+	}
+
+
+//---------------------------< E N D T R A N S M I S S I O N >------------------------------------------------
+//
+// I2C_STOP: send the tx buffer now; I2C_NOSTOP: hold it for the requestFrom() that follows
+//
+// returns 0 (success or held), 1 (tx buffer overflowed), 2 (nack), or 4 (other error)
+//
+
+uint8_t Systronix_M24C32_linux::endTransmission (i2c_stop sendStop)
+	{
+	struct i2c_msg	msg = {_tx_addr, 0, (uint16_t)_tx_len, _tx_buf};
+
+	if (_tx_overflow)
+		{
+		_status = I2C_BUF_OVF;
+		return 1;
+		}
+
+	if (I2C_NOSTOP == sendStop)
+		{
+		_held = true;
+		return SUCCESS;
+		}
+
+	return transfer (&msg, 1);
+	}
+
+
+//---------------------------< R E Q U E S T F R O M >--------------------------------------------------------
+//
+// Read len bytes (no more than the rx buffer) into the rx buffer.  A held write to the same address goes in
+// the same ioctl ahead of the read.  sendStop is ignored: the ioctl always ends with STOP, and an eeprom
+// continues a sequential read across a STOP, START pair just as across a repeated start.
+//
+// returns the number of bytes received: len or 0
+//
+
+size_t Systronix_M24C32_linux::requestFrom (uint8_t address, size_t len, i2c_stop sendStop)
+	{
+	struct i2c_msg	msgs[2];
+	uint32_t		count = 0;
+
+	(void)sendStop;
+	if (_held && (address != _tx_addr))
+		flush ();
+
+	if (I2C_RX_BUFFER_LENGTH < len)
+		len = I2C_RX_BUFFER_LENGTH;
+
+	if (_held)
+		{
+		msgs[count].addr = _tx_addr;
+		msgs[count].flags = 0;
+		msgs[count].len = (uint16_t)_tx_len;
+		msgs[count++].buf = _tx_buf;
+		_held = false;
+		}
+	msgs[count].addr = address;
+	msgs[count].flags = I2C_M_RD;
+	msgs[count].len = (uint16_t)len;
+	msgs[count++].buf = _rx_buf;
+
+	_rx_pos = 0;
+	_rx_len = (SUCCESS == transfer (msgs, count)) ? len : 0;
+	return _rx_len;
+	}
+
+
+//---------------------------< R E A D B Y T E >--------------------------------------------------------------
+
+uint8_t Systronix_M24C32_linux::readByte (void)
+	{
+	return (_rx_pos < _rx_len) ? _rx_buf[_rx_pos++] : 0;
+	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+
+size_t Systronix_M24C32_linux::read (uint8_t* data, size_t count)
+	{
+	if (count > (_rx_len - _rx_pos))
+		count = _rx_len - _rx_pos;
+	memcpy (data, &_rx_buf[_rx_pos], count);
+	_rx_pos += count;
+	return count;
+	}
+
+#endif	// __linux__ && !ARDUINO
@@ -0,0 +1,120 @@
+#ifndef M24C32_LINUX_H_
+#define	M24C32_LINUX_H_
+
+//
+// Systronix_M24C32_linux.h
+//
+// Systronix_M24C32_transport for Linux i2c-dev (/dev/i2c-N) so the driver runs on Linux gateway boards.  Every
+// transaction is one I2C_RDWR ioctl:
+//
+//		endTransmission (I2C_STOP)			one write message
+//		endTransmission (I2C_NOSTOP)		held, not sent: the address write of a random read.  The requestFrom()
+//											that follows sends it and the read as two messages of one ioctl, so
+//											the kernel puts a repeated start between them exactly as page_read()
+//											does on i2c_t3.  A held write has not been acked yet; endTransmission()
+//											returns 0 and a nack shows up as a short requestFrom() instead.
+//		requestFrom ()						one read message (a current address read), or the held write and the
+//											read together
+//
+// While an eeprom is in its write cycle it nacks everything: ack polls (ping_eeprom_timed(), an address-only
+// write sent as a zero-length message; the adapter must support those, as most do) and page writes that are
+// their own ack poll alike.  After a nack the next transfer to the same address sleeps poll_us first rather than
+// spin on the ioctl, so waiting out a write cycle costs about 2 * tW / poll_us system calls instead of one
+// ioctl per bus turnaround, at the price of up to poll_us of extra latency; poll_interval_set (0) spins.
+//
+// The non-blocking calls (sendTransmission(), sendRequest()) complete before they return; done() is always 1.
+// The bus rate belongs to the kernel (device tree or module parameter); begin (pins, rate) ignores it.
+//
+// The three system calls are virtual so that a test can stand something else behind the same interface: the
+// host benchmark (extras/linux_bench) routes the ioctls into Systronix_M24C32_sim.
+//
+
+#if defined (__linux__) && !defined (ARDUINO)
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32_transport.h>
+#include <linux/i2c.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		LINUX_POLL_US		500						// ack poll interval after a nack
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_linux : public Systronix_M24C32_transport
+	{
+	protected:
+		int			_fd;
+
+		uint8_t		_tx_addr;
+		uint8_t		_tx_buf[I2C_TX_BUFFER_LENGTH];
+		size_t		_tx_len;
+		boolean		_tx_overflow;
+		boolean		_held;								// _tx_buf is an I2C_NOSTOP write waiting for its read
+
+		uint8_t		_rx_buf[I2C_RX_BUFFER_LENGTH];
+		size_t		_rx_len;
+		size_t		_rx_pos;
+
+		uint8_t		_status;							// i2c_status of the most recent transaction
+		uint8_t		_poll_addr;							// address of the most recent transfer
+		boolean		_poll_nacked;						// and it nacked
+		uint32_t	_poll_us;
+
+		uint8_t		transfer (struct i2c_msg* msgs, uint32_t count);	// one I2C_RDWR; returns as endTransmission()
+		uint8_t		flush (void);						// send a held write on its own; best effort, counted in stats
+
+		virtual int			sys_ioctl (unsigned long request, void* arg);
+		virtual void		sys_sleep_us (uint32_t us);
+		virtual uint64_t	sys_now_ns (void);			// CLOCK_MONOTONIC; not a system call (vdso) and not counted
+
+	public:
+		struct
+			{
+			uint32_t	ioctls;
+			uint32_t	sleeps;
+			uint32_t	combined;						// ioctls that carried a write and a read
+			uint32_t	nacks;
+			uint32_t	bytes;							// payload bytes moved, written and read
+			uint32_t	orphans;						// held I2C_NOSTOP writes sent alone (flush())
+			uint32_t	orphan_errors;					// of those, nacked or failed
+			} stats;
+
+		Systronix_M24C32_linux (void);
+		virtual ~Systronix_M24C32_linux (void);
+
+		uint8_t		open (uint8_t bus);					// /dev/i2c-bus; SUCCESS or FAIL (errno set)
+		uint8_t		open (const char* path);
+		void		close (void);
+		void		poll_interval_set (uint32_t us) {_poll_us = us;}
+		uint32_t	syscalls (void) {return stats.ioctls + stats.sleeps;}
+
+		void		begin (void) {}
+		void		begin (i2c_pins pins, i2c_rate rate) {(void)pins; (void)rate;}
+
+		void		beginTransmission (uint8_t address);
+		size_t		write (uint8_t data);
+		size_t		write (const uint8_t* data, size_t quantity);
+		uint8_t		endTransmission (i2c_stop sendStop = I2C_STOP);
+		void		sendTransmission (i2c_stop sendStop = I2C_STOP) {endTransmission (sendStop);}
+
+		size_t		requestFrom (uint8_t address, size_t len, i2c_stop sendStop);
+		void		sendRequest (uint8_t address, size_t len, i2c_stop sendStop) {requestFrom (address, len, sendStop);}
+		uint8_t		readByte (void);
+		size_t		read (uint8_t* data, size_t count);
+
+		uint8_t		done (void) {return 1;}
+		uint8_t		status (void) {return _status;}
+
+		uint32_t	millis (void) {return (uint32_t)(sys_now_ns () / 1000000);}	// wraps as the Arduino clocks do
+		uint32_t	micros (void) {return (uint32_t)(sys_now_ns () / 1000);}
+	};
+
+#endif	// __linux__ && !ARDUINO
+#endif	// M24C32_LINUX_H_
@@ -0,0 +1,257 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_log.h>
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_log::Systronix_M24C32_log (void)
+	{
+	_eep = NULL;
+	_pages = 0;
+	_head = 0;
+	_count = 0;
+	_next_seq = 1;
+	memset (&stats, 0, sizeof(stats));
+	}
+
+
+//---------------------------< B E G I N >--------------------------------------------------------------------
+//
+// attach the log to an eep and a range of 32-byte record pages; pages = 0 takes every page from first_page to
+// the end of the part.  Eeproms with pages smaller than a record (M24C01 - M24C16) are refused; FRAM has no
+// pages and is fine.  Call mount() before append() or read().
+//
+
+uint8_t Systronix_M24C32_log::begin (Systronix_M24C32_nvram& eep, uint16_t first_page, uint16_t pages)
+	{
+	uint32_t	available = eep.size () / EEP_PAGE_SIZE;
+
+	if (0 == pages)
+		pages = (first_page < available) ? (available - first_page) : 0;
+
+	if ((eep.page_size () && (EEP_PAGE_SIZE > eep.page_size ())) || (2 > pages) || (available < ((uint32_t)first_page + pages)))
+		return DENIED;
+
+	_eep = &eep;
+	_first = first_page;
+	_pages = pages;
+	_head = 0;
+	_count = 0;
+	_next_seq = 1;
+	return SUCCESS;
+	}
+
+
+//---------------------------< P A G E _ L O A D >------------------------------------------------------------
+//
+// Read range-relative page index into _page and check it.  Returns SUCCESS and the record's sequence number
+// when the page holds a valid record, LOG_EMPTY when it does not (erased, torn, or corrupt), or FAIL when the
+// eep could not be read.
+//
+
+uint8_t Systronix_M24C32_log::page_load (uint16_t index, uint32_t* seq)
+	{
+	uint16_t	crc;
+
+	if (SUCCESS != _eep->read ((_first + index) * EEP_PAGE_SIZE, _page, EEP_PAGE_SIZE))
+		return FAIL;
+
+	crc = _page[EEP_PAGE_SIZE-2] | (_page[EEP_PAGE_SIZE-1] << 8);
+	if ((crc != eep_crc16 (0xFFFF, _page, EEP_PAGE_SIZE - LOG_CRC_SIZE)) || (LOG_PAYLOAD_MAX < _page[4]))
+		{
+		stats.crc_errors++;
+		return LOG_EMPTY;
+		}
+
+	*seq = (uint32_t)_page[0] | ((uint32_t)_page[1] << 8) | ((uint32_t)_page[2] << 16) | ((uint32_t)_page[3] << 24);
+	return SUCCESS;
+	}
+
+
+//---------------------------< M O U N T >--------------------------------------------------------------------
+//
+// Locate the newest record.  With page 0 valid, the predicate 'page i is valid and its sequence number is at
+// least that of page 0' is true from page 0 up to the newest record and false after it, so a binary search
+// finds the head.  If page 0 is not valid then either the log is empty or the append that wrapped back to
+// page 0 was torn; the last page of the range tells which.
+//
+
+uint8_t Systronix_M24C32_log::mount (void)
+	{
+	uint32_t	seq0;
+	uint32_t	seq;
+	uint16_t	lo;										// predicate known true
+	uint16_t	hi;										// predicate known false (or past the end)
+	uint16_t	mid;
+	uint8_t		ret_val;
+
+	if (!_eep)
+		return FAIL;
+
+	stats.mount_reads = 1;
+	ret_val = page_load (0, &seq0);
+	if (FAIL == ret_val)
+		return FAIL;
+
+	if (LOG_EMPTY == ret_val)
+		{
+		stats.mount_reads++;
+		ret_val = page_load (_pages - 1, &seq);
+		if (FAIL == ret_val)
+			return FAIL;
+
+		_head = 0;
+		if (LOG_EMPTY == ret_val)
+			{												// nothing at either end; empty log
+			_count = 0;
+			_next_seq = 1;
+			return SUCCESS;
+			}
+		_count = _pages - 1;								// wrapped; page 0 was torn
+		_next_seq = seq + 1;
+		return SUCCESS;
+		}
+
+	lo = 0;
+	hi = _pages;
+	while ((hi - lo) > 1)
+		{
+		mid = lo + (hi - lo) / 2;
+		stats.mount_reads++;
+		ret_val = page_load (mid, &seq);
+		if (FAIL == ret_val)
+			return FAIL;
+
+		if ((SUCCESS == ret_val) && (seq >= seq0))
+			{
+			lo = mid;
+			seq0 = seq;										// newest seen so far; still >= page 0's
+			}
+		else
+			hi = mid;
+		}
+
+	_head = hi % _pages;									// lo is the newest record
+	_next_seq = seq0 + 1;
+
+	if (hi == _pages)
+		{
+		_count = _pages;									// every page holds a record
+		return SUCCESS;
+		}
+
+	stats.mount_reads++;									// is the page after the newest an older record?
+	ret_val = page_load (hi, &seq);
+	if (FAIL == ret_val)
+		return FAIL;
+
+	_count = (SUCCESS == ret_val) ? _pages : hi;
+	if ((SUCCESS != ret_val) && (hi + 1 < _pages))
+		{													// head page torn; older records may follow
+		stats.mount_reads++;
+		ret_val = page_load (hi + 1, &seq);
+		if (FAIL == ret_val)
+			return FAIL;
+		if (SUCCESS == ret_val)
+			_count = _pages - 1;
+		}
+	return SUCCESS;
+	}
+
+
+//---------------------------< F O R M A T >------------------------------------------------------------------
+//
+// erase every page in the range; the log is empty afterward
+//
+
+uint8_t Systronix_M24C32_log::format (void)
+	{
+	if (!_eep)
+		return FAIL;
+
+	memset (_page, 0xFF, EEP_PAGE_SIZE);
+	for (uint16_t i=0; i<_pages; i++)
+		if (SUCCESS != _eep->write ((_first + i) * EEP_PAGE_SIZE, _page, EEP_PAGE_SIZE))
+			return FAIL;
+
+	_head = 0;
+	_count = 0;
+	_next_seq = 1;
+	return SUCCESS;
+	}
+
+
+//---------------------------< A P P E N D >------------------------------------------------------------------
+//
+// write a record of len (up to LOG_PAYLOAD_MAX) bytes at the head; the oldest record is overwritten when the
+// ring is full.  One page write.
+//
+
+uint8_t Systronix_M24C32_log::append (const uint8_t* data, uint8_t len)
+	{
+	uint16_t	crc;
+
+	if (!_eep)
+		return FAIL;
+
+	if (LOG_PAYLOAD_MAX < len)
+		return DENIED;
+
+	if (0xFFFFFFFF == _next_seq)
+		return DENIED;										// sequence numbers exhausted; format()
+
+	memset (_page, 0xFF, EEP_PAGE_SIZE);
+	_page[0] = (uint8_t)_next_seq;
+	_page[1] = (uint8_t)(_next_seq >> 8);
+	_page[2] = (uint8_t)(_next_seq >> 16);
+	_page[3] = (uint8_t)(_next_seq >> 24);
+	_page[4] = len;
+	memcpy (&_page[LOG_HEADER_SIZE], data, len);
+	crc = eep_crc16 (0xFFFF, _page, EEP_PAGE_SIZE - LOG_CRC_SIZE);
+	_page[EEP_PAGE_SIZE-2] = (uint8_t)crc;
+	_page[EEP_PAGE_SIZE-1] = (uint8_t)(crc >> 8);
+
+	if (SUCCESS != _eep->write ((_first + _head) * EEP_PAGE_SIZE, _page, EEP_PAGE_SIZE))
+		return FAIL;
+
+	_head = (_head + 1) % _pages;
+	_next_seq++;
+	if (_count < _pages)
+		_count++;
+	stats.appends++;
+	return SUCCESS;
+	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+//
+// Read record n where 0 is the oldest and count()-1 the newest.  data must hold LOG_PAYLOAD_MAX bytes.
+// Returns LOG_EMPTY if record n does not exist or fails its CRC.
+//
+
+uint8_t Systronix_M24C32_log::read (uint16_t n, uint8_t* data, uint8_t* len, uint32_t* seq)
+	{
+	uint32_t	s;
+	uint8_t		ret_val;
+
+	if (!_eep)
+		return FAIL;
+
+	if (n >= _count)
+		return LOG_EMPTY;
+
+	ret_val = page_load ((_head + _pages - _count + n) % _pages, &s);	// oldest is _count pages behind the head
+	if (SUCCESS != ret_val)
+		return ret_val;
+
+	*len = _page[4];
+	memcpy (data, &_page[LOG_HEADER_SIZE], *len);
+	if (seq)
+		*seq = s;
+	return SUCCESS;
+	}
@@ -0,0 +1,78 @@
+#ifndef M24C32_LOG_H_
+#define	M24C32_LOG_H_
+
+//
+// Systronix_M24C32_log.h
+//
+// Wear-levelled append-only record log over a range of eep pages (by default all of them; 128 on the M24C32).
+// Each record occupies exactly one 32-byte page so every append is a single page write, and appends walk the
+// range as a ring so that wear is spread evenly over every page in it.  On parts with larger pages a 'page'
+// here is a 32-byte slot within one; slots never straddle a device page so an append is still one write.
+//
+// record (page) layout:
+//		0x00 - 0x03:	sequence number; uint32_t little endian; the first record is 1; 0xFFFFFFFF is never used
+//		0x04:			payload length; 0 - LOG_PAYLOAD_MAX
+//		0x05 - 0x1D:	payload; unused bytes are 0xFF
+//		0x1E - 0x1F:	CRC-16/CCITT-FALSE of bytes 0x00 - 0x1D; uint16_t little endian
+//
+// An erased page or a page torn by a power loss fails its CRC and is treated as empty.  Sequence numbers
+// increase from the start of the range up to the newest record and then drop (older records, or empty pages
+// if the ring has not yet wrapped).  mount() finds that drop with a binary search so it reads about
+// log2(pages) + 2 pages no matter how full the log is.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		LOG_HEADER_SIZE		5						// sequence number and length
+#define		LOG_CRC_SIZE		2
+#define		LOG_PAYLOAD_MAX		(EEP_PAGE_SIZE - LOG_HEADER_SIZE - LOG_CRC_SIZE)	// 25 bytes
+
+#define		LOG_EMPTY			0xFB					// read() of a record that does not exist
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_log
+	{
+	protected:
+		Systronix_M24C32_nvram*	_eep;
+		uint16_t	_first;								// first page of the log's range
+		uint16_t	_pages;								// number of pages in the range
+		uint16_t	_head;								// range-relative page that the next append() writes
+		uint16_t	_count;								// number of valid records
+		uint32_t	_next_seq;							// sequence number of the next append()
+
+		uint8_t		_page[EEP_PAGE_SIZE];				// page buffer
+
+		uint8_t		page_load (uint16_t index, uint32_t* seq);	// read and check a range-relative page
+
+	public:
+		struct
+			{
+			uint32_t	appends;
+			uint32_t	mount_reads;					// pages read by the most recent mount()
+			uint32_t	crc_errors;						// pages that failed their CRC (includes erased pages)
+			} stats;
+
+		Systronix_M24C32_log (void);
+
+		uint8_t		begin (Systronix_M24C32_nvram& eep, uint16_t first_page = 0, uint16_t pages = 0);	// 0: to the end of the part
+		uint8_t		mount (void);						// find the newest record; call after begin()
+		uint8_t		format (void);						// invalidate every record in the range
+
+		uint8_t		append (const uint8_t* data, uint8_t len);
+		uint8_t		read (uint16_t n, uint8_t* data, uint8_t* len, uint32_t* seq = NULL);	// n = 0 is the oldest record
+
+		uint16_t	count (void) {return _count;}
+		uint32_t	newest_seq (void) {return _next_seq - 1;}	// 0 when the log is empty
+	};
+
+#endif	// M24C32_LOG_H_
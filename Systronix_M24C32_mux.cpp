@@ -0,0 +1,414 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_mux.h>
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_mux::Systronix_M24C32_mux (void)
+	{
+#if defined (ARDUINO)
+	_wire = &_i2c_t3;							// Wire until setup() says otherwise
+#else
+	_wire = NULL;								// host: setup() must supply a transport
+#endif
+	_nodes = 0;
+	_muxes = 0;
+	_batched = 0;
+	_epoch = 0;
+	memset (&stats, 0, sizeof(stats));
+	}
+
+
+//---------------------------< S E T U P >--------------------------------------------------------------------
+//
+// the bus that the muxes are on; the mapped eeproms must be set up on the same bus
+//
+
+#if defined (ARDUINO)
+uint8_t Systronix_M24C32_mux::setup (i2c_t3& wire)
+	{
+	_i2c_t3.bus_set (wire);				// the i2c_t3 transport refers to wire; it does not copy it
+	return setup (_i2c_t3);
+	}
+#endif
+
+uint8_t Systronix_M24C32_mux::setup (Systronix_M24C32_transport& transport)
+	{
+	_wire = &transport;
+	_epoch = transport.epoch ();
+	invalidate ();
+	return SUCCESS;
+	}
+
+
+//---------------------------< A D D >------------------------------------------------------------------------
+//
+// map an eeprom (already set up; not necessarily initialized, since it cannot be reached until its path is
+// open) to mux_addr (EEP_MUX_BASE_MIN - EEP_MUX_BASE_MAX, or EEP_MUX_ROOT) and port (0 - 7).  Returns the node
+// number used by the other functions or EEP_MUX_NONE.
+//
+
+uint8_t Systronix_M24C32_mux::add (uint8_t mux_addr, uint8_t port, Systronix_M24C32& eep)
+	{
+	uint8_t	mux = EEP_MUX_ROOT;
+
+	if ((EEP_MUX_NODES_MAX <= _nodes) || (EEP_MUX_NONE != node (mux_addr, port, eep.base_get ())))
+		return EEP_MUX_NONE;								// full, or that address is already mapped
+
+	if (EEP_MUX_ROOT != mux_addr)
+		{
+		if ((EEP_MUX_BASE_MIN > mux_addr) || (EEP_MUX_BASE_MAX < mux_addr) || (7 < port))
+			return EEP_MUX_NONE;
+
+		for (mux=0; mux<_muxes; mux++)						// known mux?
+			if (mux_addr == _mux[mux].addr)
+				break;
+
+		if (mux == _muxes)
+			{												// new mux; state unknown until first written
+			_mux[_muxes].addr = mux_addr;
+			_mux[_muxes].control = EEP_MUX_UNKNOWN;
+			_mux[_muxes].exists = true;					// until init() says otherwise
+			_muxes++;
+			}
+		}
+	else
+		port = 0;
+
+	_node[_nodes].eep = &eep;
+	_node[_nodes].mux = mux;
+	_node[_nodes].port = port;
+	return _nodes++;
+	}
+
+
+//---------------------------< I N I T >----------------------------------------------------------------------
+//
+// Close every mapped mux.  A mux that does not ack is marked absent: select() no longer writes it and returns
+// ABSENT for the nodes behind it, so a candidate mux that is not fitted costs one nack here and nothing after.
+// Returns SUCCESS when every mux acked.
+//
+
+uint8_t Systronix_M24C32_mux::init (void)
+	{
+	uint8_t	ret_val = SUCCESS;
+
+	for (uint8_t i=0; i<_muxes; i++)
+		{
+		_mux[i].exists = true;
+		_mux[i].control = EEP_MUX_UNKNOWN;				// force the write
+		if (SUCCESS != control_write (i, 0))
+			{
+			_mux[i].exists = false;
+			ret_val = FAIL;
+			}
+		}
+	return ret_val;
+	}
+
+
+//---------------------------< N O D E >----------------------------------------------------------------------
+//
+// node number of the eeprom at base behind mux_addr:port, or EEP_MUX_NONE
+//
+
+uint8_t Systronix_M24C32_mux::node (uint8_t mux_addr, uint8_t port, uint8_t base)
+	{
+	for (uint8_t i=0; i<_nodes; i++)
+		{
+		if (base != _node[i].eep->base_get ())
+			continue;
+		if (EEP_MUX_ROOT == _node[i].mux)
+			{
+			if (EEP_MUX_ROOT == mux_addr)
+				return i;
+			continue;
+			}
+		if ((mux_addr == _mux[_node[i].mux].addr) && (port == _node[i].port))
+			return i;
+		}
+	return EEP_MUX_NONE;
+	}
+
+
+//---------------------------< F I N D >----------------------------------------------------------------------
+//
+//
+//
+
+Systronix_M24C32* Systronix_M24C32_mux::find (uint8_t mux_addr, uint8_t port, uint8_t base)
+	{
+	return eep (node (mux_addr, port, base));
+	}
+
+
+//---------------------------< I N V A L I D A T E >----------------------------------------------------------
+//
+// forget what every mux control register holds; the next select() writes each mux it needs.  Call after a mux
+// reset or after writing a control register by other means.
+//
+
+void Systronix_M24C32_mux::invalidate (void)
+	{
+	for (uint8_t i=0; i<_muxes; i++)
+		_mux[i].control = EEP_MUX_UNKNOWN;
+	}
+
+
+//---------------------------< C O N T R O L _ W R I T E >----------------------------------------------------
+//
+// set mux's control register to mask unless the cached copy says that it already holds mask.  A failed write
+// leaves the register unknown.
+//
+
+uint8_t Systronix_M24C32_mux::control_write (uint8_t mux, uint8_t mask)
+	{
+	uint8_t	ret_val;
+
+	if (mask == _mux[mux].control)
+		{
+		stats.control_skipped++;
+		return SUCCESS;
+		}
+
+	_wire->beginTransmission (_mux[mux].addr);
+	_wire->write (mask);
+	ret_val = _wire->endTransmission ();
+	stats.control_writes++;
+	if (SUCCESS != ret_val)
+		{
+		_mux[mux].control = EEP_MUX_UNKNOWN;
+		return FAIL;
+		}
+
+	_mux[mux].control = mask;
+	return SUCCESS;
+	}
+
+
+//---------------------------< S E L E C T >------------------------------------------------------------------
+//
+// Open the path to node and only that path: every other mux is closed first (so no two copies of a shared
+// eeprom address are ever visible at once) and then the node's mux is set to the node's port alone.  A node on
+// the main bus closes every mux.  Muxes whose cached register already holds the needed value are not written.
+// Returns ABSENT for a node behind a mux that init() found absent.
+//
+
+uint8_t Systronix_M24C32_mux::select (uint8_t node)
+	{
+	uint8_t		target;
+	uint32_t	epoch;
+	boolean		changed = false;
+
+	if (_nodes <= node)
+		return DENIED;
+
+	epoch = _wire->epoch ();
+	if (epoch != _epoch)
+		{
+		stats.epoch_resets++;
+		invalidate ();									// another client has had the bus; trust no cached register
+		_epoch = epoch;
+		}
+
+	target = _node[node].mux;
+	if ((EEP_MUX_ROOT != target) && !_mux[target].exists)
+		return ABSENT;
+
+	for (uint8_t i=0; i<_muxes; i++)
+		{
+		if ((i == target) || !_mux[i].exists || (0 == _mux[i].control))
+			continue;
+		changed = true;
+		if (SUCCESS != control_write (i, 0))
+			return FAIL;
+		}
+
+	if (EEP_MUX_ROOT != target)
+		{
+		if ((1 << _node[node].port) != _mux[target].control)
+			changed = true;
+		if (SUCCESS != control_write (target, 1 << _node[node].port))
+			return FAIL;
+		}
+
+	if (changed)
+		{
+		stats.path_changes++;
+		_node[node].eep->ptr_drop ();					// an instance shared between nodes saw another device's pointer
+		}
+	return SUCCESS;
+	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+//
+// select() then the eeprom's read(), one rx buffer at a time with the bus held from select() to the end of the
+// piece.  Each piece after the first picks up where the last one stopped, so unless another client has had the
+// bus (and the path had to be reopened) it is a current address read.  returns as Systronix_M24C32::read()
+//
+
+uint8_t Systronix_M24C32_mux::read (uint8_t node, uint32_t addr, uint8_t* buf, size_t len)
+	{
+	Systronix_M24C32*	eep;
+	uint8_t		ret_val;
+	size_t		n;
+
+	if (_nodes <= node)
+		return DENIED;
+
+	eep = _node[node].eep;
+	if (eep->size () < len)
+		return eep->read (addr, buf, len);				// DENIED; the eeprom tallies it
+
+	do
+		{
+		n = (len > I2C_RX_BUFFER_LENGTH) ? I2C_RX_BUFFER_LENGTH : len;
+		_wire->hold ();
+		ret_val = select (node);
+		if (SUCCESS == ret_val)
+			ret_val = eep->read (addr, buf, n);
+		_wire->release ();
+
+		addr = (addr + n) % eep->size ();				// sequential reads roll over from the top of the array
+		buf += n;
+		len -= n;
+		}
+	while (len && (SUCCESS == ret_val));
+	return ret_val;
+	}
+
+
+//---------------------------< W R I T E >--------------------------------------------------------------------
+//
+// select() then the eeprom's write(), one page at a time with the bus held from select() to the end of the
+// page write; the write cycle runs with the bus released.  returns as Systronix_M24C32::write()
+//
+
+uint8_t Systronix_M24C32_mux::write (uint8_t node, uint32_t addr, const uint8_t* buf, size_t len)
+	{
+	Systronix_M24C32*	eep;
+	uint8_t		ret_val;
+	size_t		n;
+
+	if (_nodes <= node)
+		return DENIED;
+
+	eep = _node[node].eep;
+	if ((eep->size () <= addr) || ((size_t)(eep->size () - addr) < len))
+		return eep->write (addr, buf, len);				// DENIED; the eeprom tallies it
+
+	do
+		{
+		n = eep->page_size () - (addr & (eep->page_size () - 1));	// room left in this page
+		if (n > len)
+			n = len;
+		_wire->hold ();
+		ret_val = select (node);
+		if (SUCCESS == ret_val)
+			ret_val = eep->write (addr, buf, n);
+		_wire->release ();
+
+		addr += n;
+		buf += n;
+		len -= n;
+		}
+	while (len && (SUCCESS == ret_val));
+	return ret_val;
+	}
+
+
+//---------------------------< Q U E U E _ R E A D >----------------------------------------------------------
+//
+// add a read to the batch; buf must remain valid until run()
+//
+
+uint8_t Systronix_M24C32_mux::queue_read (uint8_t node, uint32_t addr, uint8_t* buf, size_t len)
+	{
+	if ((_nodes <= node) || (EEP_MUX_BATCH_MAX <= _batched))
+		return DENIED;
+
+	_batch[_batched].node = node;
+	_batch[_batched].write = false;
+	_batch[_batched].addr = addr;
+	_batch[_batched].buf = buf;
+	_batch[_batched].len = len;
+	_batched++;
+	return SUCCESS;
+	}
+
+
+//---------------------------< Q U E U E _ W R I T E >--------------------------------------------------------
+//
+// add a write to the batch; buf must remain valid until run()
+//
+
+uint8_t Systronix_M24C32_mux::queue_write (uint8_t node, uint32_t addr, const uint8_t* buf, size_t len)
+	{
+	if (SUCCESS != queue_read (node, addr, (uint8_t*)buf, len))	// never written through for a write
+		return DENIED;
+
+	_batch[_batched - 1].write = true;
+	return SUCCESS;
+	}
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+//
+// Perform the batch one path at a time.  The first path is the one already open if any queued access uses it,
+// otherwise the path of the oldest access still waiting; every waiting access on that path is then performed in
+// queue order.  A batch that touches n paths therefore opens at most n of them.  Stops at the first failure;
+// the batch is empty afterward either way.
+//
+
+uint8_t Systronix_M24C32_mux::run (void)
+	{
+	boolean		done[EEP_MUX_BATCH_MAX];
+	uint8_t		left = _batched;
+	uint8_t		pick;
+	uint8_t		mux;
+	uint8_t		port;
+	uint8_t		ret_val = SUCCESS;
+
+	memset (done, 0, sizeof(done));
+	while (left && (SUCCESS == ret_val))
+		{
+		pick = EEP_MUX_BATCH_MAX;
+		for (uint8_t i=0; i<_batched; i++)					// an access on the open path?
+			{
+			if (done[i])
+				continue;
+			if (EEP_MUX_BATCH_MAX == pick)
+				pick = i;									// oldest waiting; used if nothing is on the open path
+			mux = _node[_batch[i].node].mux;
+			if ((EEP_MUX_ROOT != mux) && ((1 << _node[_batch[i].node].port) == _mux[mux].control))
+				{
+				pick = i;
+				break;
+				}
+			}
+
+		mux = _node[_batch[pick].node].mux;
+		port = _node[_batch[pick].node].port;
+		for (uint8_t i=pick; (i<_batched) && (SUCCESS == ret_val); i++)	// nothing before pick is on this path
+			{
+			if (done[i] || (mux != _node[_batch[i].node].mux) || (port != _node[_batch[i].node].port))
+				continue;
+
+			if (_batch[i].write)
+				ret_val = write (_batch[i].node, _batch[i].addr, _batch[i].buf, _batch[i].len);
+			else
+				ret_val = read (_batch[i].node, _batch[i].addr, _batch[i].buf, _batch[i].len);
+			done[i] = true;
+			left--;
+			}
+		}
+
+	_batched = 0;
+	return ret_val;
+	}
@@ -0,0 +1,127 @@
+#ifndef M24C32_MUX_H_
+#define	M24C32_MUX_H_
+
+//
+// Systronix_M24C32_mux.h
+//
+// Device map for eeproms behind PCA9548A i2c muxes.  Each eeprom is registered with the mux (0x70 - 0x77) and
+// port (0 - 7) that lead to it, or with EEP_MUX_ROOT when it sits on the main bus.  Before an access the map
+// makes sure that exactly the path to that eeprom is open: the target mux has only the target port enabled and
+// every other mux has no port enabled (downstream boards commonly share one eeprom address, 0x57 on SALT, so
+// two open paths would collide).  The control register value of every mux is cached and a control write is
+// sent only when the register must change, so repeated accesses to the same board cost no mux traffic.
+//
+// queue_read() / queue_write() collect accesses and run() performs them grouped by mux port so each path is
+// opened once per batch.  Accesses to the same eeprom keep their order; accesses to different eeproms may be
+// reordered.
+//
+// One Systronix_M24C32 instance may be added at any number of locations; boards that all answer at 0x57 can
+// share a single instance since only one of them is ever visible.
+//
+// The mux control registers are written directly over the transport (one data byte, the port enable mask) so
+// the map does not depend on the Systronix_PCA9548A library.  Code that writes a mux control register by other
+// means must call invalidate() afterward.
+//
+// On a bus shared through Systronix_M24C32_sched, read() and write() hold the bus from select() to the end of
+// each piece of the access: up to a page for a write, up to an rx buffer for a read, so that another client
+// gets the bus between pieces (and during each write cycle) but never finds the path half open.  When the
+// transport's epoch() shows that another client has had the bus since the last select(), the cached control
+// registers are forgotten and rewritten.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_MUX_BASE_MIN	0x70					// PCA9548A 7-bit addresses
+#define		EEP_MUX_BASE_MAX	0x77
+#define		EEP_MUX_MAX			8						// one bus holds eight PCA9548A
+#define		EEP_MUX_NODES_MAX	64						// eight eeproms on each port of one mux, or one on every port of eight
+#define		EEP_MUX_BATCH_MAX	32						// queued accesses per run()
+
+#define		EEP_MUX_ROOT		0xFF					// add() mux address of an eeprom on the main bus
+#define		EEP_MUX_NONE		0xFF					// add() return when the node could not be added
+#define		EEP_MUX_UNKNOWN		0xFFFF					// cached control register not known; next select writes it
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_mux
+	{
+	protected:
+		struct
+			{
+			Systronix_M24C32*	eep;
+			uint8_t		mux;							// index into _mux[]; EEP_MUX_ROOT for the main bus
+			uint8_t		port;
+			} _node[EEP_MUX_NODES_MAX];
+		uint8_t		_nodes;
+
+		struct
+			{
+			uint8_t		addr;							// 7-bit slave address
+			uint16_t	control;						// cached port enable mask; EEP_MUX_UNKNOWN if not known
+			uint8_t		exists;							// false when init() got no ack; its nodes are ABSENT
+			} _mux[EEP_MUX_MAX];
+		uint8_t		_muxes;
+
+		struct
+			{
+			uint8_t		node;
+			uint8_t		write;							// true for queue_write()
+			uint32_t	addr;
+			uint8_t*	buf;
+			size_t		len;
+			} _batch[EEP_MUX_BATCH_MAX];
+		uint8_t		_batched;
+
+		uint32_t	_epoch;								// _wire->epoch() when the cache was last known good
+
+		Systronix_M24C32_transport*	_wire;				// the bus the muxes are on
+#if defined (ARDUINO)
+		Systronix_M24C32_i2c_t3	_i2c_t3;
+#endif
+
+		uint8_t		control_write (uint8_t mux, uint8_t mask);	// write a control register unless the cache says it holds mask
+
+	public:
+		struct
+			{
+			uint32_t	control_writes;					// mux control register writes sent
+			uint32_t	control_skipped;				// control writes not needed because the cached value matched
+			uint32_t	path_changes;					// selects that had to open a different path
+			uint32_t	epoch_resets;					// cache forgotten because another client had the bus
+			} stats;
+
+		Systronix_M24C32_mux (void);
+
+#if defined (ARDUINO)
+		uint8_t		setup (i2c_t3& wire = Wire);
+#endif
+		uint8_t		setup (Systronix_M24C32_transport& transport);
+		uint8_t		init (void);						// close every mux; FAIL if any does not ack
+
+		uint8_t		add (uint8_t mux_addr, uint8_t port, Systronix_M24C32& eep);	// returns the node number or EEP_MUX_NONE
+		Systronix_M24C32*	find (uint8_t mux_addr, uint8_t port, uint8_t base);	// NULL if not mapped
+		uint8_t		node (uint8_t mux_addr, uint8_t port, uint8_t base);	// node number or EEP_MUX_NONE
+		Systronix_M24C32*	eep (uint8_t node) {return (node < _nodes) ? _node[node].eep : NULL;}
+		uint8_t		nodes (void) {return _nodes;}
+
+		uint8_t		select (uint8_t node);				// open the path to node; no bus traffic if already open
+		void		invalidate (void);					// forget the cached control registers
+
+		uint8_t		read (uint8_t node, uint32_t addr, uint8_t* buf, size_t len);		// select() then eep read(), in pieces
+		uint8_t		write (uint8_t node, uint32_t addr, const uint8_t* buf, size_t len);	// select() then eep write(), a page at a time
+
+		uint8_t		queue_read (uint8_t node, uint32_t addr, uint8_t* buf, size_t len);	// DENIED when the batch is full
+		uint8_t		queue_write (uint8_t node, uint32_t addr, const uint8_t* buf, size_t len);
+		uint8_t		run (void);							// perform and empty the batch; SUCCESS or the first failure
+	};
+
+#endif	// M24C32_MUX_H_
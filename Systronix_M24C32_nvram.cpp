@@ -0,0 +1,377 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_nvram.h>
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_nvram::Systronix_M24C32_nvram (void)
+	{
+	memset (&error, 0, sizeof(error));			// clear the error counters; init() sets error.exists
+	memset (&seg_stats, 0, sizeof(seg_stats));
+	_crc_type = EEP_CRC_NONE;
+	_crc = 0;
+	}
+
+
+//---------------------------< C R C _ R U N >----------------------------------------------------------------
+//
+// fold bytes that have just passed through read() or write() into the running CRC started by crc_start()
+//
+
+void Systronix_M24C32_nvram::crc_run (const uint8_t* buf, size_t len)
+	{
+	if (EEP_CRC_NONE != _crc_type)
+		_crc = eep_crc_update (_crc_type, _crc, buf, len);
+	}
+
+
+//---------------------------< C R C _ S T A R T >------------------------------------------------------------
+//
+// Start (or with EEP_CRC_NONE, stop) a running CRC of every data byte that read(), write(), and the typed
+// templates move from here on.  crc_get() returns the CRC so far.  The CRC is computed chunk by chunk as the
+// data pass through the driver so there is no second pass over the caller's buffer.
+//
+
+void Systronix_M24C32_nvram::crc_start (uint8_t type)
+	{
+	_crc_type = type;
+	_crc = eep_crc_init (type);
+	}
+
+
+//---------------------------< C R C _ W R I T E >------------------------------------------------------------
+//
+// Write len bytes from buf beginning at addr followed immediately by their stored checksum (type EEP_CRC16
+// or EEP_CRC32; little endian).  Each page is assembled in a page buffer with the CRC folded in as the bytes
+// are copied; the checksum goes out in the same page write as the last data bytes unless it crosses into the
+// next page, so a protected region usually costs no more write cycles than an unprotected one.
+//
+// returns SUCCESS, ABSENT, DENIED (bad type or the region and checksum run past the end of the array), or FAIL
+//
+
+uint8_t Systronix_M24C32_nvram::crc_write (uint32_t addr, const uint8_t* buf, size_t len, uint8_t type)
+	{
+	uint8_t		pbuf[EEP_PAGE_MAX];
+	uint8_t		trailer[4];
+	uint8_t		tail_len = eep_crc_size (type);
+	uint8_t		tail_done = 0;
+	uint8_t		saved_type = _crc_type;
+	uint32_t	crc = eep_crc_init (type);
+	size_t		chunk;
+	size_t		data;
+	uint16_t	page = page_size ();
+	uint8_t		ret_val = SUCCESS;
+
+	if (!error.exists)										// exit immediately if device does not exist
+		return ABSENT;
+
+	if ((0 == tail_len) || (size () <= addr) || ((size_t)(size () - addr) < (len + tail_len)))
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+		return DENIED;
+		}
+
+	_crc_type = EEP_CRC_NONE;								// page_put() must not see the trailer
+
+	while (len || (tail_done < tail_len))
+		{
+		if (page)
+			chunk = page - (addr & (page-1));				// room left in this page
+		else
+			chunk = EEP_PAGE_MAX;							// no pages; one write per page buffer
+		if (chunk > (len + tail_len - tail_done))
+			chunk = len + tail_len - tail_done;
+
+		data = (chunk > len) ? len : chunk;
+		memcpy (pbuf, buf, data);
+		crc = eep_crc_update (type, crc, buf, data);
+		buf += data;
+		len -= data;
+
+		if (data < chunk)
+			{												// data done; checksum fills the rest of this chunk
+			for (uint8_t i=0; i<4; i++)
+				trailer[i] = (uint8_t)(crc >> (8 * i));
+			memcpy (&pbuf[data], &trailer[tail_done], chunk - data);
+			tail_done += chunk - data;
+			}
+
+		ret_val = page_put (addr, pbuf, chunk);
+		if (SUCCESS != ret_val)
+			break;
+		addr += chunk;
+		}
+
+	_crc_type = saved_type;
+	return ret_val;
+	}
+
+
+//---------------------------< C R C _ R E A D >--------------------------------------------------------------
+//
+// Read len bytes beginning at addr into buf along with the stored checksum that follows them, in a single
+// sequential read; the CRC is computed chunk by chunk as the data arrive.
+//
+// returns SUCCESS, CRC_ERROR when the data do not match the stored checksum, or as read()
+//
+
+uint8_t Systronix_M24C32_nvram::crc_read (uint32_t addr, uint8_t* buf, size_t len, uint8_t type)
+	{
+	uint8_t		trailer[4];
+	uint8_t		saved_type = _crc_type;
+	uint32_t	saved_crc = _crc;
+	uint32_t	stored = 0;
+	uint8_t		ret_val;
+
+	if (0 == eep_crc_size (type))
+		return DENIED;
+
+	crc_start (type);
+	ret_val = read_stream (addr, buf, len, trailer, eep_crc_size (type));
+	for (uint8_t i=0; i<eep_crc_size (type); i++)
+		stored |= (uint32_t)trailer[i] << (8 * i);
+
+	if ((SUCCESS == ret_val) && (stored != _crc))
+		ret_val = CRC_ERROR;
+
+	_crc_type = saved_type;
+	_crc = saved_crc;
+	return ret_val;
+	}
+
+
+//---------------------------< V E R I F Y >------------------------------------------------------------------
+//
+// Check a region written by crc_write() without a buffer for it: the region is streamed through the CRC in
+// one sequential read and the result compared with the stored checksum.
+//
+// returns SUCCESS, CRC_ERROR, or as read()
+//
+
+uint8_t Systronix_M24C32_nvram::verify (uint32_t addr, size_t len, uint8_t type)
+	{
+	return crc_read (addr, NULL, len, type);
+	}
+
+
+//---------------------------< S E G _ C H E C K >------------------------------------------------------------
+//
+// readv() / writev() argument check: no more than EEP_SEG_MAX segments and each one inside the array
+//
+
+uint8_t Systronix_M24C32_nvram::seg_check (const struct eep_seg* seg, uint8_t count)
+	{
+	if (!error.exists)										// exit immediately if device does not exist
+		return ABSENT;
+
+	if (EEP_SEG_MAX < count)
+		{
+		i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+		return DENIED;
+		}
+
+	for (uint8_t i=0; i<count; i++)
+		if ((size () <= seg[i].addr) || ((size_t)(size () - seg[i].addr) < seg[i].len))
+			{
+			i2c_common.tally_transaction (SILLY_PROGRAMMER, &error);
+			return DENIED;
+			}
+	return SUCCESS;
+	}
+
+
+//---------------------------< R E A D V >--------------------------------------------------------------------
+//
+// Scatter read: fill each of count segments from its address.  The segments are sorted by address and merged
+// into runs wherever they overlap, touch, or are separated by no more than EEP_READV_GAP bytes (cheaper to read
+// through than to start another read).  A run of one segment is read straight into its buffer; a longer run
+// is one sequential read per EEP_PAGE_MAX bytes into a scratch buffer from which every segment copies its part.
+// Segments may overlap and may be given in any order.  Data moved by readv() are not part of the running CRC.
+//
+// returns SUCCESS, ABSENT, DENIED (too many segments or one runs past the end of the array), or as read()
+//
+
+uint8_t Systronix_M24C32_nvram::readv (const struct eep_seg* seg, uint8_t count)
+	{
+	uint8_t		order[EEP_SEG_MAX];
+	uint8_t		scratch[EEP_PAGE_MAX];
+	uint8_t		saved_type = _crc_type;
+	uint8_t		first;									// run is order[first] up to but not including order[last]
+	uint8_t		last;
+	uint8_t		tmp;
+	uint32_t	end;
+	uint32_t	s;
+	uint32_t	e;
+	size_t		n;
+	uint8_t		ret_val = seg_check (seg, count);
+
+	if (SUCCESS != ret_val)
+		return ret_val;
+	seg_stats.readv_calls++;
+
+	for (uint8_t i=0; i<count; i++)							// insertion sort by address; count is small
+		{
+		tmp = i;
+		for (last=i; (0 < last) && (seg[order[last-1]].addr > seg[tmp].addr); last--)
+			order[last] = order[last-1];
+		order[last] = tmp;
+		}
+
+	_crc_type = EEP_CRC_NONE;
+	for (first=0; (first<count) && (SUCCESS == ret_val); first=last)
+		{
+		end = seg[order[first]].addr + seg[order[first]].len;
+		for (last=first+1; last<count; last++)
+			{
+			if (seg[order[last]].addr > (end + EEP_READV_GAP))
+				break;										// too far; starts the next run
+			if ((seg[order[last]].addr + seg[order[last]].len) > end)
+				end = seg[order[last]].addr + seg[order[last]].len;
+			}
+		seg_stats.runs++;
+
+		if (1 == (last - first))
+			{
+			seg_stats.reads++;
+			ret_val = read (seg[order[first]].addr, seg[order[first]].buf, seg[order[first]].len);
+			continue;
+			}
+
+		for (uint32_t w=seg[order[first]].addr; (w<end) && (SUCCESS == ret_val); w+=n)
+			{
+			n = ((end - w) > sizeof(scratch)) ? sizeof(scratch) : (end - w);
+			seg_stats.reads++;
+			ret_val = read (w, scratch, n);
+			for (uint8_t i=first; (i<last) && (SUCCESS == ret_val); i++)
+				{
+				s = (seg[order[i]].addr > w) ? seg[order[i]].addr : w;		// this window's part of the segment
+				e = seg[order[i]].addr + seg[order[i]].len;
+				if (e > (w + n))
+					e = w + n;
+				if (s < e)
+					memcpy (seg[order[i]].buf + (s - seg[order[i]].addr), &scratch[s - w], e - s);
+				}
+			}
+		}
+
+	_crc_type = saved_type;
+	return ret_val;
+	}
+
+
+//---------------------------< W R I T E V >------------------------------------------------------------------
+//
+// Gather write: write each of count segments to its address with one page_put() (one write cycle on an
+// eeprom) per page touched, however many segments fall in it.  For each page the span from the lowest to the
+// highest byte written is assembled in a page buffer; when segments leave holes in that span it is first read
+// back from the part so the holes keep their contents (a read costs far less than a second write cycle).
+// A part with no pages (FRAM) has no write cycle to save, so it is handled in EEP_PAGE_MAX-byte blocks and
+// each contiguous run of segments is one write; nothing is read back.  Segments may be given in any order;
+// where they overlap the later segment in the list wins.  Data moved by writev() are not part of the running
+// CRC.
+//
+// returns SUCCESS, ABSENT, DENIED (too many segments or one runs past the end of the array), or FAIL
+//
+
+uint8_t Systronix_M24C32_nvram::writev (const struct eep_seg* seg, uint8_t count)
+	{
+	uint8_t		pbuf[EEP_PAGE_MAX];
+	uint8_t		covered[EEP_PAGE_MAX / 8];				// bitmap of the page's bytes that some segment writes
+	uint8_t		saved_type = _crc_type;
+	uint32_t	page = page_size () ? page_size () : EEP_PAGE_MAX;
+	uint32_t	next = 0xFFFFFFFF;						// lowest address not yet written; none left when all ones
+	uint32_t	ps;										// page start and end
+	uint32_t	pe;
+	uint32_t	lo;										// span written in this page
+	uint32_t	hi;
+	uint32_t	s;
+	uint32_t	e;
+	boolean		holes;
+	uint8_t		ret_val = seg_check (seg, count);
+
+	if (SUCCESS != ret_val)
+		return ret_val;
+	seg_stats.writev_calls++;
+
+	for (uint8_t i=0; i<count; i++)
+		if (seg[i].len && (seg[i].addr < next))
+			next = seg[i].addr;
+
+	_crc_type = EEP_CRC_NONE;
+	while ((0xFFFFFFFF != next) && (SUCCESS == ret_val))
+		{
+		ps = next & ~(page - 1);
+		pe = ps + page;
+		lo = pe;
+		hi = ps;
+		memset (covered, 0, sizeof(covered));
+		for (uint8_t i=0; i<count; i++)
+			{
+			s = (seg[i].addr > ps) ? seg[i].addr : ps;
+			e = ((seg[i].addr + seg[i].len) < pe) ? (seg[i].addr + seg[i].len) : pe;
+			if (s >= e)
+				continue;									// not in this page
+			if (s < lo)
+				lo = s;
+			if (e > hi)
+				hi = e;
+			for (uint32_t b=s-ps; b<(e-ps); b++)
+				covered[b >> 3] |= (1 << (b & 7));
+			}
+
+		holes = false;
+		for (uint32_t b=lo-ps; b<(hi-ps); b++)
+			if (!(covered[b >> 3] & (1 << (b & 7))))
+				holes = true;
+		if (holes && page_size ())
+			{
+			seg_stats.read_backs++;
+			ret_val = read (lo, &pbuf[lo - ps], hi - lo);	// keep what is between the segments
+			}
+
+		for (uint8_t i=0; (i<count) && (SUCCESS == ret_val); i++)	// list order: later segments overwrite earlier
+			{
+			s = (seg[i].addr > ps) ? seg[i].addr : ps;
+			e = ((seg[i].addr + seg[i].len) < pe) ? (seg[i].addr + seg[i].len) : pe;
+			if (s < e)
+				memcpy (&pbuf[s - ps], seg[i].buf + (s - seg[i].addr), e - s);
+			}
+
+		if (holes && !page_size ())
+			{												// no write cycle to save; one write per covered run
+			for (s=lo; (s<hi) && (SUCCESS == ret_val); s=e)
+				{
+				for (e=s; (e<hi) && (covered[(e-ps) >> 3] & (1 << ((e-ps) & 7))); e++);
+				if (e > s)
+					{
+					seg_stats.page_writes++;
+					ret_val = page_put (s, &pbuf[s - ps], e - s);
+					}
+				else
+					e++;									// skip a hole byte
+				}
+			}
+		else if (SUCCESS == ret_val)
+			{
+			seg_stats.page_writes++;
+			ret_val = page_put (lo, &pbuf[lo - ps], hi - lo);
+			}
+
+		next = 0xFFFFFFFF;
+		for (uint8_t i=0; i<count; i++)						// first byte at or above the next page
+			if (seg[i].len && ((seg[i].addr + seg[i].len) > pe))
+				{
+				s = (seg[i].addr > pe) ? seg[i].addr : pe;
+				if (s < next)
+					next = s;
+				}
+		}
+
+	_crc_type = saved_type;
+	return ret_val;
+	}
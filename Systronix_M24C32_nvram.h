@@ -0,0 +1,172 @@
+#ifndef M24C32_NVRAM_H_
+#define	M24C32_NVRAM_H_
+
+//
+// Systronix_M24C32_nvram.h
+//
+// Abstract non-volatile memory: what the page cache, the record log, and the stored-checksum regions need
+// from a memory part.  Two backends:
+//
+//		Systronix_M24C32			M24Cxx eeprom: page-split writes, tW write cycles, ack polling
+//		Systronix_M24C32_fram		MB85RC FRAM: no pages, no write cycle; any write goes out as soon as the
+//									bus is free, split only where the i2c tx buffer is full
+//
+// Code written against this interface gets the backend's own read(), write(), and page_put() so it runs the
+// fastest path for whichever part it is bound to.  The running CRC, crc_write(), crc_read(), verify(), and
+// the typed read<T>() / write<T>() templates are implemented here once, on top of the backend primitives.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#if defined (ARDUINO)
+#include <Arduino.h>
+#include <Systronix_i2c_common.h>
+#else
+#include <Systronix_M24C32_host.h>
+#endif
+#include <Systronix_M24C32_parts.h>
+#include <Systronix_M24C32_crc.h>
+#include <type_traits>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		DENIED				0xFE
+#define		CRC_ERROR			0xFA					// crc_read() / verify(): data do not match the stored checksum
+
+#define		EEP_SEG_MAX			32						// segments per readv() / writev()
+#define		EEP_READV_GAP		4						// readv() reads through gaps this short rather than start a new read
+
+#if defined (ARDUINO)
+typedef error_t				eep_error_t;			// the Systronix_i2c_common error struct
+#else
+typedef Systronix_i2c_error	eep_error_t;			// its host stand-in; glibc may have error_t
+#endif
+
+
+//---------------------------< E E P _ T Y P E _ C H E C K >--------------------------------------------------
+//
+// Compile-time checks shared by the typed read() and write() templates.  Referencing multi_page instantiates
+// the checks.
+//
+
+template <typename T> struct eep_type_check
+	{
+	static_assert (std::is_trivially_copyable<T>::value, "typed eep access needs a trivially copyable type");
+	static_assert (!std::is_pointer<T>::value, "pass the object, not a pointer to it; or use read()/write() with a length");
+	static_assert (sizeof(T) <= EEP_SIZE_MAX, "type is larger than the largest eep");
+
+	static const boolean multi_page = (sizeof(T) > EEP_PAGE_MAX);		// can never fit in one page
+	};
+
+
+//---------------------------< E E P _ S E G >----------------------------------------------------------------
+//
+// one segment of a readv() / writev() list; like struct iovec plus the memory address
+//
+
+struct eep_seg
+	{
+	uint32_t	addr;
+	uint8_t*	buf;									// writev() does not write through it
+	size_t		len;
+	};
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_nvram
+	{
+	protected:
+		uint8_t		_crc_type;							// running CRC of data through read() / write(); see crc_start()
+		uint32_t	_crc;
+		void		crc_run (const uint8_t* buf, size_t len);
+
+		// backend primitives.  page_put() is one write operation of len bytes known to lie inside the array and
+		// within one page (or, with no pages, no more than EEP_PAGE_MAX bytes); no range check, no split.
+		// read_stream() is read() followed in the same sequential read by tail_len bytes that go to tail and
+		// are not part of the running CRC; buf may be NULL to run the data through the CRC only.
+
+		virtual uint8_t		page_put (uint32_t addr, const uint8_t* buf, size_t len) = 0;
+		virtual uint8_t		read_stream (uint32_t addr, uint8_t* buf, size_t len, uint8_t* tail, size_t tail_len) = 0;
+
+		uint8_t		seg_check (const struct eep_seg* seg, uint8_t count);	// every segment inside the array
+
+		static constexpr uint32_t page_need (uint32_t addr, size_t len, uint32_t page = 8)	// smallest page that holds len at addr; 0: none
+			{return (EEP_PAGE_MAX < page) ? 0 : (page >= ((addr & (page-1)) + len)) ? page : page_need (addr, len, page * 2);}
+
+	public:
+		eep_error_t	error;								// error struct typdefed in Systronix_i2c_common.h (eep_error_t above)
+
+		struct											// readv() / writev(); seg_ so that the backends' own stats are not hidden
+			{
+			uint32_t	readv_calls;
+			uint32_t	runs;							// runs readv() merged the segments into
+			uint32_t	reads;							// read() calls readv() made; a run longer than EEP_PAGE_MAX takes several
+			uint32_t	writev_calls;
+			uint32_t	page_writes;					// page_put() calls writev() made: write cycles on an eeprom
+			uint32_t	read_backs;						// pages whose holes writev() read back first
+			} seg_stats;
+
+		Systronix_M24C32_nvram (void);
+		virtual ~Systronix_M24C32_nvram (void) {}
+
+		virtual uint8_t		write (uint32_t addr, const uint8_t* buf, size_t len) = 0;	// any length and alignment
+		virtual uint8_t		read (uint32_t addr, uint8_t* buf, size_t len) = 0;			// any length up to the whole array
+		virtual uint32_t	size (void) = 0;			// bytes
+		virtual uint16_t	page_size (void) = 0;		// bytes per write page; 0 when the part has no pages (FRAM)
+
+		// typed access for trivially copyable T (scalars, structs, arrays); no need for the control struct.
+		// page_fit<T>(addr, page) is true when a T placed at addr lies within a single page of that size.
+
+		template <typename T> static constexpr boolean page_fit (uint32_t addr, uint16_t page = 32)	// default: M24C32 page
+			{return (sizeof(T) <= page) && (page >= ((addr & (page-1)) + sizeof(T)));}
+
+		template <typename T> uint8_t write (uint32_t addr, const T& value)		// write (0x100, settings);
+			{
+			uint16_t	page = page_size ();
+
+			if (eep_type_check<T>::multi_page || (size () <= addr) || ((size () - addr) < sizeof(T)) || (page && !page_fit<T>(addr, page)))
+				return write (addr, (const uint8_t*)&value, sizeof(T));			// range check and page split
+			return page_put (addr, (const uint8_t*)&value, sizeof(T));			// one write operation
+			}
+
+		template <uint32_t ADDR, typename T> uint8_t write (const T& value)		// write<0x100> (settings);
+			{
+			static_assert ((ADDR + sizeof(T)) <= EEP_SIZE_MAX, "write runs past the end of the largest eep");
+			constexpr uint32_t need = page_need (ADDR, sizeof(T));				// 0 when no page size can hold it
+			uint16_t	page = page_size ();
+
+			(void)eep_type_check<T>::multi_page;
+			if ((0 == need) || (page && (page < need)) || (size () < (ADDR + sizeof(T))))
+				return write (ADDR, (const uint8_t*)&value, sizeof(T));			// range check and page split
+			return page_put (ADDR, (const uint8_t*)&value, sizeof(T));			// one write operation
+			}
+
+		template <typename T> uint8_t read (uint32_t addr, T& value)				// read (0x100, settings);
+			{
+			static_assert (!std::is_const<T>::value, "cannot read into a const object");
+			(void)eep_type_check<T>::multi_page;									// reads are not limited by pages
+			return read (addr, (uint8_t*)&value, sizeof(T));
+			}
+
+		template <uint32_t ADDR, typename T> uint8_t read (T& value)				// read<0x100> (settings);
+			{
+			static_assert ((ADDR + sizeof(T)) <= EEP_SIZE_MAX, "read runs past the end of the largest eep");
+			return read (ADDR, value);
+			}
+
+		void		crc_start (uint8_t type);			// EEP_CRC16, EEP_CRC32, or EEP_CRC_NONE to stop
+		uint32_t	crc_get (void) {return _crc;}		// running CRC of the data moved since crc_start()
+		uint8_t		crc_write (uint32_t addr, const uint8_t* buf, size_t len, uint8_t type = EEP_CRC16);	// data then stored checksum
+		uint8_t		crc_read (uint32_t addr, uint8_t* buf, size_t len, uint8_t type = EEP_CRC16);	// CRC_ERROR on mismatch
+		uint8_t		verify (uint32_t addr, size_t len, uint8_t type = EEP_CRC16);	// stream a crc_write() region; no buffer
+
+		uint8_t		readv (const struct eep_seg* seg, uint8_t count);	// one sequential read per contiguous run
+		uint8_t		writev (const struct eep_seg* seg, uint8_t count);	// one write per page touched
+	};
+
+#endif	// M24C32_NVRAM_H_
@@ -0,0 +1,402 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_pack.h>
+
+
+//---------------------------< V A R I N T   P U T >----------------------------------------------------------
+//
+// bytes written, or 0 when value does not fit in len
+//
+
+static size_t varint_put (uint32_t value, uint8_t* out, size_t len)
+	{
+	size_t	n = 0;
+
+	do
+		{
+		if (n == len)
+			return 0;
+		out[n++] = (uint8_t)((value & 0x7F) | ((0x7F < value) ? 0x80 : 0));
+		value >>= 7;
+		}
+	while (value);
+	return n;
+	}
+
+
+//---------------------------< V A R I N T   G E T >----------------------------------------------------------
+//
+// bytes used, or 0 when in ends first or the varint runs past 32 bits
+//
+
+static size_t varint_get (const uint8_t* in, size_t len, uint32_t* value)
+	{
+	uint32_t	v = 0;
+
+	for (size_t n=0; (n<len) && (n<5); n++)
+		{
+		v |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+		if (!(in[n] & 0x80))
+			{
+			if ((4 == n) && (0x0F < in[n]))
+				return 0;
+			*value = v;
+			return n + 1;
+			}
+		}
+	return 0;
+	}
+
+
+//---------------------------< Z I G Z A G >------------------------------------------------------------------
+//
+// value, sign extended from its low size bytes, with the sign moved to bit 0
+//
+
+static uint32_t zigzag (uint32_t value, uint8_t size)
+	{
+	uint8_t	shift = 32 - (8 * size);
+	int32_t	v = (int32_t)(value << shift) >> shift;
+
+	return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+	}
+
+static uint32_t unzigzag (uint32_t value)
+	{
+	return (value >> 1) ^ (0 - (value & 1));
+	}
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_pack::Systronix_M24C32_pack (void)
+	{
+	_field = NULL;
+	_fields = 0;
+	_rec_size = 0;
+	_dict = NULL;
+	_dict_len = 0;
+	memset (&stats, 0, sizeof(stats));
+	}
+
+
+//---------------------------< S E T U P >--------------------------------------------------------------------
+//
+// Record size, field table, and dictionary; the tables are used in place and must outlive this object.
+// Returns FAIL for a field that does not lie in the record, an integer that is not 1, 2, or 4 bytes, a string
+// field or dictionary string longer than 127, or more than EEP_PK_DICT_MAX strings.
+//
+
+uint8_t Systronix_M24C32_pack::setup (size_t rec_size, const struct eep_pack_field* field, uint8_t fields, const char* const* dict, uint8_t dict_len)
+	{
+	if (!field || !fields || (EEP_PK_FIELDS_MAX < fields) || (EEP_PK_DICT_MAX < dict_len) || (dict_len && !dict))
+		return FAIL;
+
+	for (uint8_t i=0; i<fields; i++)
+		{
+		if (!field[i].size || (rec_size < ((size_t)field[i].offset + field[i].size)))
+			return FAIL;
+		switch (field[i].type)
+			{
+			case EEP_PK_RAW:
+				break;
+			case EEP_PK_UINT:
+			case EEP_PK_INT:
+			case EEP_PK_DELTA:
+				if ((1 != field[i].size) && (2 != field[i].size) && (4 != field[i].size))
+					return FAIL;
+				break;
+			case EEP_PK_STR:
+				if (EEP_PK_LITERAL <= field[i].size)
+					return FAIL;
+				break;
+			default:
+				return FAIL;
+			}
+		}
+	for (uint8_t i=0; i<dict_len; i++)
+		if (EEP_PK_LITERAL <= strlen (dict[i]))
+			return FAIL;
+
+	_field = field;
+	_fields = fields;
+	_rec_size = rec_size;
+	_dict = dict;
+	_dict_len = dict_len;
+	return SUCCESS;
+	}
+
+
+//---------------------------< M A X _ S I Z E >--------------------------------------------------------------
+//
+// bytes one record takes at most; a buffer this size always holds one
+//
+
+size_t Systronix_M24C32_pack::max_size (void)
+	{
+	size_t	n = 0;
+
+	for (uint8_t i=0; i<_fields; i++)
+		{
+		if (EEP_PK_RAW == _field[i].type)
+			n += _field[i].size;
+		else if (EEP_PK_STR == _field[i].type)
+			n += 1 + _field[i].size;
+		else
+			n += ((8 * _field[i].size) + 6) / 7;		// 2, 3, or 5
+		}
+	return n;
+	}
+
+
+//---------------------------< G E T >------------------------------------------------------------------------
+
+uint32_t Systronix_M24C32_pack::get (const uint8_t* rec, const struct eep_pack_field& field)
+	{
+	uint8_t		v8;
+	uint16_t	v16;
+	uint32_t	v32;
+
+	if (1 == field.size)
+		{
+		memcpy (&v8, &rec[field.offset], 1);
+		return v8;
+		}
+	if (2 == field.size)
+		{
+		memcpy (&v16, &rec[field.offset], 2);
+		return v16;
+		}
+	memcpy (&v32, &rec[field.offset], 4);
+	return v32;
+	}
+
+
+//---------------------------< P U T >------------------------------------------------------------------------
+//
+// the low size bytes of value into the field
+//
+
+void Systronix_M24C32_pack::put (uint8_t* rec, const struct eep_pack_field& field, uint32_t value)
+	{
+	uint8_t		v8 = (uint8_t)value;
+	uint16_t	v16 = (uint16_t)value;
+
+	if (1 == field.size)
+		memcpy (&rec[field.offset], &v8, 1);
+	else if (2 == field.size)
+		memcpy (&rec[field.offset], &v16, 2);
+	else
+		memcpy (&rec[field.offset], &value, 4);
+	}
+
+
+//---------------------------< E N C O D E >------------------------------------------------------------------
+//
+// Encode rec, with prev (NULL for none) as the previous record for EEP_PK_DELTA fields, into out.  Returns the
+// number of bytes written, or 0 when they would not fit in len.
+//
+
+size_t Systronix_M24C32_pack::encode (const void* rec, const void* prev, uint8_t* out, size_t len)
+	{
+	const uint8_t*	r = (const uint8_t*)rec;
+	const uint8_t*	p = (const uint8_t*)prev;
+	size_t			n = 0;
+	size_t			k;
+
+	for (uint8_t i=0; i<_fields; i++)
+		{
+		const struct eep_pack_field&	f = _field[i];
+
+		switch (f.type)
+			{
+			case EEP_PK_RAW:
+				k = (f.size <= (len - n)) ? f.size : 0;
+				if (k)
+					memcpy (&out[n], &r[f.offset], f.size);
+				break;
+			case EEP_PK_UINT:
+				k = varint_put (get (r, f), &out[n], len - n);
+				break;
+			case EEP_PK_INT:
+				k = varint_put (zigzag (get (r, f), f.size), &out[n], len - n);
+				break;
+			case EEP_PK_DELTA:
+				k = varint_put (zigzag (get (r, f) - (p ? get (p, f) : 0), f.size), &out[n], len - n);
+				break;
+			default:									// EEP_PK_STR
+				{
+				const char*	s = (const char*)&r[f.offset];
+				uint8_t		s_len = 0;
+				uint8_t		d;
+
+				while ((s_len < f.size) && s[s_len])
+					s_len++;
+				for (d=0; d<_dict_len; d++)
+					if ((s_len == strlen (_dict[d])) && !memcmp (s, _dict[d], s_len))
+						break;
+
+				k = (d < _dict_len) ? 1 : (1 + s_len);
+				if (k > (len - n))
+					k = 0;
+				else if (d < _dict_len)
+					out[n] = d;
+				else
+					{
+					out[n] = EEP_PK_LITERAL + s_len;
+					memcpy (&out[n + 1], s, s_len);
+					}
+				}
+			}
+		if (!k)
+			return 0;
+		n += k;
+		}
+
+	stats.encoded++;
+	return n;
+	}
+
+
+//---------------------------< D E C O D E >------------------------------------------------------------------
+//
+// Decode one record from in into rec, with prev (NULL for none, or rec itself) as the previous record.  Returns
+// the number of bytes used, or 0 when in is malformed or ends first; rec may then be partly written.
+//
+
+size_t Systronix_M24C32_pack::decode (const uint8_t* in, size_t len, void* rec, const void* prev)
+	{
+	uint8_t*		r = (uint8_t*)rec;
+	const uint8_t*	p = (const uint8_t*)prev;
+	size_t			n = 0;
+	size_t			k;
+	uint32_t		v;
+
+	for (uint8_t i=0; i<_fields; i++)
+		{
+		const struct eep_pack_field&	f = _field[i];
+
+		switch (f.type)
+			{
+			case EEP_PK_RAW:
+				k = (f.size <= (len - n)) ? f.size : 0;
+				if (k)
+					memcpy (&r[f.offset], &in[n], f.size);
+				break;
+			case EEP_PK_UINT:
+			case EEP_PK_INT:
+			case EEP_PK_DELTA:
+				k = varint_get (&in[n], len - n, &v);
+				if (!k || ((4 > f.size) && (v >> (8 * f.size))))	// zigzag keeps the width too
+					{
+					k = 0;
+					break;
+					}
+				if (EEP_PK_UINT == f.type)
+					put (r, f, v);
+				else if (EEP_PK_INT == f.type)
+					put (r, f, unzigzag (v));
+				else
+					put (r, f, (p ? get (p, f) : 0) + unzigzag (v));
+				break;
+			default:									// EEP_PK_STR
+				{
+				char*	s = (char*)&r[f.offset];
+				uint8_t	s_len;
+
+				k = 0;
+				if (n == len)
+					break;
+				if (EEP_PK_LITERAL > in[n])
+					{
+					if (in[n] >= _dict_len)
+						break;
+					s_len = strlen (_dict[in[n]]);
+					if (s_len > f.size)
+						break;
+					memcpy (s, _dict[in[n]], s_len);
+					k = 1;
+					}
+				else
+					{
+					s_len = in[n] - EEP_PK_LITERAL;
+					if ((s_len > f.size) || (s_len >= (len - n)))
+						break;
+					memcpy (s, &in[n + 1], s_len);
+					k = 1 + s_len;
+					}
+				memset (&s[s_len], 0, f.size - s_len);
+				}
+			}
+		if (!k)
+			{
+			stats.errors++;
+			return 0;
+			}
+		n += k;
+		}
+
+	stats.decoded++;
+	return n;
+	}
+
+
+//---------------------------< E N C O D E _ N >--------------------------------------------------------------
+//
+// Encode a block of up to n records from the array recs into out: as many whole records as fit in len.  The
+// number encoded goes to count; returns the bytes written.
+//
+
+size_t Systronix_M24C32_pack::encode_n (const void* recs, uint16_t n, uint8_t* out, size_t len, uint16_t* count)
+	{
+	const uint8_t*	r = (const uint8_t*)recs;
+	size_t			used = 0;
+	size_t			k;
+	uint16_t		i;
+
+	for (i=0; i<n; i++)
+		{
+		k = encode (&r[i * _rec_size], i ? &r[(i - 1) * _rec_size] : NULL, &out[used], len - used);
+		if (!k)
+			break;
+		used += k;
+		}
+
+	if (count)
+		*count = i;
+	return used;
+	}
+
+
+//---------------------------< D E C O D E _ N >--------------------------------------------------------------
+//
+// Decode the block in (all len bytes of it) into the array recs, which holds n records.  Returns the number of
+// records, or 0 when the block is malformed or holds more than n.
+//
+
+uint16_t Systronix_M24C32_pack::decode_n (const uint8_t* in, size_t len, void* recs, uint16_t n)
+	{
+	uint8_t*	r = (uint8_t*)recs;
+	size_t		used = 0;
+	size_t		k;
+	uint16_t	i = 0;
+
+	while (used < len)
+		{
+		if (i == n)
+			{
+			stats.errors++;
+			return 0;
+			}
+		k = decode (&in[used], len - used, &r[i * _rec_size], i ? &r[(i - 1) * _rec_size] : NULL);
+		if (!k)
+			return 0;
+		used += k;
+		i++;
+		}
+	return i;
+	}
@@ -0,0 +1,103 @@
+#ifndef M24C32_PACK_H_
+#define	M24C32_PACK_H_
+
+//
+// Systronix_M24C32_pack.h
+//
+// Compact encoding for structured records so that more of them fit in each page write and each sequential
+// read.  A record is a C struct described by a table of eep_pack_field (offset, size, encoding) in the order
+// the fields are to be stored; fields not in the table are not stored and decode() leaves them as they were.
+//
+//		EEP_PK_RAW		size bytes as they are
+//		EEP_PK_UINT		unsigned 1, 2, or 4-byte integer as a varint: 7 bits per byte, low first; 0 - 127 in one
+//		EEP_PK_INT		signed 1, 2, or 4-byte integer, zigzag encoded (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) then
+//						as EEP_PK_UINT
+//		EEP_PK_DELTA	1, 2, or 4-byte integer as the difference from the same field of the previous record,
+//						signed, modulo the field's width, then as EEP_PK_INT; timestamps, sequence numbers,
+//						counters, slowly moving readings.  Without a previous record the difference is from 0.
+//		EEP_PK_STR		null-padded char[size]: one byte, the index of the string in the dictionary given to
+//						setup(), when it is there; else 0x80 + the string's length and the string.  decode()
+//						null-pads to size.
+//
+// encode() and decode() move one record; encode_n() and decode_n() move a block of records in which the first
+// is encoded without a previous record and each of the rest against the one before it, so a block written in
+// one place can be read back without anything outside it.  A block does not store its own length or record
+// count; keep the length next to it (Systronix_M24C32_log keeps a payload length).  decode() may be given the
+// same record as rec and prev, to walk a block with one struct.
+//
+// Nothing here touches the bus: encode into a buffer and hand that to write(); read() into a buffer and decode.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#if defined (ARDUINO)
+#include <Arduino.h>
+#include <Systronix_i2c_common.h>
+#else
+#include <Systronix_M24C32_host.h>
+#endif
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_PK_RAW			0						// eep_pack_field.type
+#define		EEP_PK_UINT			1
+#define		EEP_PK_INT			2
+#define		EEP_PK_DELTA		3
+#define		EEP_PK_STR			4
+
+#define		EEP_PK_LITERAL		0x80					// EEP_PK_STR tag: 0x80 + length, then the string
+#define		EEP_PK_DICT_MAX		0x80					// dictionary strings; tags 0x00 - 0x7F
+#define		EEP_PK_FIELDS_MAX	32
+
+#define		EEP_PK_FIELD(s, f, type)	{(uint16_t)offsetof (s, f), (uint8_t)sizeof (((s*)0)->f), type}	// a table entry
+
+
+//---------------------------< E E P _ P A C K _ F I E L D >--------------------------------------------------
+
+struct eep_pack_field
+	{
+	uint16_t	offset;									// offsetof() the field in the record
+	uint8_t		size;									// 1, 2, or 4 for the integer encodings; up to 127 for a string
+	uint8_t		type;									// EEP_PK_RAW ...
+	};
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_pack
+	{
+	protected:
+		const struct eep_pack_field*	_field;
+		uint8_t		_fields;
+		size_t		_rec_size;
+		const char* const*	_dict;
+		uint8_t		_dict_len;
+
+		uint32_t	get (const uint8_t* rec, const struct eep_pack_field& field);	// an integer field, zero extended
+		void		put (uint8_t* rec, const struct eep_pack_field& field, uint32_t value);
+
+	public:
+		struct
+			{
+			uint32_t	encoded;						// records
+			uint32_t	decoded;
+			uint32_t	errors;							// malformed or truncated input to decode()
+			} stats;
+
+		Systronix_M24C32_pack (void);
+
+		uint8_t		setup (size_t rec_size, const struct eep_pack_field* field, uint8_t fields, const char* const* dict = NULL, uint8_t dict_len = 0);
+		size_t		max_size (void);					// the most bytes one record can take
+
+		size_t		encode (const void* rec, const void* prev, uint8_t* out, size_t len);	// bytes written; 0 when it does not fit
+		size_t		decode (const uint8_t* in, size_t len, void* rec, const void* prev);	// bytes used; 0 when malformed
+
+		size_t		encode_n (const void* recs, uint16_t n, uint8_t* out, size_t len, uint16_t* count);	// as many as fit
+		uint16_t	decode_n (const uint8_t* in, size_t len, void* recs, uint16_t n);	// records; all of in or 0
+	};
+
+#endif	// M24C32_PACK_H_
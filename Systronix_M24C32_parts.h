@@ -0,0 +1,89 @@
+#ifndef M24C32_PARTS_H_
+#define	M24C32_PARTS_H_
+
+//
+// Systronix_M24C32_parts.h
+//
+// Geometry of the ST M24Cxx / M24Mxx I2C eeprom family.  The parts differ in four ways that matter to the
+// driver:
+//		size			128 bytes (M24C01) to 256 KB (M24M02)
+//		page size		16 bytes (M24C01 - M24C16) to 256 bytes (M24M01, M24M02); always a power of two
+//		address bytes	one (M24C01 - M24C16) or two (M24C32 and up)
+//		block bits		memory address bits above the address bytes that ride in the slave address instead:
+//						bit 0 of the slave address holds a8 (or a16), bit 1 a9 (a17), bit 2 a10.  A part with
+//						block bits answers at 1 << block_bits consecutive slave addresses so its base must be
+//						aligned to that many; the M24C16 takes all eight.
+//
+// eep_geometry<>() builds an eep_part and rejects impossible geometry at compile time.  The predefined parts
+// use it; a compatible part from another vendor can be described the same way:
+//
+//		static constexpr eep_part MY_PART = eep_geometry<8192, 32, 2, 0, 5> ();
+//		eep.part_set (MY_PART);
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <stdint.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_PAGE_MAX		256						// largest page in the family; sizes page buffers
+#define		EEP_SIZE_MAX		0x40000UL				// largest part in the family (M24M02)
+
+
+//---------------------------< E E P _ P A R T >--------------------------------------------------------------
+//
+//
+//
+
+struct eep_part
+	{
+	uint32_t	size;									// bytes
+	uint16_t	page_size;								// bytes per page; page writes roll over within a page
+	uint8_t		addr_bytes;								// memory address bytes after the slave address; 1 or 2
+	uint8_t		block_bits;								// memory address bits carried in the slave address; 0 - 3
+	uint8_t		tw_ms;									// write cycle time
+	};
+
+
+//---------------------------< E E P _ G E O M E T R Y >------------------------------------------------------
+//
+// compile-time checked eep_part
+//
+
+template <uint32_t SIZE, uint16_t PAGE, uint8_t ADDR_BYTES, uint8_t BLOCK_BITS, uint8_t TW_MS>
+constexpr eep_part eep_geometry (void)
+	{
+	static_assert ((8 <= PAGE) && (EEP_PAGE_MAX >= PAGE) && (0 == (PAGE & (PAGE - 1))), "page size must be a power of two, 8 - 256");
+	static_assert ((1 == ADDR_BYTES) || (2 == ADDR_BYTES), "one or two memory address bytes");
+	static_assert (3 >= BLOCK_BITS, "at most three slave address bits carry memory address");
+	static_assert ((SIZE >= PAGE) && (0 == (SIZE & (SIZE - 1))), "size must be a power of two and at least one page");
+	static_assert (SIZE <= (1UL << ((8 * ADDR_BYTES) + BLOCK_BITS)), "size needs more address bits than the part has");
+	static_assert (SIZE <= EEP_SIZE_MAX, "larger than EEP_SIZE_MAX");
+	static_assert (0 < TW_MS, "write cycle time");
+
+	return eep_part {SIZE, PAGE, ADDR_BYTES, BLOCK_BITS, TW_MS};
+	}
+
+
+//---------------------------< P A R T S >--------------------------------------------------------------------
+//
+// tW is the datasheet maximum for the common 2.5V - 5.5V (-W / -R) grades; M24C32-X and other 1.6V grades are
+// 10ms: use tw_set() after part_set().
+//
+
+static constexpr eep_part EEP_M24C01 = eep_geometry<0x00080, 16, 1, 0, 5> ();
+static constexpr eep_part EEP_M24C02 = eep_geometry<0x00100, 16, 1, 0, 5> ();
+static constexpr eep_part EEP_M24C04 = eep_geometry<0x00200, 16, 1, 1, 5> ();
+static constexpr eep_part EEP_M24C08 = eep_geometry<0x00400, 16, 1, 2, 5> ();
+static constexpr eep_part EEP_M24C16 = eep_geometry<0x00800, 16, 1, 3, 5> ();
+static constexpr eep_part EEP_M24C32 = eep_geometry<0x01000, 32, 2, 0, 5> ();
+static constexpr eep_part EEP_M24C64 = eep_geometry<0x02000, 32, 2, 0, 5> ();
+static constexpr eep_part EEP_M24128 = eep_geometry<0x04000, 64, 2, 0, 5> ();
+static constexpr eep_part EEP_M24256 = eep_geometry<0x08000, 64, 2, 0, 5> ();
+static constexpr eep_part EEP_M24512 = eep_geometry<0x10000, 128, 2, 0, 5> ();
+static constexpr eep_part EEP_M24M01 = eep_geometry<0x20000, 256, 2, 1, 5> ();
+static constexpr eep_part EEP_M24M02 = eep_geometry<0x40000, 256, 2, 2, 10> ();
+
+#endif	// M24C32_PARTS_H_
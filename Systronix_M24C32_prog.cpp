@@ -0,0 +1,187 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_prog.h>
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_prog::Systronix_M24C32_prog (void)
+	{
+	_eep = NULL;
+	_len = 0;
+	_fed = 0;
+	memset (&result, 0, sizeof(result));
+	result.status = FAIL;						// nothing programmed yet
+	}
+
+
+//---------------------------< B E G I N >--------------------------------------------------------------------
+//
+// Start programming a len-byte image (data and CRC-32 trailer) at addr in eep (set up and initialized).  Reads
+// the target region, one page per read, and keeps a CRC-32 of what each page holds now.
+//
+// returns SUCCESS, ABSENT, DENIED (image shorter than its trailer or past the end of the array), or FAIL
+//
+
+uint8_t Systronix_M24C32_prog::begin (Systronix_M24C32& eep, uint32_t addr, uint32_t len)
+	{
+	uint32_t	page = eep.page_size ();
+	uint32_t	end = addr + len;
+	uint32_t	chunk;
+
+	_eep = &eep;
+	_addr = addr;
+	_len = len;
+	_fed = 0;
+	_crc = eep_crc_init (EEP_CRC32);
+	_page_addr = addr;
+	_fill = 0;
+	_page_no = 0;
+	memset (&result, 0, sizeof(result));
+
+	if (!eep.error.exists)
+		return result.status = ABSENT;
+
+	if ((4 >= len) || (eep.size () <= addr) || ((eep.size () - addr) < len))
+		return result.status = DENIED;
+
+	_t0 = eep.bus_micros ();
+	for (uint16_t n=0; (addr < end) && (n < EEP_PROG_PAGES_MAX); n++)
+		{
+		chunk = page - (addr & (page - 1));				// to the end of this page or of the image
+		if (chunk > (end - addr))
+			chunk = end - addr;
+
+		result.status = eep.read (addr, _page, chunk);	// sequential; no address phase after the first
+		if (SUCCESS != result.status)
+			return result.status;
+		_hash[n] = eep_crc32 (0, _page, chunk);
+		addr += chunk;
+		}
+
+	result.scan_us = eep.bus_micros () - _t0;
+	return SUCCESS;
+	}
+
+
+//---------------------------< P A G E _ F L U S H >----------------------------------------------------------
+//
+// write the assembled page unless the scan says the eeprom already holds it
+//
+
+uint8_t Systronix_M24C32_prog::page_flush (void)
+	{
+	if ((EEP_PROG_PAGES_MAX > _page_no) && (eep_crc32 (0, _page, _fill) == _hash[_page_no]))
+		result.pages_skipped++;
+	else
+		{
+		result.status = _eep->write (_page_addr, _page, _fill);	// returns once the page is on the bus; tW runs on
+		result.pages_written++;
+		}
+
+	_page_addr += _fill;
+	_fill = 0;
+	_page_no++;
+	return result.status;
+	}
+
+
+//---------------------------< F E E D >----------------------------------------------------------------------
+//
+// The next len bytes of the image.  Each page is written (or skipped) as soon as it is complete.  Trailer bytes
+// are checked against the CRC of the data as they arrive; a mismatch stops programming with CRC_ERROR before
+// the page holding the bad byte is written.
+//
+// returns SUCCESS or the failure that stopped programming; once failed, further calls do nothing
+//
+
+uint8_t Systronix_M24C32_prog::feed (const uint8_t* data, size_t len)
+	{
+	uint32_t	page = _eep ? _eep->page_size () : 0;
+	uint32_t	data_len = _len - 4;						// image bytes covered by the trailer
+	size_t		n;
+	size_t		d;
+
+	if (SUCCESS != result.status)
+		return result.status;
+
+	if ((size_t)(_len - _fed) < len)
+		return result.status = DENIED;					// more than the image
+
+	if (0 == _fed)
+		_t0 = _eep->bus_micros ();
+
+	while (len && (SUCCESS == result.status))
+		{
+		n = page - ((_page_addr + _fill) & (page - 1));	// room left in this page
+		if (n > len)
+			n = len;
+
+		memcpy (&_page[_fill], data, n);
+		d = (_fed < data_len) ? (data_len - _fed) : 0;	// data bytes in this piece; the rest are trailer
+		if (d > n)
+			d = n;
+		_crc = eep_crc32 (_crc, data, d);
+		for (size_t i=d; i<n; i++)
+			{
+			if (data[i] != (uint8_t)(_crc >> (8 * (_fed + i - data_len))))
+				return result.status = CRC_ERROR;		// image damaged in transit; this page is not written
+			}
+
+		_fill += n;
+		_fed += n;
+		data += n;
+		len -= n;
+
+		if ((0 == ((_page_addr + _fill) & (page - 1))) || (_fed == _len))
+			page_flush ();
+		}
+
+	return result.status;
+	}
+
+
+//---------------------------< F I N I S H >------------------------------------------------------------------
+//
+// After the last feed(): verify the whole image with one sequential read and fill in result.
+//
+// returns result.status: SUCCESS when every byte is in the eeprom and matches; CRC_ERROR when the image or the
+// read back failed its CRC; DENIED when the image was short; or the failure that stopped programming
+//
+
+uint8_t Systronix_M24C32_prog::finish (void)
+	{
+	uint32_t	t;
+
+	if ((SUCCESS == result.status) && (_fed != _len))
+		result.status = DENIED;							// image ended early
+
+	if (_fed)
+		result.program_us = _eep->bus_micros () - _t0;
+	result.bytes = _fed;
+
+	if (SUCCESS != result.status)
+		return result.status;
+
+	t = _eep->bus_micros ();
+	result.status = _eep->verify (_addr, _len - 4, EEP_CRC32);	// waits out the last write cycle first
+	result.verify_us = _eep->bus_micros () - t;
+	return result.status;
+	}
+
+
+//---------------------------< P R O G R A M >----------------------------------------------------------------
+//
+// begin(), feed(), and finish() for an image already in RAM
+//
+
+uint8_t Systronix_M24C32_prog::program (Systronix_M24C32& eep, uint32_t addr, const uint8_t* image, uint32_t len)
+	{
+	if (SUCCESS == begin (eep, addr, len))
+		feed (image, len);
+	return finish ();
+	}
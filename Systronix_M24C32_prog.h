@@ -0,0 +1,82 @@
+#ifndef M24C32_PROG_H_
+#define	M24C32_PROG_H_
+
+//
+// Systronix_M24C32_prog.h
+//
+// Streaming programmer for eeprom images made by extras/eep_image (or anything else laid out the same way): the
+// image is the data to be written followed by a CRC-32 of the data, little endian, exactly as crc_write()
+// stores it.  begin() gives the target address and the image length (trailer included); feed() takes the image
+// in pieces of any size as they arrive (from an SD file, a serial port, ...); finish() writes what is left,
+// verifies, and fills in result.
+//
+//		scan		begin() reads the target region once, a page at a time (after the first page each read is a
+//					current address read with no address phase), and keeps a CRC-32 of each page
+//		program		feed() assembles whole pages.  A page whose CRC-32 matches the scan is skipped; any other
+//					page is sent with write(), which returns as soon as the page is on the bus, so the write
+//					cycle runs while the caller fetches the next piece of the image.  The next page write is
+//					its own ack poll and goes out the moment the device is ready.
+//		verify		one sequential read of the whole image with the CRC-32 compared against the trailer now in
+//					the eeprom (verify()); no read-back buffer
+//
+// The image's own CRC is checked as it streams past: each trailer byte is compared with the CRC of the data as it
+// arrives and the page holding the first wrong one is not written, so a damaged image is never left in the
+// eeprom with a checksum that matches it.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_PROG_PAGES_MAX	128						// pages scanned by begin(); pages beyond are always written; 4 bytes each
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_prog
+	{
+	protected:
+		Systronix_M24C32*	_eep;
+		uint32_t	_addr;								// eep address of the image's first byte
+		uint32_t	_len;								// image bytes including the 4-byte trailer
+		uint32_t	_fed;								// image bytes received so far
+		uint32_t	_crc;								// running CRC-32 of the image data
+
+		uint8_t		_page[EEP_PAGE_MAX];				// the page being assembled
+		uint32_t	_page_addr;							// eep address of _page[0]
+		uint16_t	_fill;								// bytes in _page
+		uint16_t	_page_no;							// index of the page being assembled; 0 is the page holding _addr
+
+		uint32_t	_hash[EEP_PROG_PAGES_MAX];			// CRC-32 of what each page held at begin()
+		uint32_t	_t0;
+
+		uint8_t		page_flush (void);					// write (or skip) the assembled page
+
+	public:
+		struct
+			{
+			uint8_t		status;							// SUCCESS or the first failure (CRC_ERROR, DENIED, ABSENT, FAIL)
+			uint32_t	bytes;							// image bytes programmed
+			uint16_t	pages_written;
+			uint16_t	pages_skipped;					// already held the image's data
+			uint32_t	scan_us;						// begin()
+			uint32_t	program_us;						// first feed() to the last page on the bus
+			uint32_t	verify_us;						// last write cycle and the read back
+			} result;
+
+		Systronix_M24C32_prog (void);
+
+		uint8_t		begin (Systronix_M24C32& eep, uint32_t addr, uint32_t len);	// len includes the CRC-32 trailer
+		uint8_t		feed (const uint8_t* data, size_t len);	// any piece size; no more than the image in total
+		uint8_t		finish (void);						// returns result.status
+
+		uint8_t		program (Systronix_M24C32& eep, uint32_t addr, const uint8_t* image, uint32_t len);	// whole image in RAM
+	};
+
+#endif	// M24C32_PROG_H_
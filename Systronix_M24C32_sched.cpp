@@ -0,0 +1,507 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_sched.h>
+
+
+//---------------------------< D E F A U L T   O S >----------------------------------------------------------
+//
+// target: one context and nothing to lock; a wait lets other cooperative code run.  host: std::mutex and
+// std::condition_variable.
+//
+
+#if defined (ARDUINO)
+static void os_nop (void* ctx) {(void)ctx;}
+static void os_yield (void* ctx) {(void)ctx; yield ();}
+#else
+static void os_lock (void* ctx) {((eep_sched_host*)ctx)->mutex.lock ();}
+static void os_unlock (void* ctx) {((eep_sched_host*)ctx)->mutex.unlock ();}
+static void os_notify (void* ctx) {((eep_sched_host*)ctx)->cond.notify_all ();}
+
+static void os_wait (void* ctx)
+	{
+	eep_sched_host*					host = (eep_sched_host*)ctx;
+	std::unique_lock<std::mutex>	lock (host->mutex, std::adopt_lock);	// already locked by the caller
+
+	host->cond.wait (lock);
+	lock.release ();									// and still locked for the caller
+	}
+#endif
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_sched::Systronix_M24C32_sched (void)
+	{
+	_bus = NULL;
+	_clients = 0;
+	_owner = EEP_SCHED_NONE;
+	_last = EEP_SCHED_NONE;
+	_tickets = 0;
+	_switches = 0;
+	memset (_client, 0, sizeof(_client));
+	memset (&stats, 0, sizeof(stats));
+
+#if defined (ARDUINO)
+	_os.ctx = NULL;
+	_os.lock = os_nop;
+	_os.unlock = os_nop;
+	_os.wait = os_yield;
+	_os.notify = os_nop;
+#else
+	_os.ctx = &_host;
+	_os.lock = os_lock;
+	_os.unlock = os_unlock;
+	_os.wait = os_wait;
+	_os.notify = os_notify;
+#endif
+	}
+
+
+//---------------------------< S E T U P >--------------------------------------------------------------------
+//
+// the transport that drives the bus (Systronix_M24C32_i2c_t3, the simulator, ...); only the client that holds
+// the grant calls it
+//
+
+uint8_t Systronix_M24C32_sched::setup (Systronix_M24C32_transport& bus)
+	{
+	_bus = &bus;
+	return SUCCESS;
+	}
+
+
+//---------------------------< O S _ S E T >------------------------------------------------------------------
+
+void Systronix_M24C32_sched::os_set (const eep_sched_os& os)
+	{
+	_os = os;
+	}
+
+
+//---------------------------< A T T A C H >------------------------------------------------------------------
+//
+// register a client at priority (higher goes first); returns its id or EEP_SCHED_NONE
+//
+
+uint8_t Systronix_M24C32_sched::attach (uint8_t priority)
+	{
+	uint8_t	id = EEP_SCHED_NONE;
+
+	_os.lock (_os.ctx);
+	if (EEP_SCHED_CLIENTS_MAX > _clients)
+		{
+		id = _clients++;
+		_client[id].priority = priority;
+		_client[id].waiting = false;
+		}
+	_os.unlock (_os.ctx);
+	return id;
+	}
+
+
+//---------------------------< N E X T >----------------------------------------------------------------------
+//
+// the waiting client with the highest priority; of those, the one with the oldest ticket.  Called locked.
+//
+
+uint8_t Systronix_M24C32_sched::next (void)
+	{
+	uint8_t	pick = EEP_SCHED_NONE;
+
+	for (uint8_t i=0; i<_clients; i++)
+		{
+		if (!_client[i].waiting)
+			continue;
+		if ((EEP_SCHED_NONE == pick) || (_client[i].priority > _client[pick].priority) ||
+			((_client[i].priority == _client[pick].priority) && ((int32_t)(_client[i].ticket - _client[pick].ticket) < 0)))
+			pick = i;
+		}
+	return pick;
+	}
+
+
+//---------------------------< A C Q U I R E >----------------------------------------------------------------
+//
+// wait in line for the bus; returns with id holding it
+//
+
+void Systronix_M24C32_sched::acquire (uint8_t id)
+	{
+	boolean	waited = false;
+
+	_os.lock (_os.ctx);
+	_client[id].waiting = true;
+	_client[id].ticket = _tickets++;
+	while ((EEP_SCHED_NONE != _owner) || (id != next ()))
+		{
+		waited = true;
+		_os.wait (_os.ctx);
+		}
+
+	_client[id].waiting = false;
+	_owner = id;
+	if (id != _last)
+		_switches++;
+	_last = id;
+	stats.grants++;
+	if (waited)
+		stats.contended++;
+	_os.unlock (_os.ctx);
+	}
+
+
+//---------------------------< R E L E A S E >----------------------------------------------------------------
+
+void Systronix_M24C32_sched::release (uint8_t id)
+	{
+	_os.lock (_os.ctx);
+	if (id == _owner)
+		{
+		_owner = EEP_SCHED_NONE;
+		_os.notify (_os.ctx);							// the waiters sort out among themselves who is next
+		}
+	_os.unlock (_os.ctx);
+	}
+
+
+//---------------------------< W A I T I N G _ A B O V E >----------------------------------------------------
+
+boolean Systronix_M24C32_sched::waiting_above (uint8_t priority)
+	{
+	boolean	ret_val = false;
+
+	_os.lock (_os.ctx);
+	for (uint8_t i=0; i<_clients; i++)
+		if (_client[i].waiting && (_client[i].priority > priority))
+			ret_val = true;
+	_os.unlock (_os.ctx);
+	return ret_val;
+	}
+
+
+//---------------------------< S W I T C H E S >--------------------------------------------------------------
+//
+// grants that went to a different client than the one before; a client that reads the same value before and
+// after a gap knows that nobody else used the bus in between
+//
+
+uint32_t Systronix_M24C32_sched::switches (void)
+	{
+	uint32_t	ret_val;
+
+	_os.lock (_os.ctx);
+	ret_val = _switches;
+	_os.unlock (_os.ctx);
+	return ret_val;
+	}
+
+
+//---------------------------< S P L I T >--------------------------------------------------------------------
+
+void Systronix_M24C32_sched::split (void)
+	{
+	_os.lock (_os.ctx);
+	stats.splits++;
+	_os.unlock (_os.ctx);
+	}
+
+
+//---------------------------< C L I E N T   C O N S R U C T O R >--------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_sched_client::Systronix_M24C32_sched_client (void)
+	{
+	_sched = NULL;
+	_bus = NULL;
+	_id = EEP_SCHED_NONE;
+	_priority = EEP_PRIO_NORMAL;
+	_split = false;
+	_owner = false;
+	_open = false;
+	_async = false;
+	_async_stop = I2C_STOP;
+	_rx_pending = false;
+	_holds = 0;
+	_tx_len = 0;
+	_tx_overflow = false;
+	_rx_len = 0;
+	_rx_pos = 0;
+	_rx_want = 0;
+	_status = I2C_WAITING;
+	}
+
+
+//---------------------------< S E T U P >--------------------------------------------------------------------
+//
+// join sched (already set up) at priority; FAIL when it has no room for another client
+//
+
+uint8_t Systronix_M24C32_sched_client::setup (Systronix_M24C32_sched& sched, uint8_t priority)
+	{
+	_id = sched.attach (priority);
+	if (EEP_SCHED_NONE == _id)
+		return FAIL;
+
+	_sched = &sched;
+	_bus = sched.bus ();
+	_priority = priority;
+	return SUCCESS;
+	}
+
+
+//---------------------------< G R A B >----------------------------------------------------------------------
+//
+//
+//
+
+void Systronix_M24C32_sched_client::grab (void)
+	{
+	if (_owner)
+		return;
+	_sched->acquire (_id);
+	_owner = true;
+	}
+
+
+//---------------------------< D R O P >----------------------------------------------------------------------
+//
+// give up the grant after a STOP unless hold() keeps it
+//
+
+void Systronix_M24C32_sched_client::drop (void)
+	{
+	if (!_owner || _open || _async || _holds)
+		return;
+	_owner = false;
+	_sched->release (_id);
+	}
+
+
+//---------------------------< H O L D >----------------------------------------------------------------------
+//
+// take the bus now and keep it until the matching release()
+//
+
+void Systronix_M24C32_sched_client::hold (void)
+	{
+	grab ();
+	_holds++;
+	}
+
+void Systronix_M24C32_sched_client::release (void)
+	{
+	if (_holds)
+		_holds--;
+	drop ();
+	}
+
+
+//---------------------------< B E G I N >--------------------------------------------------------------------
+
+void Systronix_M24C32_sched_client::begin (void)
+	{
+	grab ();
+	_bus->begin ();
+	drop ();
+	}
+
+void Systronix_M24C32_sched_client::begin (i2c_pins pins, i2c_rate rate)
+	{
+	grab ();
+	_bus->begin (pins, rate);
+	drop ();
+	}
+
+
+//---------------------------< B E G I N T R A N S M I S S I O N >--------------------------------------------
+//
+// the transaction is built here and handed to the bus when it is sent
+//
+
+void Systronix_M24C32_sched_client::beginTransmission (uint8_t address)
+	{
+	_tx_addr = address;
+	_tx_len = 0;
+	_tx_overflow = false;
+	}
+
+
+//---------------------------< W R I T E >--------------------------------------------------------------------
+
+size_t Systronix_M24C32_sched_client::write (uint8_t data)
+	{
+	if (I2C_TX_BUFFER_LENGTH <= _tx_len)
+		{
+		_tx_overflow = true;
+		return 0;
+		}
+	_tx_buf[_tx_len++] = data;
+	return 1;
+	}
+
+size_t Systronix_M24C32_sched_client::write (const uint8_t* data, size_t quantity)
+	{
+	for (size_t i=0; i<quantity; i++)
+		if (0 == write (data[i]))
+			return i;
+	return quantity;
+	}
+
+
+//---------------------------< E N D T R A N S M I S S I O N >------------------------------------------------
+//
+// wait for the grant, then send; I2C_NOSTOP keeps the grant for the repeated start
+//
+
+uint8_t Systronix_M24C32_sched_client::endTransmission (i2c_stop sendStop)
+	{
+	uint8_t	ret_val;
+
+	if (_tx_overflow)
+		{
+		_status = I2C_BUF_OVF;
+		return 1;
+		}
+
+	grab ();
+	_bus->beginTransmission (_tx_addr);
+	_bus->write (_tx_buf, _tx_len);
+	ret_val = _bus->endTransmission (sendStop);
+	_status = _bus->status ();
+	_open = (SUCCESS == ret_val) && (I2C_NOSTOP == sendStop);
+	drop ();
+	return ret_val;
+	}
+
+
+//---------------------------< S E N D T R A N S M I S S I O N >----------------------------------------------
+
+void Systronix_M24C32_sched_client::sendTransmission (i2c_stop sendStop)
+	{
+	if (_tx_overflow)
+		{
+		_status = I2C_BUF_OVF;
+		return;
+		}
+
+	grab ();
+	_bus->beginTransmission (_tx_addr);
+	_bus->write (_tx_buf, _tx_len);
+	_bus->sendTransmission (sendStop);
+	_async = true;
+	_async_stop = sendStop;
+	_rx_pending = false;
+	_status = I2C_SENDING;
+	}
+
+
+//---------------------------< S P L I T S T O P >------------------------------------------------------------
+//
+// I2C_STOP in place of I2C_NOSTOP when split_reads() is on, the bus is not held, and a higher priority client
+// is waiting
+//
+
+i2c_stop Systronix_M24C32_sched_client::split_stop (i2c_stop sendStop)
+	{
+	if ((I2C_NOSTOP != sendStop) || !_split || _holds || !_sched->waiting_above (_priority))
+		return sendStop;
+	_sched->split ();
+	return I2C_STOP;
+	}
+
+
+//---------------------------< R E Q U E S T F R O M >--------------------------------------------------------
+//
+// wait for the grant (unless a held write precedes this), read, and copy the bytes out of the bus's rx buffer
+//
+
+size_t Systronix_M24C32_sched_client::requestFrom (uint8_t address, size_t len, i2c_stop sendStop)
+	{
+	size_t	received;
+
+	grab ();
+	sendStop = split_stop (sendStop);
+	received = _bus->requestFrom (address, len, sendStop);
+	_status = _bus->status ();
+	rx_copy (received);
+	_open = received && (I2C_NOSTOP == sendStop);
+	drop ();
+	return received;
+	}
+
+
+//---------------------------< S E N D R E Q U E S T >--------------------------------------------------------
+
+void Systronix_M24C32_sched_client::sendRequest (uint8_t address, size_t len, i2c_stop sendStop)
+	{
+	grab ();
+	sendStop = split_stop (sendStop);
+	_bus->sendRequest (address, len, sendStop);
+	_async = true;
+	_async_stop = sendStop;
+	_rx_pending = true;
+	_rx_want = len;
+	_rx_len = 0;
+	_rx_pos = 0;
+	_status = I2C_SENDING;
+	}
+
+
+//---------------------------< D O N E >----------------------------------------------------------------------
+//
+// 1 when the last non-blocking operation has finished; the grant ends here when that operation ended with STOP
+//
+
+uint8_t Systronix_M24C32_sched_client::done (void)
+	{
+	if (!_async)
+		return 1;
+	if (!_bus->done ())
+		return 0;
+
+	_status = _bus->status ();
+	if (_rx_pending)
+		rx_copy ((I2C_WAITING == _status) ? _rx_want : 0);
+	_async = false;
+	_rx_pending = false;
+	_open = (I2C_WAITING == _status) && (I2C_NOSTOP == _async_stop);
+	drop ();
+	return 1;
+	}
+
+
+//---------------------------< R X _ C O P Y >----------------------------------------------------------------
+
+void Systronix_M24C32_sched_client::rx_copy (size_t len)
+	{
+	if (I2C_RX_BUFFER_LENGTH < len)
+		len = I2C_RX_BUFFER_LENGTH;
+	_rx_len = _bus->read (_rx_buf, len);
+	_rx_pos = 0;
+	}
+
+
+//---------------------------< R E A D B Y T E >--------------------------------------------------------------
+
+uint8_t Systronix_M24C32_sched_client::readByte (void)
+	{
+	return (_rx_pos < _rx_len) ? _rx_buf[_rx_pos++] : 0;
+	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+
+size_t Systronix_M24C32_sched_client::read (uint8_t* data, size_t count)
+	{
+	if (count > (_rx_len - _rx_pos))
+		count = _rx_len - _rx_pos;
+	memcpy (data, &_rx_buf[_rx_pos], count);
+	_rx_pos += count;
+	return count;
+	}
@@ -0,0 +1,209 @@
+#ifndef M24C32_SCHED_H_
+#define	M24C32_SCHED_H_
+
+//
+// Systronix_M24C32_sched.h
+//
+// Arbitration for one I2C bus shared by several drivers running in different execution contexts (RTOS tasks,
+// host threads).  Each context gets its own Systronix_M24C32_sched_client, a transport that drivers are set up
+// on exactly as on the bus itself; the client queues its transactions on the scheduler, which grants the bus to
+// one client at a time.
+//
+// A grant lasts for one bus transaction: START to STOP.  A write that ends with I2C_NOSTOP keeps the grant for
+// the repeated start that follows, so a random read (address write, repeated start, read) is never split.
+// hold() keeps the grant across STOPs as well, until the matching release(): a multi-phase sequence such as a
+// mux select followed by the eeprom access behind it.  hold() takes the bus before it returns.
+//
+// When the bus comes free it goes to the waiting client with the highest priority, and among clients of equal
+// priority to the one that has waited longest.  A transaction in progress is never interrupted, so a sensor
+// read at high priority waits for at most one transaction of a lower priority client.  A long sequential read
+// is one transaction (Systronix_M24C32::read() of 4 KB is about 90 ms at 400 kHz); with split_reads (true) a
+// client ends a read chunk that was to continue with a repeated start with STOP instead whenever a higher
+// priority client is waiting, and starts the next chunk in a transaction of its own.  The eeprom's address
+// pointer carries the read on across the STOP, so this is safe for eeprom reads (the continuation is a current
+// address read) as long as nothing else addresses that eeprom in between; it is never done while the client
+// holds the bus.
+//
+// Rules:
+//		every context uses its own client; a client is not itself thread safe
+//		every device is driven through one client only (an eeprom's address pointer is part of its state)
+//		a Systronix_M24C32_mux map and the eeproms in it share one client; other clients may write the mux
+//		control registers (the map sees the epoch() change and rewrites them) but must not leave a port open
+//		that would make two devices collide
+//
+// The non-blocking calls (sendTransmission(), sendRequest()) wait for the grant before they start; the grant
+// ends when done() reports the STOP.  A client that starts one must poll done() to the end.
+//
+// Locking and blocking belong to the platform and are supplied as an eep_sched_os.  On the host the default
+// is std::mutex and std::condition_variable.  On target the default suits a sketch without an RTOS (one
+// context; a wait calls yield()); an RTOS supplies its own mutex and semaphore through os_set().
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32_transport.h>
+#if !defined (ARDUINO)
+#include <mutex>
+#include <condition_variable>
+#endif
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_SCHED_CLIENTS_MAX	8					// clients per bus
+#define		EEP_SCHED_NONE			0xFF				// no client; attach() failed or bus free
+
+#define		EEP_PRIO_BULK			0					// eeprom dumps, image programming
+#define		EEP_PRIO_NORMAL			1
+#define		EEP_PRIO_SENSOR			2					// latency-critical sensor reads
+
+
+//---------------------------< E E P _ S C H E D _ O S >------------------------------------------------------
+//
+// platform hooks; ctx is passed to each.  wait() is called with the lock taken: it gives up the lock, blocks
+// until a notify() (or spuriously), and takes the lock again before it returns.  notify() wakes every waiter and
+// is called with the lock taken.
+//
+
+struct eep_sched_os
+	{
+	void*	ctx;
+	void	(*lock) (void* ctx);
+	void	(*unlock) (void* ctx);
+	void	(*wait) (void* ctx);
+	void	(*notify) (void* ctx);
+	};
+
+
+#if !defined (ARDUINO)
+struct eep_sched_host									// ctx of the default host eep_sched_os
+	{
+	std::mutex				mutex;
+	std::condition_variable	cond;
+	};
+#endif
+
+
+//---------------------------< S C H E D U L E R >------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_sched
+	{
+	protected:
+		Systronix_M24C32_transport*	_bus;
+
+		struct
+			{
+			uint8_t		priority;
+			boolean		waiting;
+			uint32_t	ticket;							// arrival order of the current wait
+			} _client[EEP_SCHED_CLIENTS_MAX];
+		uint8_t		_clients;
+
+		uint8_t		_owner;								// client holding the bus or EEP_SCHED_NONE
+		uint8_t		_last;								// client that held it most recently
+		uint32_t	_tickets;
+		uint32_t	_switches;							// grants to a client other than _last
+
+		eep_sched_os	_os;
+#if !defined (ARDUINO)
+		eep_sched_host	_host;
+#endif
+
+		uint8_t		next (void);						// the waiting client to grant next
+
+	public:
+		struct
+			{
+			uint32_t	grants;
+			uint32_t	contended;						// grants that had to wait for another client
+			uint32_t	splits;							// read chunks ended early for a higher priority client
+			} stats;
+
+		Systronix_M24C32_sched (void);
+
+		uint8_t		setup (Systronix_M24C32_transport& bus);	// the bus itself; call before attach()
+		void		os_set (const eep_sched_os& os);	// before any client uses the bus
+
+		uint8_t		attach (uint8_t priority);			// client id or EEP_SCHED_NONE; use Systronix_M24C32_sched_client
+		Systronix_M24C32_transport*	bus (void) {return _bus;}
+
+		void		acquire (uint8_t id);				// block until id holds the bus
+		void		release (uint8_t id);
+		boolean		waiting_above (uint8_t priority);	// a client of higher priority is waiting
+		uint32_t	switches (void);
+		void		split (void);						// count a split read chunk
+	};
+
+
+//---------------------------< C L I E N T >------------------------------------------------------------------
+//
+// one execution context's view of the shared bus
+//
+
+class Systronix_M24C32_sched_client : public Systronix_M24C32_transport
+	{
+	protected:
+		Systronix_M24C32_sched*		_sched;
+		Systronix_M24C32_transport*	_bus;
+		uint8_t		_id;
+		uint8_t		_priority;
+		boolean		_split;								// split_reads()
+
+		boolean		_owner;								// this client holds the grant
+		boolean		_open;								// a transaction is in progress (I2C_NOSTOP, or non-blocking)
+		boolean		_async;								// sendTransmission() or sendRequest() not yet done()
+		i2c_stop	_async_stop;						// and how it ends
+		boolean		_rx_pending;						// it is a sendRequest(); copy rx when done
+		uint8_t		_holds;
+
+		uint8_t		_tx_addr;
+		uint8_t		_tx_buf[I2C_TX_BUFFER_LENGTH];
+		size_t		_tx_len;
+		boolean		_tx_overflow;
+
+		uint8_t		_rx_buf[I2C_RX_BUFFER_LENGTH];		// copied from the bus so it survives the grant
+		size_t		_rx_len;
+		size_t		_rx_pos;
+		size_t		_rx_want;
+		uint8_t		_status;
+
+		void		grab (void);						// acquire unless already the owner
+		void		drop (void);						// release unless held or mid-transaction
+		i2c_stop	split_stop (i2c_stop sendStop);		// I2C_STOP where split_reads() allows it
+		void		rx_copy (size_t len);
+
+	public:
+		Systronix_M24C32_sched_client (void);
+
+		uint8_t		setup (Systronix_M24C32_sched& sched, uint8_t priority = EEP_PRIO_NORMAL);	// SUCCESS or FAIL (too many clients)
+		void		split_reads (boolean on) {_split = on;}
+
+		void		begin (void);
+		void		begin (i2c_pins pins, i2c_rate rate);
+
+		void		beginTransmission (uint8_t address);
+		size_t		write (uint8_t data);
+		size_t		write (const uint8_t* data, size_t quantity);
+		uint8_t		endTransmission (i2c_stop sendStop = I2C_STOP);
+		void		sendTransmission (i2c_stop sendStop = I2C_STOP);
+
+		size_t		requestFrom (uint8_t address, size_t len, i2c_stop sendStop);
+		void		sendRequest (uint8_t address, size_t len, i2c_stop sendStop);
+		uint8_t		readByte (void);
+		size_t		read (uint8_t* data, size_t count);
+
+		uint8_t		done (void);
+		uint8_t		status (void) {return _status;}
+
+		uint32_t	millis (void) {return _bus->millis ();}
+		uint32_t	micros (void) {return _bus->micros ();}
+
+		void		hold (void);
+		void		release (void);
+		uint32_t	epoch (void) {return _sched->switches ();}
+	};
+
+#endif	// M24C32_SCHED_H_
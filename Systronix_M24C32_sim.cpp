@@ -0,0 +1,791 @@
+#if !defined (ARDUINO)
+
+#include <Systronix_M24C32_sim.h>
+
+
+//---------------------------< S I M   D E V I C E   C O N S T R U C T O R >----------------------------------
+//
+// an erased (all 0xFF) eep of the given geometry at addr
+//
+
+Systronix_M24C32_sim_device::Systronix_M24C32_sim_device (uint8_t addr, const struct eep_part& part)
+	{
+	address = addr;
+	_part = part;
+	mem = new uint8_t[part.size];
+	page_wear = new uint32_t[part.size / part.page_size];
+	tw_us = (uint32_t)part.tw_ms * 1000;
+	_busy_until = 0;
+	_block = 0;
+	_cut_armed = false;
+	_dead = false;
+	erase ();
+	}
+
+
+//---------------------------< S I M   D E V I C E   C O P Y   C O N S T R U C T O R >------------------------
+//
+// a second device with its own copy of the array; lets arrays of devices be brace-initialized
+//
+
+Systronix_M24C32_sim_device::Systronix_M24C32_sim_device (const Systronix_M24C32_sim_device& other)
+	{
+	address = other.address;
+	_part = other._part;
+	mem = new uint8_t[_part.size];
+	page_wear = new uint32_t[pages ()];
+	memcpy (mem, other.mem, _part.size);
+	memcpy (page_wear, other.page_wear, pages () * sizeof(uint32_t));
+	tw_us = other.tw_us;
+	write_cycles = other.write_cycles;
+	_busy_until = other._busy_until;
+	_cut_armed = other._cut_armed;
+	_cut_cycles = other._cut_cycles;
+	_cut_torn = other._cut_torn;
+	_dead = other._dead;
+	_block = 0;
+	_ptr = other._ptr;
+	_addr_bytes = 0;
+	_latch_count = 0;
+	}
+
+
+//---------------------------< S I M   D E V I C E   D E S T R U C T O R >------------------------------------
+//
+//
+//
+
+Systronix_M24C32_sim_device::~Systronix_M24C32_sim_device (void)
+	{
+	delete[] mem;
+	delete[] page_wear;
+	}
+
+
+//---------------------------< E R A S E >--------------------------------------------------------------------
+//
+// fill the array with value, reset the address pointer, and clear the wear counters
+//
+
+void Systronix_M24C32_sim_device::erase (uint8_t value)
+	{
+	memset (mem, value, _part.size);
+	memset (page_wear, 0, pages () * sizeof(uint32_t));
+	write_cycles = 0;
+	_ptr = 0;
+	_addr_bytes = 0;
+	_latch_count = 0;
+	}
+
+
+//---------------------------< P O W E R _ C U T >------------------------------------------------------------
+//
+// Let cycles more write cycles complete, then fail the power during the one after that: the first torn bytes
+// of its page latch (in page order) reach the array, the rest of the bytes it would have written are left
+// erased (0xFF), and the device no longer acks anything until power_on().  Bytes outside the latched ones keep
+// their values.
+//
+
+void Systronix_M24C32_sim_device::power_cut (uint32_t cycles, uint16_t torn)
+	{
+	_cut_armed = true;
+	_cut_cycles = cycles;
+	_cut_torn = torn;
+	}
+
+
+//---------------------------< P O W E R _ O N >--------------------------------------------------------------
+//
+// power restored: idle, pointer at 0, no write cycle running; the array is as the cut left it
+//
+
+void Systronix_M24C32_sim_device::power_on (void)
+	{
+	_cut_armed = false;
+	_dead = false;
+	_busy_until = 0;
+	_ptr = 0;
+	_addr_bytes = 0;
+	_latch_count = 0;
+	}
+
+
+//---------------------------< R O U T E >--------------------------------------------------------------------
+//
+// A part with block bits ignores the low block_bits bits of the slave address when matching and uses them as
+// the high memory address bits; remember which block was addressed.
+//
+
+Systronix_M24C32_sim_slave* Systronix_M24C32_sim_device::route (uint8_t addr)
+	{
+	uint8_t	mask = (1 << _part.block_bits) - 1;
+
+	if ((addr & ~mask) != address)
+		return NULL;
+
+	_block = addr & mask;
+	return this;
+	}
+
+
+//---------------------------< S E L E C T >------------------------------------------------------------------
+//
+// address phase.  The eep does not respond to its slave address while a write cycle is in progress.  A new
+// START (or repeated START) before STOP abandons whatever is in the page latch.
+//
+
+boolean Systronix_M24C32_sim_device::select (boolean read, uint64_t now)
+	{
+	if (_dead || busy (now))
+		return false;										// nack; tW still running
+
+	_addr_bytes = read ? _part.addr_bytes : 0;				// a read uses the pointer as it stands
+	_latch_count = 0;
+	memset (_latched, 0, sizeof(_latched));
+	return true;
+	}
+
+
+//---------------------------< R E C E I V E >----------------------------------------------------------------
+//
+// The first one or two bytes of a write are the memory address (high then low); the block bits of the slave
+// address supply any address bits above them.  The remainder go into the page latch.  The low address bits
+// roll over within the page so bytes written past the end of a page overwrite the beginning of the same page.
+//
+
+boolean Systronix_M24C32_sim_device::receive (uint8_t data, uint64_t now)
+	{
+	uint32_t	page_mask = _part.page_size - 1;
+
+	(void)now;
+
+	if (_addr_bytes < _part.addr_bytes)
+		{
+		if (0 == _addr_bytes)
+			_ptr = (uint32_t)_block << (8 * _part.addr_bytes);	// address bits above the address bytes
+		_ptr |= (uint32_t)data << (8 * (_part.addr_bytes - 1 - _addr_bytes));	// high address byte first
+		_ptr &= _part.size - 1;								// bits above the array are don't care
+		_addr_bytes++;
+		return true;
+		}
+
+	_latch[_ptr & page_mask] = data;
+	_latched[_ptr & page_mask] = true;
+	_latch_count++;
+	_ptr = (_ptr & ~page_mask) | ((_ptr + 1) & page_mask);	// page rollover
+	return true;
+	}
+
+
+//---------------------------< T R A N S M I T >--------------------------------------------------------------
+//
+// sequential read; the pointer rolls over from the top of the array to 0x0000
+//
+
+uint8_t Systronix_M24C32_sim_device::transmit (uint64_t now)
+	{
+	uint8_t	data = mem[_ptr];
+
+	(void)now;
+	_ptr = (_ptr + 1) & (_part.size - 1);
+	return data;
+	}
+
+
+//---------------------------< S T O P >----------------------------------------------------------------------
+//
+// STOP after one or more data bytes starts the write cycle: the latch is programmed into the array and the
+// device goes busy for tw_us.  A cycle that power_cut() tears is only partly programmed.
+//
+
+void Systronix_M24C32_sim_device::stop (uint64_t now)
+	{
+	uint32_t	page = _ptr & ~(uint32_t)(_part.page_size - 1);
+	uint16_t	done = 0;
+
+	if (0 == _latch_count)
+		return;												// address-only write or a read; no write cycle
+
+	if (_cut_armed && (0 == _cut_cycles))
+		{
+		for (uint16_t i=0; i<_part.page_size; i++)
+			if (_latched[i])
+				mem[page + i] = (done++ < _cut_torn) ? _latch[i] : 0xFF;
+		_latch_count = 0;
+		_cut_armed = false;
+		_dead = true;
+		return;
+		}
+	if (_cut_armed)
+		_cut_cycles--;
+
+	for (uint16_t i=0; i<_part.page_size; i++)
+		if (_latched[i])
+			mem[page + i] = _latch[i];
+
+	_latch_count = 0;
+	write_cycles++;
+	page_wear[page / _part.page_size]++;
+	_busy_until = now + (uint64_t)tw_us * 1000;
+	}
+
+
+//---------------------------< S I M   F R A M   C O N S T R U C T O R >--------------------------------------
+//
+// an all-zero FRAM of size bytes at addr
+//
+
+Systronix_M24C32_sim_fram::Systronix_M24C32_sim_fram (uint8_t addr, uint32_t size)
+	{
+	address = addr;
+	_size = size;
+	mem = new uint8_t[size];
+	erase ();
+	}
+
+
+//---------------------------< S I M   F R A M   D E S T R U C T O R >----------------------------------------
+//
+//
+//
+
+Systronix_M24C32_sim_fram::~Systronix_M24C32_sim_fram (void)
+	{
+	delete[] mem;
+	}
+
+
+//---------------------------< E R A S E >--------------------------------------------------------------------
+//
+//
+//
+
+void Systronix_M24C32_sim_fram::erase (uint8_t value)
+	{
+	memset (mem, value, _size);
+	bytes_written = 0;
+	_ptr = 0;
+	_addr_bytes = 0;
+	}
+
+
+//---------------------------< S E L E C T >------------------------------------------------------------------
+//
+// FRAM is never busy
+//
+
+boolean Systronix_M24C32_sim_fram::select (boolean read, uint64_t now)
+	{
+	(void)now;
+	_addr_bytes = read ? 2 : 0;								// a read uses the pointer as it stands
+	return true;
+	}
+
+
+//---------------------------< R E C E I V E >----------------------------------------------------------------
+//
+// two address bytes (high then low) and then data straight into the array
+//
+
+boolean Systronix_M24C32_sim_fram::receive (uint8_t data, uint64_t now)
+	{
+	(void)now;
+
+	if (2 > _addr_bytes)
+		{
+		if (0 == _addr_bytes)
+			_ptr = 0;
+		_ptr = ((_ptr << 8) | data) & (_size - 1);			// bits above the array are don't care
+		_addr_bytes++;
+		return true;
+		}
+
+	mem[_ptr] = data;
+	bytes_written++;
+	_ptr = (_ptr + 1) & (_size - 1);
+	return true;
+	}
+
+
+//---------------------------< T R A N S M I T >--------------------------------------------------------------
+//
+// sequential read; the pointer rolls over from the top of the array to 0x0000
+//
+
+uint8_t Systronix_M24C32_sim_fram::transmit (uint64_t now)
+	{
+	uint8_t	data = mem[_ptr];
+
+	(void)now;
+	_ptr = (_ptr + 1) & (_size - 1);
+	return data;
+	}
+
+
+//---------------------------< S I M   M U X   C O N S T R U C T O R >----------------------------------------
+//
+//
+//
+
+Systronix_M24C32_sim_mux::Systronix_M24C32_sim_mux (uint8_t addr)
+	{
+	address = addr;
+	control = 0;
+	control_writes = 0;
+	collisions = 0;
+	memset (_count, 0, sizeof(_count));
+	}
+
+
+//---------------------------< A T T A C H   ( M U X ) >------------------------------------------------------
+//
+// put a simulated slave on one of the mux's downstream ports
+//
+
+boolean Systronix_M24C32_sim_mux::attach (uint8_t port, Systronix_M24C32_sim_slave& slave)
+	{
+	if ((SIM_MUX_PORTS <= port) || (SIM_MUX_SLAVES_MAX <= _count[port]))
+		return false;
+
+	_port[port][_count[port]++] = &slave;
+	return true;
+	}
+
+
+//---------------------------< D E T A C H   ( M U X ) >------------------------------------------------------
+//
+// unplug a simulated slave from a downstream port
+//
+
+boolean Systronix_M24C32_sim_mux::detach (uint8_t port, Systronix_M24C32_sim_slave& slave)
+	{
+	if (SIM_MUX_PORTS <= port)
+		return false;
+
+	for (uint8_t i=0; i<_count[port]; i++)
+		if (&slave == _port[port][i])
+			{
+			_port[port][i] = _port[port][--_count[port]];
+			return true;
+			}
+	return false;
+	}
+
+
+//---------------------------< R O U T E   ( M U X ) >--------------------------------------------------------
+//
+// the mux answers at its own address; any other address is passed down every enabled port
+//
+
+Systronix_M24C32_sim_slave* Systronix_M24C32_sim_mux::route (uint8_t addr)
+	{
+	Systronix_M24C32_sim_slave*	found = NULL;
+	Systronix_M24C32_sim_slave*	slave;
+
+	if (addr == address)
+		return this;
+
+	for (uint8_t p=0; p<SIM_MUX_PORTS; p++)
+		{
+		if (!(control & (1 << p)))
+			continue;
+		for (uint8_t i=0; i<_count[p]; i++)
+			{
+			slave = _port[p][i]->route (addr);
+			if (!slave)
+				continue;
+			if (found)
+				collisions++;								// two devices would drive the bus
+			else
+				found = slave;
+			}
+		}
+	return found;
+	}
+
+
+//---------------------------< S I M   B U S   C O N S T R U C T O R >----------------------------------------
+//
+//
+//
+
+Systronix_M24C32_sim::Systronix_M24C32_sim (uint32_t hz)
+	{
+	_slave_count = 0;
+	_now = 0;
+	_bus_t = 0;
+	_bus_free = 0;
+	_held = false;
+	_status = I2C_WAITING;
+	_tx_len = 0;
+	_tx_overflow = false;
+	_rx_len = 0;
+	_rx_index = 0;
+	clock_set (hz);
+	stats_clear ();
+	}
+
+
+//---------------------------< A T T A C H >------------------------------------------------------------------
+//
+// put a simulated slave on the bus
+//
+
+boolean Systronix_M24C32_sim::attach (Systronix_M24C32_sim_slave& slave)
+	{
+	if (SIM_SLAVES_MAX <= _slave_count)
+		return false;
+
+	_slaves[_slave_count++] = &slave;
+	return true;
+	}
+
+
+//---------------------------< C L O C K _ S E T >------------------------------------------------------------
+//
+//
+//
+
+void Systronix_M24C32_sim::clock_set (uint32_t hz)
+	{
+	_hz = hz;
+	_bit_ns = 1000000000UL / hz;
+	}
+
+
+//---------------------------< S T A T S _ C L E A R >--------------------------------------------------------
+//
+//
+//
+
+void Systronix_M24C32_sim::stats_clear (void)
+	{
+	memset (&stats, 0, sizeof(stats));
+	}
+
+
+//---------------------------< B E G I N >--------------------------------------------------------------------
+//
+// pins are meaningless here; rate sets the simulated bus clock
+//
+
+void Systronix_M24C32_sim::begin (i2c_pins pins, i2c_rate rate)
+	{
+	static const uint16_t khz[] = {100, 200, 300, 400, 600, 800, 1000, 1200, 1500, 1800, 2000, 2400, 2800, 3000};
+
+	(void)pins;
+	clock_set ((uint32_t)khz[rate] * 1000);
+	}
+
+
+//---------------------------< D E F A U L T   B E G I N >----------------------------------------------------
+//
+// i2c_t3 default is 100kHz
+//
+
+void Systronix_M24C32_sim::begin (void)
+	{
+	clock_set (100000);
+	}
+
+
+//---------------------------< F I N D >----------------------------------------------------------------------
+//
+// return the slave that answers to address or NULL
+//
+
+Systronix_M24C32_sim_slave* Systronix_M24C32_sim::find (uint8_t address)
+	{
+	Systronix_M24C32_sim_slave*	slave;
+
+	for (uint8_t i=0; i<_slave_count; i++)
+		{
+		slave = _slaves[i]->route (address);
+		if (slave)
+			return slave;
+		}
+	return NULL;
+	}
+
+
+//---------------------------< B I T S >----------------------------------------------------------------------
+//
+//
+//
+
+void Systronix_M24C32_sim::bits (uint32_t count)
+	{
+	_bus_t += (uint64_t)count * _bit_ns;
+	stats.busy_ns += (uint64_t)count * _bit_ns;
+	}
+
+
+//---------------------------< S T A R T >--------------------------------------------------------------------
+//
+// START or repeated START followed by the slave address byte and its ack slot.  A transaction cannot begin
+// before the previous one (possibly non-blocking) has finished.
+//
+
+void Systronix_M24C32_sim::start (void)
+	{
+	_bus_t = (_now > _bus_free) ? _now : _bus_free;
+	bits (1 + 9);
+	stats.transactions++;
+	stats.bytes++;
+	_held = false;
+	}
+
+
+//---------------------------< B E G I N T R A N S M I S S I O N >--------------------------------------------
+//
+//
+//
+
+void Systronix_M24C32_sim::beginTransmission (uint8_t address)
+	{
+	_tx_address = address;
+	_tx_len = 0;
+	_tx_overflow = false;
+	_status = I2C_WAITING;
+	}
+
+
+//---------------------------< W R I T E >--------------------------------------------------------------------
+//
+// like i2c_t3, returns the number of bytes added to the tx buffer; 0 when the buffer would overflow
+//
+
+size_t Systronix_M24C32_sim::write (uint8_t data)
+	{
+	return write (&data, 1);
+	}
+
+size_t Systronix_M24C32_sim::write (const uint8_t* data, size_t quantity)
+	{
+	if ((_tx_len + quantity) > (I2C_TX_BUFFER_LENGTH - 1))	// one byte of the i2c_t3 buffer is the slave address
+		{
+		_tx_overflow = true;
+		_status = I2C_BUF_OVF;
+		return 0;
+		}
+
+	memcpy (&_tx_buf[_tx_len], data, quantity);
+	_tx_len += quantity;
+	return quantity;
+	}
+
+
+//---------------------------< T R A N S M I T _ O P >--------------------------------------------------------
+//
+// run the write transaction in the tx buffer on the bus; bus time advances but cpu time (_now) does not.
+// returns the i2c_t3 endTransmission() values: 0=success, 1=data too long, 2=recv addr NACK, 3=recv data NACK
+//
+
+uint8_t Systronix_M24C32_sim::transmit_op (i2c_stop sendStop)
+	{
+	Systronix_M24C32_sim_slave*	slave;
+
+	if (_tx_overflow)
+		return 1;
+
+	start ();
+	slave = find (_tx_address);
+	if (!slave || !slave->select (false, _bus_t))
+		{
+		bits (1);											// master sends STOP after a nack
+		stats.addr_nacks++;
+		_status = I2C_ADDR_NAK;
+		_bus_free = _bus_t;
+		return 2;
+		}
+
+	for (size_t i=0; i<_tx_len; i++)
+		{
+		bits (9);
+		stats.bytes++;
+		if (!slave->receive (_tx_buf[i], _bus_t))
+			{
+			bits (1);
+			slave->stop (_bus_t);
+			stats.data_nacks++;
+			_status = I2C_DATA_NAK;
+			_bus_free = _bus_t;
+			return 3;
+			}
+		}
+
+	if (I2C_STOP == sendStop)
+		{
+		bits (1);
+		slave->stop (_bus_t);
+		}
+	else
+		_held = true;
+
+	_status = I2C_WAITING;
+	_bus_free = _bus_t;
+	return SUCCESS;
+	}
+
+
+//---------------------------< R E Q U E S T _ O P >----------------------------------------------------------
+//
+// run a master read of len bytes into the rx buffer; bus time advances but cpu time (_now) does not.  Returns
+// the number of bytes received.
+//
+
+size_t Systronix_M24C32_sim::request_op (uint8_t address, size_t len, i2c_stop sendStop)
+	{
+	Systronix_M24C32_sim_slave*	slave;
+
+	_rx_len = 0;
+	_rx_index = 0;
+
+	if (I2C_RX_BUFFER_LENGTH < len)
+		{
+		_status = I2C_BUF_OVF;
+		return 0;
+		}
+
+	start ();
+	slave = find (address);
+	if (!slave || !slave->select (true, _bus_t))
+		{
+		bits (1);
+		stats.addr_nacks++;
+		_status = I2C_ADDR_NAK;
+		_bus_free = _bus_t;
+		return 0;
+		}
+
+	for (size_t i=0; i<len; i++)
+		{
+		bits (9);
+		stats.bytes++;
+		_rx_buf[i] = slave->transmit (_bus_t);
+		}
+	_rx_len = len;
+
+	if (I2C_STOP == sendStop)
+		{
+		bits (1);
+		slave->stop (_bus_t);
+		}
+	else
+		_held = true;
+
+	_status = I2C_WAITING;
+	_bus_free = _bus_t;
+	return len;
+	}
+
+
+//---------------------------< E N D T R A N S M I S S I O N >------------------------------------------------
+//
+// blocking; the caller's clock advances to the end of the transaction
+//
+
+uint8_t Systronix_M24C32_sim::endTransmission (i2c_stop sendStop)
+	{
+	uint8_t	ret_val = transmit_op (sendStop);
+
+	if (_now < _bus_free)
+		_now = _bus_free;
+	return ret_val;
+	}
+
+
+//---------------------------< S E N D T R A N S M I S S I O N >----------------------------------------------
+//
+// non-blocking; the transaction completes at a later simulated time; see done()
+//
+
+void Systronix_M24C32_sim::sendTransmission (i2c_stop sendStop)
+	{
+	transmit_op (sendStop);
+	}
+
+
+//---------------------------< R E Q U E S T F R O M >--------------------------------------------------------
+//
+// blocking master read; returns the number of bytes received
+//
+
+size_t Systronix_M24C32_sim::requestFrom (uint8_t address, size_t len, i2c_stop sendStop)
+	{
+	size_t	count = request_op (address, len, sendStop);
+
+	if (_now < _bus_free)
+		_now = _bus_free;
+	return count;
+	}
+
+
+//---------------------------< S E N D R E Q U E S T >--------------------------------------------------------
+//
+// non-blocking master read; when done() the rx buffer holds the bytes and status() tells how it went
+//
+
+void Systronix_M24C32_sim::sendRequest (uint8_t address, size_t len, i2c_stop sendStop)
+	{
+	request_op (address, len, sendStop);
+	}
+
+
+//---------------------------< D O N E >----------------------------------------------------------------------
+//
+// true when the most recent non-blocking transaction has finished.  Each call costs SIM_CALL_NS of cpu time so
+// that a caller spinning on done() sees simulated time pass.
+//
+
+uint8_t Systronix_M24C32_sim::done (void)
+	{
+	_now += SIM_CALL_NS;
+	return (_now >= _bus_free) ? 1 : 0;
+	}
+
+
+//---------------------------< S T A T U S >------------------------------------------------------------------
+//
+// i2c_t3 status(); I2C_SENDING while a non-blocking transaction is still on the bus
+//
+
+uint8_t Systronix_M24C32_sim::status (void)
+	{
+	if (_now < _bus_free)
+		return I2C_SENDING;
+	return _status;
+	}
+
+
+//---------------------------< R E A D B Y T E >--------------------------------------------------------------
+//
+//
+//
+
+uint8_t Systronix_M24C32_sim::readByte (void)
+	{
+	if (_rx_index >= _rx_len)
+		return 0;
+	return _rx_buf[_rx_index++];
+	}
+
+
+//---------------------------< R E A D >----------------------------------------------------------------------
+//
+// bulk copy from the rx buffer; returns the number of bytes copied
+//
+
+size_t Systronix_M24C32_sim::read (uint8_t* data, size_t count)
+	{
+	size_t	avail = _rx_len - _rx_index;
+
+	if (count > avail)
+		count = avail;
+
+	memcpy (data, &_rx_buf[_rx_index], count);
+	_rx_index += count;
+	return count;
+	}
+
+#endif	// !ARDUINO
@@ -0,0 +1,256 @@
+#ifndef M24C32_SIM_H_
+#define	M24C32_SIM_H_
+
+//
+// Systronix_M24C32_sim.h
+//
+// Host-side simulated I2C bus and simulated M24C32.  Systronix_M24C32_sim is a Systronix_M24C32_transport so
+// the unmodified driver runs against it.  Time is simulated: every START, STOP, and 9-bit byte slot advances
+// the bus clock by the bit time of the configured bus rate, so bytes-on-bus and wall time per operation can be
+// measured on a machine without the hardware.  Blocking calls advance the caller's (cpu) clock to the end of
+// the transaction; non-blocking calls (sendTransmission(), sendRequest()) do not, and done() reports when the
+// bus has caught up.  advance() models cpu work between bus calls.
+//
+// The simulated eep is any member of the M24Cxx family (an eep_part; the M24C32 by default) and models:
+//		the array (4 KB on the M24C32)
+//		the internal address pointer; sequential reads roll over from the top of the array to 0x0000
+//		the page latch (32 bytes on the M24C32); writes that run past the end of a page wrap to the start of
+//		the same page
+//		one or two memory address bytes, and block bits: a part with block bits answers at 2, 4, or 8 slave
+//		addresses and takes the high memory address bits from the low bits of the slave address
+//		the tW write cycle; the device does not ack its slave address until tW has elapsed
+//		power loss (power_cut()): after a given number of further write cycles the next one is torn and the
+//		device stops answering until power_on()
+//
+// Systronix_M24C32_sim_fram is a simulated MB85RC FRAM for the FRAM backend (Systronix_M24C32_fram).
+//
+// Other simulated slaves can be attached to the same bus by deriving from Systronix_M24C32_sim_slave.
+//
+
+#if !defined (ARDUINO)
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32_transport.h>
+#include <Systronix_M24C32_parts.h>
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		SIM_SLAVES_MAX		16						// number of slaves that may be attached to one simulated bus
+#define		SIM_CALL_NS			1000					// cpu time charged to each done() call
+
+
+//---------------------------< S I M   S L A V E >------------------------------------------------------------
+//
+// Interface to anything that can sit on the simulated bus.  now is simulated time in nanoseconds.
+//
+
+class Systronix_M24C32_sim_slave
+	{
+	public:
+		uint8_t		address;								// 7-bit slave address
+
+		virtual ~Systronix_M24C32_sim_slave (void) {}
+
+		virtual Systronix_M24C32_sim_slave* route (uint8_t addr) {return (addr == address) ? this : NULL;}
+
+		virtual boolean		select (boolean read, uint64_t now) = 0;	// address phase; return true to ack
+		virtual boolean		receive (uint8_t data, uint64_t now) = 0;	// master-write byte; return true to ack
+		virtual uint8_t		transmit (uint64_t now) = 0;				// master-read byte
+		virtual void		stop (uint64_t now) = 0;					// STOP condition ends the transaction
+	};
+
+
+//---------------------------< S I M   D E V I C E >----------------------------------------------------------
+//
+// simulated M24Cxx eep
+//
+
+class Systronix_M24C32_sim_device : public Systronix_M24C32_sim_slave
+	{
+	protected:
+		struct eep_part	_part;
+		uint32_t	_ptr;									// the device's internal address pointer
+		uint8_t		_block;									// block bits from the slave address of this transaction
+		uint8_t		_addr_bytes;							// address bytes received so far in this write
+		uint8_t		_latch[EEP_PAGE_MAX];					// page latch
+		boolean		_latched[EEP_PAGE_MAX];					// which latch bytes were written
+		uint16_t	_latch_count;
+		uint64_t	_busy_until;							// end of the current tW write cycle
+		boolean		_cut_armed;								// power_cut() pending
+		uint32_t	_cut_cycles;							// write cycles still to complete before the cut
+		uint16_t	_cut_torn;								// latched bytes the torn cycle gets into the array
+		boolean		_dead;									// power is off; nothing acks
+
+	public:
+		uint8_t*	mem;									// the array; tests may inspect or preload directly
+		uint32_t	tw_us;									// write cycle time
+		uint32_t	write_cycles;							// number of tW cycles started
+		uint32_t*	page_wear;								// write cycles per page
+
+		Systronix_M24C32_sim_device (uint8_t addr = 0x50, const struct eep_part& part = EEP_M24C32);
+		~Systronix_M24C32_sim_device (void);
+		Systronix_M24C32_sim_device (const Systronix_M24C32_sim_device& other);	// copies the array and counters
+		Systronix_M24C32_sim_device& operator= (const Systronix_M24C32_sim_device&) = delete;
+
+		void		erase (uint8_t value = 0xFF);			// fill the array and clear counters
+		void		power_cut (uint32_t cycles, uint16_t torn = 0);	// cycles more write cycles complete; the next is torn
+		void		power_on (void);						// answer again; the array keeps what the cut left
+		boolean		powered (void) {return !_dead;}
+		boolean		busy (uint64_t now) {return now < _busy_until;}
+		uint32_t	pointer_get (void) {return _ptr;}
+		uint32_t	size (void) {return _part.size;}
+		uint32_t	pages (void) {return _part.size / _part.page_size;}
+
+		Systronix_M24C32_sim_slave* route (uint8_t addr);	// answers at every slave address its block bits cover
+
+		boolean		select (boolean read, uint64_t now);
+		boolean		receive (uint8_t data, uint64_t now);
+		uint8_t		transmit (uint64_t now);
+		void		stop (uint64_t now);
+	};
+
+
+//---------------------------< S I M   F R A M >--------------------------------------------------------------
+//
+// simulated MB85RC FRAM: two address bytes, no pages, no write cycle; every data byte is in the array as soon
+// as it is acked and the pointer rolls over from the top of the array to 0x0000
+//
+
+class Systronix_M24C32_sim_fram : public Systronix_M24C32_sim_slave
+	{
+	protected:
+		uint32_t	_size;
+		uint32_t	_ptr;									// the device's internal address pointer
+		uint8_t		_addr_bytes;							// address bytes received so far in this write
+
+	public:
+		uint8_t*	mem;									// the array; tests may inspect or preload directly
+		uint32_t	bytes_written;							// data bytes written to the array
+
+		Systronix_M24C32_sim_fram (uint8_t addr = 0x50, uint32_t size = 0x8000);
+		~Systronix_M24C32_sim_fram (void);
+		Systronix_M24C32_sim_fram (const Systronix_M24C32_sim_fram&) = delete;
+		Systronix_M24C32_sim_fram& operator= (const Systronix_M24C32_sim_fram&) = delete;
+
+		void		erase (uint8_t value = 0x00);			// fill the array and clear counters
+
+		boolean		select (boolean read, uint64_t now);
+		boolean		receive (uint8_t data, uint64_t now);
+		uint8_t		transmit (uint64_t now);
+		void		stop (uint64_t now) {(void)now;}
+	};
+
+
+//---------------------------< S I M   M U X >----------------------------------------------------------------
+//
+// simulated PCA9548A 1-to-8 i2c mux.  A one-byte write sets the control register (bit n enables port n); a
+// read returns it.  Slaves attached to a port are reachable only while that port is enabled.  When two
+// enabled ports hold slaves at the same address the first one answers and collisions counts the clash.
+//
+
+#define		SIM_MUX_PORTS		8
+#define		SIM_MUX_SLAVES_MAX	8						// slaves per port
+
+class Systronix_M24C32_sim_mux : public Systronix_M24C32_sim_slave
+	{
+	protected:
+		Systronix_M24C32_sim_slave*	_port[SIM_MUX_PORTS][SIM_MUX_SLAVES_MAX];
+		uint8_t		_count[SIM_MUX_PORTS];
+
+	public:
+		uint8_t		control;								// port enable register; 0 (all off) at power up
+		uint32_t	control_writes;
+		uint32_t	collisions;
+
+		Systronix_M24C32_sim_mux (uint8_t addr = 0x70);
+
+		boolean		attach (uint8_t port, Systronix_M24C32_sim_slave& slave);
+		boolean		detach (uint8_t port, Systronix_M24C32_sim_slave& slave);	// unplug a board
+		Systronix_M24C32_sim_slave* route (uint8_t addr);	// the mux itself or a slave on an enabled port
+
+		boolean		select (boolean read, uint64_t now) {(void)read; (void)now; return true;}
+		boolean		receive (uint8_t data, uint64_t now) {(void)now; control = data; control_writes++; return true;}
+		uint8_t		transmit (uint64_t now) {(void)now; return control;}
+		void		stop (uint64_t now) {(void)now;}
+	};
+
+
+//---------------------------< S I M   B U S >----------------------------------------------------------------
+//
+// simulated i2c_t3-like master
+//
+
+class Systronix_M24C32_sim : public Systronix_M24C32_transport
+	{
+	protected:
+		Systronix_M24C32_sim_slave*	_slaves[SIM_SLAVES_MAX];
+		uint8_t		_slave_count;
+
+		uint64_t	_now;									// simulated cpu time in nanoseconds
+		uint64_t	_bus_t;									// bus time within the transaction in progress
+		uint64_t	_bus_free;								// bus time at which the last transaction ended
+		uint32_t	_hz;									// bus clock rate
+		uint32_t	_bit_ns;								// one SCL period
+
+		uint8_t		_tx_address;
+		uint8_t		_tx_buf[I2C_TX_BUFFER_LENGTH];
+		size_t		_tx_len;
+		boolean		_tx_overflow;
+
+		uint8_t		_rx_buf[I2C_RX_BUFFER_LENGTH];
+		size_t		_rx_len;
+		size_t		_rx_index;
+
+		boolean		_held;									// bus held after I2C_NOSTOP; next START is a repeated start
+		uint8_t		_status;
+
+		Systronix_M24C32_sim_slave*	find (uint8_t address);
+		void		bits (uint32_t count);					// advance simulated time by count SCL periods
+		void		start (void);							// START or repeated START
+		uint8_t		transmit_op (i2c_stop sendStop);
+		size_t		request_op (uint8_t address, size_t len, i2c_stop sendStop);
+
+	public:
+		struct
+			{
+			uint32_t	transactions;						// address phases (START and repeated START)
+			uint64_t	bytes;								// bytes on the bus including slave address bytes
+			uint32_t	addr_nacks;
+			uint32_t	data_nacks;
+			uint64_t	busy_ns;							// time the bus was driven
+			} stats;
+
+		Systronix_M24C32_sim (uint32_t hz = 100000);
+
+		boolean		attach (Systronix_M24C32_sim_slave& slave);
+		void		clock_set (uint32_t hz);
+		uint32_t	clock_get (void) {return _hz;}
+		void		advance (uint32_t us) {_now += (uint64_t)us * 1000;}	// let simulated time pass; e.g. cpu work
+		uint64_t	now_ns (void) {return _now;}
+		void		stats_clear (void);
+
+		void		begin (void);
+		void		begin (i2c_pins pins, i2c_rate rate);
+
+		void		beginTransmission (uint8_t address);
+		size_t		write (uint8_t data);
+		size_t		write (const uint8_t* data, size_t quantity);
+		uint8_t		endTransmission (i2c_stop sendStop = I2C_STOP);
+		void		sendTransmission (i2c_stop sendStop = I2C_STOP);
+
+		size_t		requestFrom (uint8_t address, size_t len, i2c_stop sendStop);
+		void		sendRequest (uint8_t address, size_t len, i2c_stop sendStop);
+		uint8_t		readByte (void);
+		size_t		read (uint8_t* data, size_t count);
+
+		uint8_t		done (void);
+		uint8_t		status (void);
+
+		uint32_t	millis (void) {return (uint32_t)(_now / 1000000);}
+		uint32_t	micros (void) {return (uint32_t)(_now / 1000);}
+	};
+
+#endif	// !ARDUINO
+#endif	// M24C32_SIM_H_
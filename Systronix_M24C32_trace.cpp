@@ -0,0 +1,253 @@
+#if defined (ARDUINO)
+#include <Arduino.h>
+#endif
+#include <Systronix_M24C32_trace.h>
+
+
+//---------------------------< D E F A U L T   C O N S R U C T O R >------------------------------------------
+//
+//
+//
+
+Systronix_M24C32_trace::Systronix_M24C32_trace (void)
+	{
+#if defined (ARDUINO)
+	_bus = &_i2c_t3;							// Wire until setup() says otherwise
+#else
+	_bus = NULL;								// host: setup() must supply a transport
+#endif
+#if EEP_TRACE
+	_head = 0;
+	_enabled = true;
+	_hz = 0;
+	_tx_addr = 0;
+	_tx_len = 0;
+	_tx_data = 0;
+	_pending = false;
+#endif
+	}
+
+
+//---------------------------< S E T U P >--------------------------------------------------------------------
+//
+// the transport to forward to and record
+//
+
+#if defined (ARDUINO)
+uint8_t Systronix_M24C32_trace::setup (i2c_t3& wire)
+	{
+	_i2c_t3.bus_set (wire);
+	return setup (_i2c_t3);
+	}
+#endif
+
+uint8_t Systronix_M24C32_trace::setup (Systronix_M24C32_transport& transport)
+	{
+	_bus = &transport;
+	return SUCCESS;
+	}
+
+
+//---------------------------< B E G I N T R A N S M I S S I O N >--------------------------------------------
+
+void Systronix_M24C32_trace::beginTransmission (uint8_t address)
+	{
+#if EEP_TRACE
+	_tx_addr = address;
+	_tx_len = 0;
+	_tx_data = 0;
+#endif
+	_bus->beginTransmission (address);
+	}
+
+
+//---------------------------< W R I T E >--------------------------------------------------------------------
+//
+// count what the bus accepted and keep the first two bytes
+//
+
+size_t Systronix_M24C32_trace::write (uint8_t data)
+	{
+	return write (&data, 1);
+	}
+
+size_t Systronix_M24C32_trace::write (const uint8_t* data, size_t quantity)
+	{
+	size_t	n = _bus->write (data, quantity);
+
+#if EEP_TRACE
+	for (size_t i=0; (i<n) && ((_tx_len + i) < 2); i++)
+		_tx_data |= (uint16_t)data[i] << (8 * (_tx_len + i));
+	_tx_len += n;
+#endif
+	return n;
+	}
+
+
+//---------------------------< E N D T R A N S M I S S I O N >------------------------------------------------
+
+uint8_t Systronix_M24C32_trace::endTransmission (i2c_stop sendStop)
+	{
+#if EEP_TRACE
+	uint32_t	t = _bus->micros ();
+	uint8_t		ret_val = _bus->endTransmission (sendStop);
+
+	log (t, _tx_addr, (I2C_NOSTOP == sendStop) ? EEP_TR_NOSTOP : 0, _tx_len);
+	return ret_val;
+#else
+	return _bus->endTransmission (sendStop);
+#endif
+	}
+
+
+//---------------------------< S E N D T R A N S M I S S I O N >----------------------------------------------
+//
+// recorded when done() sees it end
+//
+
+void Systronix_M24C32_trace::sendTransmission (i2c_stop sendStop)
+	{
+#if EEP_TRACE
+	_pending = true;
+	_pending_t = _bus->micros ();
+	_pending_addr = _tx_addr;
+	_pending_flags = EEP_TR_ASYNC | ((I2C_NOSTOP == sendStop) ? EEP_TR_NOSTOP : 0);
+	_pending_len = _tx_len;
+#endif
+	_bus->sendTransmission (sendStop);
+	}
+
+
+//---------------------------< R E Q U E S T F R O M >--------------------------------------------------------
+
+size_t Systronix_M24C32_trace::requestFrom (uint8_t address, size_t len, i2c_stop sendStop)
+	{
+#if EEP_TRACE
+	uint32_t	t = _bus->micros ();
+	size_t		n = _bus->requestFrom (address, len, sendStop);
+
+	_tx_data = 0;
+	log (t, address | EEP_TR_READ, (I2C_NOSTOP == sendStop) ? EEP_TR_NOSTOP : 0, (uint16_t)len);
+	return n;
+#else
+	return _bus->requestFrom (address, len, sendStop);
+#endif
+	}
+
+
+//---------------------------< S E N D R E Q U E S T >--------------------------------------------------------
+
+void Systronix_M24C32_trace::sendRequest (uint8_t address, size_t len, i2c_stop sendStop)
+	{
+#if EEP_TRACE
+	_pending = true;
+	_pending_t = _bus->micros ();
+	_pending_addr = address | EEP_TR_READ;
+	_pending_flags = EEP_TR_ASYNC | ((I2C_NOSTOP == sendStop) ? EEP_TR_NOSTOP : 0);
+	_pending_len = (uint16_t)len;
+#endif
+	_bus->sendRequest (address, len, sendStop);
+	}
+
+
+//---------------------------< D O N E >----------------------------------------------------------------------
+
+uint8_t Systronix_M24C32_trace::done (void)
+	{
+	uint8_t	ret_val = _bus->done ();
+
+#if EEP_TRACE
+	if (ret_val && _pending)
+		{
+		_pending = false;
+		if (_pending_addr & EEP_TR_READ)
+			_tx_data = 0;
+		log (_pending_t, _pending_addr, _pending_flags, _pending_len);
+		}
+#endif
+	return ret_val;
+	}
+
+
+#if EEP_TRACE
+
+//---------------------------< L O G >------------------------------------------------------------------------
+//
+// Store one transaction that began at t and has just ended.  A write nacked at the address right after a poll
+// record for the same address is added to that record instead.
+//
+
+void Systronix_M24C32_trace::log (uint32_t t, uint8_t addr, uint8_t flags, uint16_t len)
+	{
+	uint32_t				dur = _bus->micros () - t;
+	uint8_t					status = _bus->status () & EEP_TR_STATUS;
+	struct eep_trace_rec*	rec;
+
+	if (!_enabled)
+		return;
+
+	if (!(addr & EEP_TR_READ) && (I2C_ADDR_NAK == status))
+		{
+		rec = &_ring[(_head - 1) & (EEP_TRACE_DEPTH - 1)];
+		if (_head && (rec->flags & EEP_TR_POLL) && (addr == rec->addr) && (0xFFFF > rec->len))
+			{
+			rec->len++;
+			dur = (t + dur) - rec->t;					// from the first poll to the end of this one
+			rec->dur = (0xFFFF < dur) ? 0xFFFF : (uint16_t)dur;
+			return;
+			}
+		flags |= EEP_TR_POLL;
+		len = 1;
+		}
+
+	rec = &_ring[_head++ & (EEP_TRACE_DEPTH - 1)];
+	rec->t = t;
+	rec->dur = (0xFFFF < dur) ? 0xFFFF : (uint16_t)dur;
+	rec->len = len;
+	rec->addr = addr;
+	rec->flags = flags | status;
+	rec->data = (addr & EEP_TR_READ) ? 0 : _tx_data;
+	}
+
+
+//---------------------------< R E C O R D >------------------------------------------------------------------
+//
+// the i-th record held, 0 being the oldest
+//
+
+const struct eep_trace_rec* Systronix_M24C32_trace::record (uint16_t i)
+	{
+	if (count () <= i)
+		return NULL;
+	return &_ring[(_head - count () + i) & (EEP_TRACE_DEPTH - 1)];
+	}
+
+
+//---------------------------< D U M P >----------------------------------------------------------------------
+//
+// Stream the header and the records, oldest first, to out; at most three calls.  The ring is not cleared.
+// Both ends of the stream are little endian (Teensy and the x86 host) so the structs go out as they are.
+//
+
+void Systronix_M24C32_trace::dump (void (*out) (const uint8_t* data, size_t len))
+	{
+	struct eep_trace_header	header;
+	uint16_t	n = count ();
+	uint16_t	first = (_head - n) & (EEP_TRACE_DEPTH - 1);
+	uint16_t	run = ((EEP_TRACE_DEPTH - first) < n) ? (EEP_TRACE_DEPTH - first) : n;
+
+	memcpy (header.magic, EEP_TR_MAGIC, sizeof(header.magic));
+	header.version = EEP_TR_VERSION;
+	header.rec_size = sizeof(struct eep_trace_rec);
+	header.count = n;
+	header.dropped = dropped ();
+	header.hz = _hz;
+	out ((const uint8_t*)&header, sizeof(header));
+
+	if (run)
+		out ((const uint8_t*)&_ring[first], run * sizeof(struct eep_trace_rec));
+	if (n > run)
+		out ((const uint8_t*)&_ring[0], (n - run) * sizeof(struct eep_trace_rec));
+	}
+
+#endif	// EEP_TRACE
@@ -0,0 +1,164 @@
+#ifndef M24C32_TRACE_H_
+#define	M24C32_TRACE_H_
+
+//
+// Systronix_M24C32_trace.h
+//
+// I2C transaction trace recorder.  Systronix_M24C32_trace is a transport that sits between the drivers and the
+// bus transport, forwards every call, and logs each transaction as a 12-byte record in a RAM ring buffer; when
+// the ring is full the oldest records are overwritten.  Set the drivers (eeproms, a mux map, ...) up on the
+// trace instead of on the bus to record their traffic.  The cost per transaction is two micros() calls and the
+// record store.
+//
+// record (eep_trace_rec; little endian):
+//		t		micros() at the start of the transaction
+//		dur		microseconds to its end (for a non-blocking call, to the done() that saw it end); 0xFFFF or more
+//				is kept as 0xFFFF
+//		len		bytes written (memory address included) or bytes requested by a read; for a poll record, the
+//				number of nacked attempts
+//		addr	7-bit slave address; EEP_TR_READ set for a read
+//		flags	i2c_status at the end of the transaction in the low four bits (I2C_WAITING (0) is success),
+//				EEP_TR_NOSTOP, EEP_TR_POLL, EEP_TR_ASYNC
+//		data	the first two bytes written, first in the low byte: an eeprom's memory address, a mux's control
+//				byte
+//
+// Writes to the same address nacked at the address in a row (ack polls, or write attempts, waiting out a write
+// cycle) are kept as one poll record whose len counts them and whose dur runs from the first to the end of the
+// last; data is from the first.  The attempt that is finally acked is a record of its own, so a wait of any
+// length costs one record more than the transaction it delayed.
+//
+// dump() streams an eep_trace_header and then the records, oldest first, through a callback (Serial.write(),
+// a file, ...).  extras/trace_replay reads that stream, replays it against the simulator, and compares the
+// timing transaction by transaction.
+//
+// Recording is compiled in by default; with EEP_TRACE 0 the class only forwards: no ring, no RAM, and none of
+// the recording functions.  EEP_TRACE_DEPTH (a power of 2) sets the ring size.  Both change the layout of the
+// class, so they are set for the whole build in Systronix_M24C32_config.h or with -D, like EEP_INSTRUMENT.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#include <Systronix_M24C32_config.h>
+#include <Systronix_M24C32_transport.h>
+#if defined (ARDUINO)
+#include <Systronix_M24C32_i2c_t3.h>
+#endif
+
+
+//---------------------------< D E F I N E S >----------------------------------------------------------------
+
+#define		EEP_TR_READ			0x80					// eep_trace_rec.addr: a read
+#define		EEP_TR_STATUS		0x0F					// eep_trace_rec.flags: i2c_status at the end
+#define		EEP_TR_NOSTOP		0x10					// ended with I2C_NOSTOP
+#define		EEP_TR_POLL			0x20					// writes nacked at the address; len counts them
+#define		EEP_TR_ASYNC		0x40					// sendTransmission() or sendRequest()
+
+#define		EEP_TR_MAGIC		"M24T"
+#define		EEP_TR_VERSION		1
+
+
+//---------------------------< E E P _ T R A C E _ R E C >----------------------------------------------------
+
+struct eep_trace_rec
+	{
+	uint32_t	t;
+	uint16_t	dur;
+	uint16_t	len;
+	uint8_t		addr;
+	uint8_t		flags;
+	uint16_t	data;
+	};
+
+
+//---------------------------< E E P _ T R A C E _ H E A D E R >----------------------------------------------
+//
+// the start of a dump()
+//
+
+struct eep_trace_header
+	{
+	char		magic[4];								// EEP_TR_MAGIC; not terminated
+	uint8_t		version;								// EEP_TR_VERSION
+	uint8_t		rec_size;								// sizeof (eep_trace_rec)
+	uint16_t	count;									// records that follow
+	uint32_t	dropped;								// older records overwritten before the dump
+	uint32_t	hz;										// bus rate as given to hz_set(); 0 when not known
+	};
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_trace : public Systronix_M24C32_transport
+	{
+	protected:
+		Systronix_M24C32_transport*	_bus;
+#if defined (ARDUINO)
+		Systronix_M24C32_i2c_t3	_i2c_t3;
+#endif
+
+#if EEP_TRACE
+		struct eep_trace_rec	_ring[EEP_TRACE_DEPTH];
+		uint32_t	_head;								// records ever stored; the next goes to _head % depth
+		boolean		_enabled;
+		uint32_t	_hz;
+
+		uint8_t		_tx_addr;
+		uint16_t	_tx_len;
+		uint16_t	_tx_data;
+
+		boolean		_pending;							// a non-blocking call has not yet been seen done()
+		uint32_t	_pending_t;
+		uint8_t		_pending_addr;
+		uint8_t		_pending_flags;
+		uint16_t	_pending_len;
+
+		void		log (uint32_t t, uint8_t addr, uint8_t flags, uint16_t len);
+#endif
+
+	public:
+		Systronix_M24C32_trace (void);
+
+#if defined (ARDUINO)
+		uint8_t		setup (i2c_t3& wire = Wire);
+#endif
+		uint8_t		setup (Systronix_M24C32_transport& transport);
+
+#if EEP_TRACE
+		void		enable (boolean on) {_enabled = on;}	// on by default
+		void		clear (void) {_head = 0;}
+		void		hz_set (uint32_t hz) {_hz = hz;}	// goes into the dump header for the replay
+		uint16_t	count (void) {return (EEP_TRACE_DEPTH < _head) ? EEP_TRACE_DEPTH : _head;}
+		uint32_t	dropped (void) {return (EEP_TRACE_DEPTH < _head) ? (_head - EEP_TRACE_DEPTH) : 0;}
+		const struct eep_trace_rec*	record (uint16_t i);	// 0 is the oldest held; NULL past count()
+		void		dump (void (*out) (const uint8_t* data, size_t len));	// header, then count() records
+#endif
+
+		void		begin (void) {_bus->begin ();}
+		void		begin (i2c_pins pins, i2c_rate rate) {_bus->begin (pins, rate);}
+
+		void		beginTransmission (uint8_t address);
+		size_t		write (uint8_t data);
+		size_t		write (const uint8_t* data, size_t quantity);
+		uint8_t		endTransmission (i2c_stop sendStop = I2C_STOP);
+		void		sendTransmission (i2c_stop sendStop = I2C_STOP);
+
+		size_t		requestFrom (uint8_t address, size_t len, i2c_stop sendStop);
+		void		sendRequest (uint8_t address, size_t len, i2c_stop sendStop);
+		uint8_t		readByte (void) {return _bus->readByte ();}
+		size_t		read (uint8_t* data, size_t count) {return _bus->read (data, count);}
+
+		uint8_t		done (void);
+		uint8_t		status (void) {return _bus->status ();}
+
+		uint32_t	millis (void) {return _bus->millis ();}
+		uint32_t	micros (void) {return _bus->micros ();}
+
+		void		hold (void) {_bus->hold ();}
+		void		release (void) {_bus->release ();}
+		uint32_t	epoch (void) {return _bus->epoch ();}
+	};
+
+#endif	// M24C32_TRACE_H_
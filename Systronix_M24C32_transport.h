@@ -0,0 +1,67 @@
+#ifndef M24C32_TRANSPORT_H_
+#define	M24C32_TRANSPORT_H_
+
+//
+// Systronix_M24C32_transport.h
+//
+// Abstract I2C master transport used by Systronix_M24C32.  The method names and return values deliberately
+// mirror the subset of i2c_t3 that the driver uses so that the driver code reads the same regardless of which
+// transport it is bound to:
+//
+//		Systronix_M24C32_i2c_t3		wraps a Teensy i2c_t3 bus object (Wire, Wire1, ...) by reference
+//		Systronix_M24C32_sim		a host-side simulated bus with simulated M24C32 devices attached
+//		Systronix_M24C32_linux		Linux i2c-dev (/dev/i2c-N) through I2C_RDWR ioctls
+//
+// millis() and micros() belong to the transport because the simulated bus runs on simulated time; on target
+// the i2c_t3 transport simply returns the Arduino clocks.
+//
+// hold(), release(), and epoch() matter only on a bus shared through Systronix_M24C32_sched; every other
+// transport has the bus to itself and keeps the defaults.
+//
+
+//---------------------------< I N C L U D E S >--------------------------------------------------------------
+
+#if defined (ARDUINO)
+#include <Arduino.h>
+#include <Systronix_i2c_common.h>
+#else
+#include <Systronix_M24C32_host.h>
+#endif
+
+
+//---------------------------< C L A S S >--------------------------------------------------------------------
+//
+//
+//
+
+class Systronix_M24C32_transport
+	{
+	public:
+		virtual ~Systronix_M24C32_transport (void) {}
+
+		virtual void		begin (void) = 0;						// default begin; join bus as master
+		virtual void		begin (i2c_pins pins, i2c_rate rate) = 0;
+
+		virtual void		beginTransmission (uint8_t address) = 0;	// init tx buff for xmit to slave at address
+		virtual size_t		write (uint8_t data) = 0;				// add a byte to the tx buffer; 0 = overflow
+		virtual size_t		write (const uint8_t* data, size_t quantity) = 0;
+		virtual uint8_t		endTransmission (i2c_stop sendStop = I2C_STOP) = 0;	// 0=success, 1=too long, 2=addr nack, 3=data nack, 4=other
+		virtual void		sendTransmission (i2c_stop sendStop = I2C_STOP) = 0;	// non-blocking endTransmission(); see done()
+
+		virtual size_t		requestFrom (uint8_t address, size_t len, i2c_stop sendStop) = 0;	// returns number of bytes received
+		virtual void		sendRequest (uint8_t address, size_t len, i2c_stop sendStop) = 0;	// non-blocking requestFrom(); see done()
+		virtual uint8_t		readByte (void) = 0;					// get one byte from the rx buffer
+		virtual size_t		read (uint8_t* data, size_t count) = 0;	// bulk copy count bytes from the rx buffer
+
+		virtual uint8_t		done (void) = 0;						// 1 when the last non-blocking operation has finished
+		virtual uint8_t		status (void) = 0;						// i2c_status of the most recent operation
+
+		virtual uint32_t	millis (void) = 0;						// bus clock; simulated time on the host
+		virtual uint32_t	micros (void) = 0;
+
+		virtual void		hold (void) {}							// keep the bus across STOPs until release(); nests
+		virtual void		release (void) {}
+		virtual uint32_t	epoch (void) {return 0;}				// changes when another master may have used the bus
+	};
+
+#endif	// M24C32_TRANSPORT_H_
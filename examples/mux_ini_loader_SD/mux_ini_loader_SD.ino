@@ -135,6 +135,10 @@ union
 	uint8_t			as_array[32];
 	} sensor1_page, sensor2_page, sensor3_page;
 
+static_assert (sizeof(assy_page.as_struct) == PAGE_SIZE, "mux_settings must fill exactly one eep page");
+static_assert (sizeof(sensor1_page.as_struct) == PAGE_SIZE, "sensor_settings must fill exactly one eep page");
+static_assert (Systronix_M24C32::page_fit<decltype(assy_page.as_struct)>(ASSY_PAGE_ADDR), "assy page crosses an eep page boundary");
+
 
 //---------------------------< S T O P W A T C H >------------------------------------------------------------
 //
@@ -900,7 +904,10 @@ void loop (void)
 			{
 			eep.begin (I2C_PINS_29_30, I2C_RATE_100);
 			if (SUCCESS == eep.init ())
+				{
 				Serial.printf ("\tmux[0] eeprom initialized\n");
+				eep.compare_set (true);							// don't spend a write cycle on pages that already match
+				}
 			else
 				{
 				Serial.printf ("\tmux[0] eeprom not detected\n");
@@ -909,10 +916,7 @@ void loop (void)
 				}
 			}
 
-		eep.set_addr16 (ASSY_PAGE_ADDR);						// point to page 0, address 0
-		eep.control.rd_wr_len = PAGE_SIZE;						// set page size
-		eep.control.wr_buf_ptr = (uint8_t*)assy_page.as_array;	// point to source buffer
-		eep.page_write ();										// write the page
+		eep.write<ASSY_PAGE_ADDR> (assy_page.as_struct);		// write page 0; single page write checked at compile time
 
 #ifdef DEBUG_OUTPUT
 		eep.set_addr16 (ASSY_PAGE_ADDR);							// point to page 0, address 0
@@ -927,18 +931,12 @@ void loop (void)
 
 		if (*sensor1_page.as_struct.sensor_type)
 			{
-			eep.set_addr16 (SENSOR1_PAGE_ADDR);						// point to page 1, address 0
-			eep.control.rd_wr_len = PAGE_SIZE;						// set page size
-			eep.control.wr_buf_ptr = (uint8_t*)sensor1_page.as_array;	// point to source buffer
-			eep.page_write ();										// write the page
+			eep.write<SENSOR1_PAGE_ADDR> (sensor1_page.as_struct);	// write page 1
 			}
 		else
 			{
 			memset (sensor1_page.as_array, 0xFF, PAGE_SIZE);		// make sure this page is erased
-			eep.set_addr16 (SENSOR1_PAGE_ADDR);						// point to page 1, address 0
-			eep.control.rd_wr_len = PAGE_SIZE;						// set page size
-			eep.control.wr_buf_ptr = (uint8_t*)sensor1_page.as_array;	// point to source buffer
-			eep.page_write ();										// write the page
+			eep.write<SENSOR1_PAGE_ADDR> (sensor1_page.as_struct);	// write page 1
 			}
 
 #ifdef DEBUG_OUTPUT
@@ -954,18 +952,12 @@ void loop (void)
 
 		if (*sensor2_page.as_struct.sensor_type)
 			{
-			eep.set_addr16 (SENSOR2_PAGE_ADDR);						// point to page 1, address 0
-			eep.control.rd_wr_len = PAGE_SIZE;						// set page size
-			eep.control.wr_buf_ptr = (uint8_t*)sensor2_page.as_array;	// point to source buffer
-			eep.page_write ();										// write the page
+			eep.write<SENSOR2_PAGE_ADDR> (sensor2_page.as_struct);	// write page 2
 			}
 		else
 			{
 			memset (sensor2_page.as_array, 0xFF, PAGE_SIZE);		// make sure this page is erased
-			eep.set_addr16 (SENSOR2_PAGE_ADDR);						// point to page 1, address 0
-			eep.control.rd_wr_len = PAGE_SIZE;						// set page size
-			eep.control.wr_buf_ptr = (uint8_t*)sensor2_page.as_array;	// point to source buffer
-			eep.page_write ();										// write the page
+			eep.write<SENSOR2_PAGE_ADDR> (sensor2_page.as_struct);	// write page 2
 			}
 
 #ifdef DEBUG_OUTPUT
@@ -981,18 +973,12 @@ void loop (void)
 
 		if (*sensor3_page.as_struct.sensor_type)
 			{
-			eep.set_addr16 (SENSOR3_PAGE_ADDR);						// point to page 1, address 0
-			eep.control.rd_wr_len = PAGE_SIZE;						// set page size
-			eep.control.wr_buf_ptr = (uint8_t*)sensor3_page.as_array;	// point to source buffer
-			eep.page_write ();										// write the page
+			eep.write<SENSOR3_PAGE_ADDR> (sensor3_page.as_struct);	// write page 3
 			}
 		else
 			{
 			memset (sensor3_page.as_array, 0xFF, PAGE_SIZE);		// make sure this page is erased
-			eep.set_addr16 (SENSOR3_PAGE_ADDR);						// point to page 1, address 0
-			eep.control.rd_wr_len = PAGE_SIZE;						// set page size
-			eep.control.wr_buf_ptr = (uint8_t*)sensor3_page.as_array;	// point to source buffer
-			eep.page_write ();										// write the page
+			eep.write<SENSOR3_PAGE_ADDR> (sensor3_page.as_struct);	// write page 3
 			}
 
 #ifdef DEBUG_OUTPUT
@@ -1006,7 +992,7 @@ void loop (void)
 			}
 #endif
 
-		Serial.printf ("mux[0] eeprom write complete\n");
+		Serial.printf ("mux[0] eeprom write complete; %lu page write(s) skipped; %lu byte(s) not rewritten\n", (unsigned long)eep.stats.writes_avoided, (unsigned long)eep.stats.bytes_saved);
 		}
 
 
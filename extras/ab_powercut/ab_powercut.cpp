@@ -0,0 +1,229 @@
+//
+// ab_powercut.cpp
+//
+// Power cuts during a commit of a 128-byte block (the four identity pages) on a simulated M24C32 at 400kHz,
+// for the two ways of keeping it:
+//		in place		crc_write() over the old copy; crc_read() at boot
+//		A/B				Systronix_M24C32_atomic commit(); mount() and read() at boot
+//
+// For each, one uninterrupted update from the old block to the new one counts the write cycles it takes and
+// times it.  Then, from the same starting array each time, the update is repeated with power_cut() at each of
+// those write cycles and with every number of the cut cycle's latched bytes (none to all but one of a page)
+// reaching the array.  After each cut: power_on(), init(), and the boot check.  In place, a cut that leaves no
+// copy that passes its CRC is counted.  A/B must always mount and read back the old block or the new one,
+// the new one whenever commit() returned SUCCESS, and a further commit() after the cut must win; anything
+// else is a failure.  It prints the write cycles, the commit time, and the boot check times.
+//
+// Any failure exits with status 1.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/ab_powercut/ab_powercut.cpp Systronix_M24C32*.cpp -o ab_powercut && ./ab_powercut
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_atomic.h>
+#include <Systronix_M24C32_sim.h>
+#include <stdio.h>
+
+#define		LEN				128
+#define		AT				0x100						// block address (slot A for A/B)
+
+static uint8_t		old_block[LEN];
+static uint8_t		new_block[LEN];
+static uint8_t		back[LEN];
+static uint8_t		snap[ADDRESS_MAX + 1];				// the array before the update
+
+
+//---------------------------< F I N I S H >------------------------------------------------------------------
+//
+// a read with its address phase; waits out the write cycle that crc_write() leaves running
+//
+
+static void finish (Systronix_M24C32& eep)
+	{
+	uint8_t	x;
+
+	eep.read (0, &x, 1);
+	}
+
+
+//---------------------------< I N _ P L A C E >--------------------------------------------------------------
+
+static void in_place (Systronix_M24C32_sim& bus, Systronix_M24C32_sim_device& dev)
+	{
+	Systronix_M24C32	eep;
+	uint32_t	cycles;
+	uint32_t	cuts = 0;
+	uint32_t	lost = 0;
+	uint64_t	t0;
+	uint64_t	boot_ns = 0;
+
+	eep.setup (0x50, bus);
+	eep.init ();
+	eep.crc_write (AT, old_block, LEN, EEP_CRC32);
+	finish (eep);
+	memcpy (snap, dev.mem, sizeof(snap));
+
+	cycles = dev.write_cycles;
+	eep.crc_write (AT, new_block, LEN, EEP_CRC32);
+	finish (eep);
+	cycles = dev.write_cycles - cycles;
+
+	for (uint32_t k=0; k<cycles; k++)
+		for (uint16_t torn=0; torn<EEP_M24C32.page_size; torn++)
+			{
+			Systronix_M24C32	writer;
+			Systronix_M24C32	booter;
+
+			memcpy (dev.mem, snap, sizeof(snap));
+			dev.power_on ();
+			writer.setup (0x50, bus);
+			writer.init ();
+			dev.power_cut (k, torn);
+			writer.crc_write (AT, new_block, LEN, EEP_CRC32);
+			finish (writer);
+
+			dev.power_on ();
+			booter.setup (0x50, bus);
+			booter.init ();
+			t0 = bus.now_ns ();
+			if (SUCCESS != booter.crc_read (AT, back, LEN, EEP_CRC32))
+				lost++;
+			boot_ns += bus.now_ns () - t0;
+			cuts++;
+			}
+
+	printf ("in place   %u write cycles                     boot check %5.2f ms   %3u of %3u cuts left no valid copy\n",
+		cycles, boot_ns / 1e6 / cuts, lost, cuts);
+	}
+
+
+//---------------------------< A _ B >------------------------------------------------------------------------
+//
+// returns the number of failures
+//
+
+static uint32_t a_b (Systronix_M24C32_sim& bus, Systronix_M24C32_sim_device& dev)
+	{
+	Systronix_M24C32			eep;
+	Systronix_M24C32_atomic		ab;
+	uint32_t	cycles;
+	uint32_t	cuts = 0;
+	uint32_t	got_old = 0;
+	uint32_t	got_new = 0;
+	uint32_t	lost = 0;
+	uint32_t	bad = 0;
+	uint64_t	t0;
+	uint64_t	commit_ns;
+	uint64_t	mount_ns = 0;
+	uint64_t	mount_max = 0;
+	uint64_t	ns;
+
+	dev.erase ();
+	dev.power_on ();
+	eep.setup (0x50, bus);
+	eep.init ();
+	ab.begin (eep, AT, LEN);
+	ab.mount ();
+	if (SUCCESS != ab.commit (old_block))
+		bad++;
+	memcpy (snap, dev.mem, sizeof(snap));
+
+	cycles = dev.write_cycles;
+	t0 = bus.now_ns ();
+	if (SUCCESS != ab.commit (new_block))
+		bad++;
+	commit_ns = bus.now_ns () - t0;
+	cycles = dev.write_cycles - cycles;
+
+	for (uint32_t k=0; k<cycles; k++)
+		for (uint16_t torn=0; torn<EEP_M24C32.page_size; torn++)
+			{
+			Systronix_M24C32			writer;
+			Systronix_M24C32			booter;
+			Systronix_M24C32_atomic		writer_ab;
+			Systronix_M24C32_atomic		booter_ab;
+			uint8_t		commit_ret;
+			uint8_t		mount_ret;
+			uint8_t		read_ret;
+
+			memcpy (dev.mem, snap, sizeof(snap));
+			dev.power_on ();
+			writer.setup (0x50, bus);
+			writer.init ();
+			writer_ab.begin (writer, AT, LEN);
+			writer_ab.mount ();
+			dev.power_cut (k, torn);
+			commit_ret = writer_ab.commit (new_block);
+
+			dev.power_on ();
+			booter.setup (0x50, bus);
+			booter.init ();
+			booter_ab.begin (booter, AT, LEN);
+			t0 = bus.now_ns ();
+			mount_ret = booter_ab.mount ();
+			ns = bus.now_ns () - t0;
+			mount_ns += ns;
+			if (ns > mount_max)
+				mount_max = ns;
+			read_ret = booter_ab.read (back);
+			cuts++;
+
+			if ((SUCCESS != mount_ret) || (SUCCESS != read_ret))
+				{
+				printf ("cut at write cycle %u, %u bytes torn: no valid copy (mount %u, read %u)\n", k, torn, mount_ret, read_ret);
+				lost++;
+				bad++;
+				continue;
+				}
+			if (!memcmp (back, new_block, LEN))
+				got_new++;
+			else if (!memcmp (back, old_block, LEN))
+				{
+				got_old++;
+				if (SUCCESS == commit_ret)
+					{
+					printf ("cut at write cycle %u, %u bytes torn: commit() returned SUCCESS but the old block came back\n", k, torn);
+					bad++;
+					}
+				}
+			else
+				{
+				printf ("cut at write cycle %u, %u bytes torn: neither the old block nor the new one\n", k, torn);
+				bad++;
+				}
+
+			if ((SUCCESS != booter_ab.commit (new_block)) || (SUCCESS != booter_ab.read (back)) || memcmp (back, new_block, LEN))
+				{
+				printf ("cut at write cycle %u, %u bytes torn: the commit() after the cut did not win\n", k, torn);
+				bad++;
+				}
+			}
+
+	printf ("A/B        %u write cycles   commit %5.2f ms   mount %5.2f ms (max %.2f)   %3u of %3u cuts left no valid copy   (%u old, %u new)\n",
+		cycles, commit_ns / 1e6, mount_ns / 1e6 / cuts, mount_max / 1e6, lost, cuts, got_old, got_new);
+	return bad;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (void)
+	{
+	Systronix_M24C32_sim		bus (400000);
+	Systronix_M24C32_sim_device	dev (0x50);
+	uint32_t	bad;
+
+	for (uint16_t i=0; i<LEN; i++)
+		{
+		old_block[i] = (uint8_t)i;
+		new_block[i] = (uint8_t)(0xA0 ^ (i * 3));
+		}
+
+	bus.attach (dev);
+	printf ("%u-byte block at 0x%03X, 400kHz; power cut at every write cycle of the update, 0 - %u bytes of it torn\n",
+		LEN, AT, EEP_M24C32.page_size - 1);
+	in_place (bus, dev);
+	bad = a_b (bus, dev);
+	return bad ? 1 : 0;
+	}
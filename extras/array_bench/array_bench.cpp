@@ -0,0 +1,150 @@
+//
+// array_bench.cpp
+//
+// Scaling of Systronix_M24C32_array with the number of parts, on simulated M24C32s (tW 5ms) at 0x50 - 0x57 on
+// one bus at 100kHz, 400kHz, and 1MHz.  For 1, 2, 4, and 8 parts, concatenated and striped, it reports:
+//		fill		time and KB/s to write every part with one write()
+//		4 KB		time for a single 4 KB write() at address 0
+//		overlapped	page writes sent while another part was in its write cycle, of all page writes
+//
+// After each fill the array is read back and every part's simulated array is checked against the layout, and
+// 200 random ranges are then written and read back on a three-part array of each layout; any mismatch exits
+// with status 1.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/array_bench/array_bench.cpp Systronix_M24C32*.cpp -o array_bench && ./array_bench
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_array.h>
+#include <Systronix_M24C32_sim.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define		PART_SIZE		(ADDRESS_MAX + 1)
+
+static uint8_t		image[EEP_ARRAY_MAX * PART_SIZE];
+static uint8_t		back[EEP_ARRAY_MAX * PART_SIZE];
+static const char*	layout_name[] = {"concat", "stripe"};
+
+
+//---------------------------< F I L L >----------------------------------------------------------------------
+//
+// parts parts in layout at hz; returns false when the data are not where the layout puts them
+//
+
+static bool fill (uint32_t hz, uint8_t parts, uint8_t layout)
+	{
+	Systronix_M24C32_sim		bus (hz);
+	Systronix_M24C32_sim_device	dev[EEP_ARRAY_MAX] = {0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57};
+	Systronix_M24C32			eep[EEP_ARRAY_MAX];
+	Systronix_M24C32_array		array;
+	uint32_t	len = parts * PART_SIZE;
+	uint64_t	t0;
+	double		fill_ms;
+	double		one_ms;
+	bool		ok;
+
+	array.begin (layout);
+	for (uint8_t i=0; i<parts; i++)
+		{
+		bus.attach (dev[i]);
+		eep[i].setup (0x50 + i, bus);
+		eep[i].init ();
+		array.add (eep[i]);
+		}
+
+	t0 = bus.now_ns ();
+	ok = (SUCCESS == array.write (0, image, len));
+	fill_ms = (bus.now_ns () - t0) / 1e6;
+
+	bus.advance (6000);									// let the last write cycles end
+	ok = ok && (SUCCESS == array.read (0, back, len)) && !memcmp (back, image, len);
+	for (uint32_t p=0; p<(len / EEP_PAGE_SIZE); p++)
+		{
+		uint8_t		part = (EEP_ARRAY_CONCAT == layout) ? (p / (PART_SIZE / EEP_PAGE_SIZE)) : (p % parts);
+		uint32_t	page = (EEP_ARRAY_CONCAT == layout) ? (p % (PART_SIZE / EEP_PAGE_SIZE)) : (p / parts);
+
+		ok = ok && !memcmp (&dev[part].mem[page * EEP_PAGE_SIZE], &image[p * EEP_PAGE_SIZE], EEP_PAGE_SIZE);
+		}
+
+	bus.advance (6000);
+	t0 = bus.now_ns ();
+	array.write (0, &image[7], PART_SIZE);
+	one_ms = (bus.now_ns () - t0) / 1e6;
+
+	printf ("  %u %s: fill %5u bytes %7.1f ms = %5.1f KB/s   4 KB write %7.1f ms   overlapped %4u / %4u  %s\n",
+		parts, layout_name[layout], len, fill_ms, len / fill_ms * 1000 / 1024, one_ms, array.stats.overlapped,
+		array.stats.page_writes, ok ? "ok" : "MISMATCH");
+	return ok;
+	}
+
+
+//---------------------------< R A N D O M _ R A N G E S >----------------------------------------------------
+//
+// three parts at 400kHz; returns false on a mismatch or when a write past the end is not DENIED
+//
+
+static bool random_ranges (uint8_t layout)
+	{
+	Systronix_M24C32_sim		bus (400000);
+	Systronix_M24C32_sim_device	dev[3] = {0x50, 0x51, 0x52};
+	Systronix_M24C32			eep[3];
+	Systronix_M24C32_array		array;
+	uint32_t	bad = 0;
+
+	array.begin (layout);
+	for (uint8_t i=0; i<3; i++)
+		{
+		bus.attach (dev[i]);
+		eep[i].setup (0x50 + i, bus);
+		eep[i].init ();
+		array.add (eep[i]);
+		}
+
+	for (uint32_t k=0; k<200; k++)
+		{
+		uint32_t	addr = rand () % (3 * PART_SIZE);
+		uint32_t	len = rand () % ((3 * PART_SIZE) - addr + 1);
+
+		if (3000 < len)
+			len %= 3000;
+		array.write (addr, &image[k], len);
+		memset (back, 0, len);
+		array.read (addr, back, len);
+		if (memcmp (back, &image[k], len))
+			bad++;
+		}
+
+	printf ("  200 random ranges, 3 parts %s: %u mismatched\n", layout_name[layout], bad);
+	return !bad && (DENIED == array.write ((3 * PART_SIZE) - 1, image, 2));
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (void)
+	{
+	static const uint32_t	rates[] = {100000, 400000, 1000000};
+	static const uint8_t	counts[] = {1, 2, 4, 8};
+	bool	ok = true;
+
+	srand (1);
+	for (uint32_t i=0; i<sizeof(image); i++)
+		image[i] = (uint8_t)rand ();
+
+	for (uint32_t hz : rates)
+		{
+		printf ("%u Hz\n", hz);
+		for (uint8_t parts : counts)
+			{
+			ok = fill (hz, parts, EEP_ARRAY_CONCAT) && ok;
+			ok = fill (hz, parts, EEP_ARRAY_STRIPE) && ok;
+			}
+		}
+
+	printf ("400000 Hz\n");
+	ok = random_ranges (EEP_ARRAY_CONCAT) && ok;
+	ok = random_ranges (EEP_ARRAY_STRIPE) && ok;
+	return ok ? 0 : 1;
+	}
@@ -0,0 +1,113 @@
+//
+// async_bench.cpp
+//
+// Main-loop latency of submit_write() / poll() against a blocking write() on a simulated M24C32 (tW 5ms) at
+// 100kHz, 400kHz, and 1MHz.  A 4 KB image is written once with write(), timing how long the loop is stalled,
+// and once with submit_write() from a loop that does 200us of other work and then calls poll() on each pass;
+// the longest pass and the total time to completion are reported.  The image is then read back with
+// submit_read() and compared with the array and with what was written; any mismatch, or a callback that was
+// not called, exits with status 1.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/async_bench/async_bench.cpp Systronix_M24C32*.cpp -o async_bench && ./async_bench
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_sim.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define		IMAGE_SIZE		4096
+#define		WORK_US			200						// other work per main-loop pass
+
+static uint8_t		image[IMAGE_SIZE];
+static uint8_t		back[IMAGE_SIZE];
+static uint32_t		callbacks;
+
+
+//---------------------------< D O N E >----------------------------------------------------------------------
+
+static void done (struct Systronix_M24C32::eep_request* req)
+	{
+	(void)req;
+	callbacks++;
+	}
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+//
+// one bus rate; returns false when the data or the callback count is wrong
+//
+
+static bool run (uint32_t hz)
+	{
+	Systronix_M24C32_sim		bus (hz);
+	Systronix_M24C32_sim_device	dev (0x50);
+	Systronix_M24C32			eep;
+	struct Systronix_M24C32::eep_request*	req;
+	uint64_t	t0;
+	uint64_t	blocking;
+	uint64_t	pass;
+	uint64_t	longest = 0;
+	uint32_t	passes = 0;
+	uint32_t	calls = callbacks;
+	bool		ok;
+
+	bus.attach (dev);
+	eep.setup (0x50, bus);
+	eep.init ();
+
+	t0 = bus.now_ns ();
+	eep.write (0, image, IMAGE_SIZE);
+	blocking = bus.now_ns () - t0;
+
+	dev.erase ();
+	bus.advance (20000);							// let the last write cycle end
+
+	req = eep.submit_write (0, image, IMAGE_SIZE, done);
+	t0 = bus.now_ns ();
+	while (PENDING == req->status)
+		{
+		pass = bus.now_ns ();
+		bus.advance (WORK_US);
+		eep.poll ();
+		pass = bus.now_ns () - pass;
+		if (pass > longest)
+			longest = pass;
+		passes++;
+		}
+	t0 = bus.now_ns () - t0;
+	ok = (SUCCESS == req->status);
+
+	req = eep.submit_read (0, back, IMAGE_SIZE, done);
+	while (PENDING == req->status)
+		{
+		bus.advance (50);
+		eep.poll ();
+		}
+
+	ok = ok && (SUCCESS == req->status) && !memcmp (dev.mem, image, IMAGE_SIZE) && !memcmp (back, image, IMAGE_SIZE);
+	ok = ok && ((calls + 2) == callbacks);
+
+	printf ("%7u Hz  blocking write() stalls %7.1f ms   async: longest pass %4.0f us, %7.1f ms total, %5u passes, %4u nacks  %s\n",
+		hz, blocking / 1e6, longest / 1e3, t0 / 1e6, passes, eep.stats.async_nacks, ok ? "ok" : "MISMATCH");
+	return ok;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (void)
+	{
+	bool	ok = true;
+
+	srand (1);
+	for (int i=0; i<IMAGE_SIZE; i++)
+		image[i] = (uint8_t)rand ();
+
+	printf ("4 KB image, %u us of other work per pass\n", WORK_US);
+	ok = run (100000) && ok;
+	ok = run (400000) && ok;
+	ok = run (1000000) && ok;
+	return ok ? 0 : 1;
+	}
@@ -0,0 +1,226 @@
+//
+// cache_check.cpp
+//
+// Randomised check of Systronix_M24C32_cache against the uncached driver.  Two simulated M24C32s at 400kHz get
+// the same sequence of random reads and writes (1 - 70 bytes anywhere in the array, and whole aligned pages),
+// one through the cache and one directly; every read must return the same bytes from both and from a model
+// of the array.  flush() is called at random and the cache is re-begun every 500 operations with 1 to
+// EEP_CACHE_PAGES_MAX pages, so the small caches evict on nearly every miss.
+//
+// Partial dirty spans: before each operation, every byte of a dirty cached page outside its dirty span is
+// overwritten in the simulated array with a marker (pages the operation itself touches are left alone).  A
+// flush or eviction that writes more than the span overwrites a marker and is reported; the array is restored
+// after the operation.
+//
+// After the last flush both arrays must equal the model and no page may have had more write cycles through
+// the cache than without it.  Any failure exits with status 1.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/cache_check/cache_check.cpp Systronix_M24C32*.cpp -o cache_check && ./cache_check [seed]
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_cache.h>
+#include <Systronix_M24C32_sim.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define		OPS				20000
+#define		REBEGIN			500						// operations between begin() calls
+#define		OP_LEN_MAX		70
+#define		MARK			0xA5
+
+static uint8_t		model[ADDRESS_MAX + 1];
+static uint32_t		errors;
+
+
+//---------------------------< C A C H E _ P R O B E >--------------------------------------------------------
+//
+// the cache with its slots visible
+//
+
+class cache_probe : public Systronix_M24C32_cache
+	{
+	public:
+		boolean	span (uint8_t i, uint16_t* page, uint8_t* lo, uint8_t* hi)	// true when slot i is dirty
+			{
+			if ((i >= _pages) || (EEP_CACHE_EMPTY == _slot[i].page) || (_slot[i].dirty_lo > _slot[i].dirty_hi))
+				return false;
+			*page = _slot[i].page;
+			*lo = _slot[i].dirty_lo;
+			*hi = _slot[i].dirty_hi;
+			return true;
+			}
+	};
+
+
+//---------------------------< M A R K S >--------------------------------------------------------------------
+//
+// Set marks in the clean part of every dirty page outside first - last, saving what they cover, or check and
+// restore them.
+//
+
+struct marked_page
+	{
+	uint16_t	page;
+	uint8_t		lo;
+	uint8_t		hi;
+	uint8_t		saved[EEP_PAGE_SIZE];
+	};
+
+static uint8_t marks_set (cache_probe& cache, Systronix_M24C32_sim_device& dev, struct marked_page* marked, uint16_t first, uint16_t last)
+	{
+	uint8_t	n = 0;
+
+	for (uint8_t i=0; i<EEP_CACHE_PAGES_MAX; i++)
+		{
+		struct marked_page&	m = marked[n];
+
+		if (!cache.span (i, &m.page, &m.lo, &m.hi) || ((m.page >= first) && (m.page <= last)))
+			continue;
+		memcpy (m.saved, &dev.mem[m.page * EEP_PAGE_SIZE], EEP_PAGE_SIZE);
+		for (uint8_t k=0; k<EEP_PAGE_SIZE; k++)
+			if ((k < m.lo) || (k > m.hi))
+				dev.mem[(m.page * EEP_PAGE_SIZE) + k] = MARK ^ k;
+		n++;
+		}
+	return n;
+	}
+
+static void marks_check (Systronix_M24C32_sim_device& dev, struct marked_page* marked, uint8_t n, uint32_t op)
+	{
+	for (uint8_t i=0; i<n; i++)
+		{
+		struct marked_page&	m = marked[i];
+
+		for (uint8_t k=0; k<EEP_PAGE_SIZE; k++)
+			{
+			if ((k >= m.lo) && (k <= m.hi))
+				continue;
+			if ((MARK ^ k) != dev.mem[(m.page * EEP_PAGE_SIZE) + k])
+				{
+				printf ("op %u: page %u byte %u written outside dirty span %u - %u\n", op, m.page, k, m.lo, m.hi);
+				errors++;
+				}
+			dev.mem[(m.page * EEP_PAGE_SIZE) + k] = m.saved[k];
+			}
+		}
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	Systronix_M24C32_sim			cached_bus (400000);
+	Systronix_M24C32_sim			direct_bus (400000);
+	Systronix_M24C32_sim_device		cached_dev (0x50);
+	Systronix_M24C32_sim_device		direct_dev (0x50);
+	Systronix_M24C32				cached_eep;
+	Systronix_M24C32				direct_eep;
+	cache_probe						cache;
+	struct marked_page				marked[EEP_CACHE_PAGES_MAX];
+	uint8_t		buf[OP_LEN_MAX];
+	uint8_t		back[OP_LEN_MAX];
+	uint32_t	seed = (1 < argc) ? strtoul (argv[1], NULL, 0) : 1;
+	uint32_t	reads = 0;
+	uint32_t	writes = 0;
+	uint32_t	flushes = 0;
+	uint32_t	evictions = 0;
+	uint32_t	max_wear = 0;
+
+	srand (seed);
+	cached_bus.attach (cached_dev);
+	direct_bus.attach (direct_dev);
+	cached_eep.setup (0x50, cached_bus);
+	direct_eep.setup (0x50, direct_bus);
+	cached_eep.init ();
+	direct_eep.init ();
+	memset (model, 0xFF, sizeof(model));
+
+	for (uint32_t op=0; op<OPS; op++)
+		{
+		uint16_t	addr;
+		size_t		len;
+		uint8_t		n;
+		int			what = rand () % 100;
+
+		if (0 == (op % REBEGIN))
+			{
+			if (SUCCESS != cache.flush ())
+				errors++;
+			evictions += cache.stats.evictions;
+			if (SUCCESS != cache.begin (cached_eep, 1 + ((op / REBEGIN) % EEP_CACHE_PAGES_MAX)))
+				errors++;
+			memset (&cache.stats, 0, sizeof(cache.stats));
+			}
+
+		if (10 > what)									// a whole aligned page: filled without a read
+			{
+			addr = (rand () % ((ADDRESS_MAX + 1) / EEP_PAGE_SIZE)) * EEP_PAGE_SIZE;
+			len = EEP_PAGE_SIZE;
+			}
+		else
+			{
+			addr = rand () % (ADDRESS_MAX + 1);
+			len = 1 + (rand () % OP_LEN_MAX);
+			if ((ADDRESS_MAX + 1) < (addr + len))
+				len = ADDRESS_MAX + 1 - addr;
+			}
+
+		n = marks_set (cache, cached_dev, marked, addr / EEP_PAGE_SIZE, (addr + len - 1) / EEP_PAGE_SIZE);
+		if (53 > what)
+			{
+			for (size_t k=0; k<len; k++)
+				buf[k] = (uint8_t)rand ();
+			memcpy (&model[addr], buf, len);
+			if ((SUCCESS != cache.write (addr, buf, len)) || (SUCCESS != direct_eep.write (addr, buf, len)))
+				errors++;
+			writes++;
+			}
+		else if (97 > what)
+			{
+			if ((SUCCESS != cache.read (addr, buf, len)) || (SUCCESS != direct_eep.read (addr, back, len)))
+				errors++;
+			if (memcmp (buf, &model[addr], len) || memcmp (back, &model[addr], len))
+				{
+				printf ("op %u: read of %u bytes at 0x%04X differs\n", op, (unsigned)len, addr);
+				errors++;
+				}
+			reads++;
+			}
+		else
+			{
+			if (SUCCESS != cache.flush ())
+				errors++;
+			flushes++;
+			}
+		marks_check (cached_dev, marked, n, op);
+		}
+
+	if (SUCCESS != cache.flush ())
+		errors++;
+	evictions += cache.stats.evictions;
+
+	if (memcmp (cached_dev.mem, model, sizeof(model)) || memcmp (direct_dev.mem, model, sizeof(model)))
+		{
+		printf ("array differs from the model after flush()\n");
+		errors++;
+		}
+	for (uint32_t p=0; p<cached_dev.pages (); p++)
+		{
+		if (cached_dev.page_wear[p] > direct_dev.page_wear[p])
+			{
+			printf ("page %u: %u write cycles through the cache, %u without\n", p, cached_dev.page_wear[p], direct_dev.page_wear[p]);
+			errors++;
+			}
+		if (cached_dev.page_wear[p] > max_wear)
+			max_wear = cached_dev.page_wear[p];
+		}
+
+	printf ("seed %u: %u ops (%u reads, %u writes, %u flush() calls), %u evictions\n", seed, OPS, reads, writes, flushes, evictions);
+	printf ("write cycles: %u cached, %u direct (most on one page %u); bus time %.1f ms cached, %.1f ms direct\n",
+		cached_dev.write_cycles, direct_dev.write_cycles, max_wear, cached_bus.now_ns () / 1e6, direct_bus.now_ns () / 1e6);
+	printf ("%s\n", errors ? "FAIL" : "ok");
+	return errors ? 1 : 0;
+	}
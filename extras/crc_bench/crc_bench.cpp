@@ -0,0 +1,105 @@
+//
+// crc_bench.cpp
+//
+// Host micro-benchmark of the CRC kernels in Systronix_M24C32_crc.cpp against the bitwise loops they
+// replace.  Reports bytes per cycle (x86 time stamp counter) and MB/s over a 4 KB buffer, the size of the
+// whole M24C32 array.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/crc_bench/crc_bench.cpp Systronix_M24C32_crc.cpp -o crc_bench && ./crc_bench
+//
+
+#include <Systronix_M24C32_crc.h>
+#include <stdio.h>
+#include <chrono>
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#define		HAVE_TSC
+#endif
+
+#define		BUF_SIZE	4096
+#define		PASSES		2000
+
+static uint8_t	buf[BUF_SIZE];
+
+
+//---------------------------< B I T W I S E   R E F E R E N C E S >------------------------------------------
+
+static uint16_t bit_crc16 (uint16_t crc, const uint8_t* data, size_t len)
+	{
+	while (len--)
+		{
+		crc ^= (uint16_t)(*data++) << 8;
+		for (uint8_t i=0; i<8; i++)
+			crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+		}
+	return crc;
+	}
+
+static uint32_t bit_crc32 (uint32_t crc, const uint8_t* data, size_t len)
+	{
+	crc = ~crc;
+	while (len--)
+		{
+		crc ^= *data++;
+		for (uint8_t i=0; i<8; i++)
+			crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1);
+		}
+	return ~crc;
+	}
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+//
+// time PASSES runs of kernel over buf; the result is accumulated so the work cannot be optimised away
+//
+
+template <typename F> static uint32_t run (const char* name, F kernel)
+	{
+	uint32_t	sink = 0;
+	auto		t0 = std::chrono::steady_clock::now ();
+#if defined (HAVE_TSC)
+	uint64_t	c0 = __rdtsc ();
+#endif
+
+	for (int i=0; i<PASSES; i++)
+		sink += kernel ();
+
+#if defined (HAVE_TSC)
+	uint64_t	cycles = __rdtsc () - c0;
+#endif
+	double		ns = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - t0).count ();
+	double		bytes = (double)BUF_SIZE * PASSES;
+
+#if defined (HAVE_TSC)
+	printf ("%-16s %8.3f bytes/cycle %9.1f MB/s\n", name, bytes / cycles, bytes * 1000.0 / ns);
+#else
+	printf ("%-16s %9.1f MB/s\n", name, bytes * 1000.0 / ns);
+#endif
+	return sink;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (void)
+	{
+	uint32_t	sink = 0;
+
+	for (int i=0; i<BUF_SIZE; i++)
+		buf[i] = (uint8_t)(i * 131 + 7);
+
+	if ((bit_crc16 (0xFFFF, buf, BUF_SIZE) != eep_crc16 (0xFFFF, buf, BUF_SIZE)) || (bit_crc32 (0, buf, BUF_SIZE) != eep_crc32 (0, buf, BUF_SIZE)))
+		{
+		printf ("table and bitwise kernels disagree\n");
+		return 1;
+		}
+
+	sink += run ("crc16 bitwise", [] {return (uint32_t)bit_crc16 (0xFFFF, buf, BUF_SIZE);});
+	sink += run ("crc16 table", [] {return (uint32_t)eep_crc16 (0xFFFF, buf, BUF_SIZE);});
+	sink += run ("crc32 bitwise", [] {return bit_crc32 (0, buf, BUF_SIZE);});
+	sink += run ("crc32 table", [] {return eep_crc32 (0, buf, BUF_SIZE);});
+
+	printf ("(%08X)\n", (unsigned)sink);
+	return 0;
+	}
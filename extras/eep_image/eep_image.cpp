@@ -0,0 +1,425 @@
+//
+// eep_image.cpp
+//
+// Host compiler for the assembly .ini files read by examples/mux_ini_loader_SD: checks an .ini file with the
+// loader's rules and writes the eeprom image that the loader would have written, followed by a CRC-32 of the
+// image (little endian, as crc_write() stores it).  The output goes to an SD card (or anywhere else) and is
+// programmed with Systronix_M24C32_prog, which checks the CRC-32 as the image streams in and verifies the
+// eeprom against it afterward.  Images are made and checked once, on a PC, instead of on every board.
+//
+//		0x0000 - 0x001F:	assembly page
+//		0x0020 - 0x007F:	sensor pages 1 - 3; a page with no [sensor n] section is 0xFF
+//		0x0080 - 0x0083:	CRC-32 of 0x0000 - 0x007F
+//
+// Differences from the loader: assembly type may be any of the known assemblies (MUX7, TMP275), not only MUX7;
+// a sensor section's type is stored in its own page (the loader stores type3 in page 2).
+//
+// Errors are reported with their line numbers; nothing is written when there are any.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/eep_image/eep_image.cpp Systronix_M24C32_crc.cpp -o eep_image
+//		./eep_image examples/mux_ini_loader_SD/mux_2v0.ini mux_2v0.bin
+//
+
+#include <Systronix_M24C32_crc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define		PAGE_SIZE			32
+#define		SENSOR_PAGES		3
+#define		DATA_LEN			(PAGE_SIZE * (1 + SENSOR_PAGES))
+#define		IMAGE_LEN			(DATA_LEN + 4)
+
+#define		NONE				0						// section headings
+#define		ASSEMBLY			1
+#define		SENSOR1				2						// SENSOR1 + n - 1 is [sensor n]
+
+static uint8_t	image[IMAGE_LEN];						// page 0 at image[0]; page n at image[PAGE_SIZE * n]
+static uint16_t	line_num;
+static uint16_t	total_errs;
+static uint16_t	warn_cnt;
+
+static const char*	valid_assy_str [] = {"MUX7", "TMP275"};
+static const char*	valid_type_str [] = {"MUX7", "TMP275", "HDC1080", "MS8607PT", "MS8607H"};
+
+
+//---------------------------< E R R _ M S G >----------------------------------------------------------------
+
+static void err_msg (const char* msg)
+	{
+	fprintf (stderr, "%d: error: %s\n", line_num, msg);
+	total_errs++;
+	}
+
+
+//---------------------------< T R I M >----------------------------------------------------------------------
+//
+// leading and trailing whitespace
+//
+
+static char* trim (char* str)
+	{
+	char*	end;
+
+	while (isspace ((unsigned char)*str))
+		str++;
+	end = str + strlen (str);
+	while ((end > str) && isspace ((unsigned char)end[-1]))
+		*--end = '\0';
+	return str;
+	}
+
+
+//---------------------------< K E Y _ N O R M A L I Z E >----------------------------------------------------
+//
+// as the loader: lowercase; each run of whitespace becomes '_' ('manuf date' becomes 'manuf_date')
+//
+
+static void key_normalize (char* key)
+	{
+	char*	out = key;
+
+	for (char* in=key; *in; in++)
+		{
+		if (isspace ((unsigned char)*in))
+			{
+			if ('_' != out[-1])
+				*out++ = '_';
+			}
+		else
+			*out++ = (char)tolower ((unsigned char)*in);
+		}
+	*out = '\0';
+	}
+
+
+//---------------------------< S T R _ T O _ U P P E R >------------------------------------------------------
+
+static void str_to_upper (char* str)
+	{
+	for (; *str; str++)
+		*str = (char)toupper ((unsigned char)*str);
+	}
+
+
+//---------------------------< I S O _ D A T E _ G E T >------------------------------------------------------
+//
+// yyyy-mm-dd to a time_t at midnight, 1970 - 2105
+//
+
+static uint8_t iso_date_get (const char* value, uint32_t* date)
+	{
+	static const uint8_t	days_in [] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	char*		end;
+	long		year;
+	long		month;
+	long		day;
+	uint32_t	days = 0;
+	boolean		leap;
+
+	year = strtol (value, &end, 10);
+	if ('-' != *end)
+		return FAIL;
+	month = strtol (end + 1, &end, 10);
+	if ('-' != *end)
+		return FAIL;
+	day = strtol (end + 1, &end, 10);
+	if ('\0' != *end)
+		return FAIL;
+
+	leap = (0 == (year % 4)) && ((0 != (year % 100)) || (0 == (year % 400)));
+	if ((1970 > year) || (2105 < year) || (1 > month) || (12 < month) || (1 > day) ||
+			(day > (days_in[month - 1] + ((2 == month) && leap))))
+		return FAIL;
+
+	for (long y=1970; y<year; y++)
+		days += ((0 == (y % 4)) && ((0 != (y % 100)) || (0 == (y % 400)))) ? 366 : 365;
+	for (long m=1; m<month; m++)
+		days += days_in[m - 1] + ((2 == m) && leap);
+	days += day - 1;
+
+	*date = days * 86400UL;
+	return SUCCESS;
+	}
+
+
+//---------------------------< R E V I S I O N _ G E T >------------------------------------------------------
+//
+// MM.mm (one or two digits each) to 0xMMmm; '2.03' is 0x0203
+//
+
+static uint8_t revision_get (const char* value, uint16_t* rev)
+	{
+	char*	end;
+	long	major;
+	long	minor;
+
+	if (!isdigit ((unsigned char)*value))
+		return FAIL;
+	major = strtol (value, &end, 10);
+	if (('.' != *end) || (2 < (end - value)) || !isdigit ((unsigned char)end[1]))
+		return FAIL;
+	value = end + 1;
+	minor = strtol (value, &end, 10);
+	if (('\0' != *end) || (2 < (end - value)) || (99 < major) || (99 < minor))
+		return FAIL;
+
+	*rev = (uint16_t)((major << 8) | minor);
+	return SUCCESS;
+	}
+
+
+//---------------------------< C H E C K _ A S S E M B L Y >--------------------------------------------------
+
+static void check_assembly (const char* key, char* value)
+	{
+	uint8_t*	page = image;
+	uint32_t	date;
+	uint16_t	rev;
+
+	if (16 < strlen (value))
+		err_msg ("value string too long");
+
+	else if (!strcmp (key, "type"))
+		{
+		str_to_upper (value);
+		for (uint8_t i=0; i<sizeof(valid_assy_str)/sizeof(valid_assy_str[0]); i++)
+			if (!strcmp (value, valid_assy_str[i]))
+				{
+				memset (page, '\0', 16);
+				strcpy ((char*)page, value);
+				return;
+				}
+		err_msg ("invalid assembly type; expected MUX7 or TMP275");
+		}
+
+	else if (!strcmp (key, "revision"))
+		{
+		if (SUCCESS != revision_get (value, &rev))
+			err_msg ("invalid revision");
+		else
+			{
+			page[0x18] = (uint8_t)rev;
+			page[0x19] = (uint8_t)(rev >> 8);
+			}
+		}
+
+	else if (!strcmp (key, "manuf_date"))
+		{
+		if (SUCCESS != iso_date_get (value, &date))
+			err_msg ("invalid manuf date");
+		else
+			for (uint8_t i=0; i<4; i++)
+				page[0x10 + i] = (uint8_t)(date >> (8 * i));
+		}
+
+	else if (!strcmp (key, "ports"))
+		{
+		if ((1 != strlen (value)) || ('1' > *value) || ('8' < *value))
+			err_msg ("invalid port value");
+		else
+			page[0x1A] = *value - '0';
+		}
+
+	else
+		err_msg ("unrecognized setting");
+	}
+
+
+//---------------------------< C H E C K _ S E N S O R >------------------------------------------------------
+
+static void check_sensor (const char* key, char* value, uint8_t index)
+	{
+	uint8_t*	page = &image[PAGE_SIZE * index];
+	char		match_key[16];
+
+	if ('\0' == *value)
+		err_msg ("empty setting");
+
+	else if (16 < strlen (value))
+		err_msg ("value string too long");
+
+	else if (strstr (key, "type"))
+		{
+		snprintf (match_key, sizeof(match_key), "type%d", index);
+		if (strcmp (match_key, key))
+			{
+			err_msg ("invalid type key index");
+			return;
+			}
+		str_to_upper (value);
+		for (uint8_t i=0; i<sizeof(valid_type_str)/sizeof(valid_type_str[0]); i++)
+			if (!strcmp (value, valid_type_str[i]))
+				{
+				memset (page, '\0', 16);
+				strcpy ((char*)page, value);
+				return;
+				}
+		err_msg ("unknown type");
+		}
+
+	else if (strstr (key, "address"))
+		{
+		snprintf (match_key, sizeof(match_key), "address%d", index);
+		if (strcmp (match_key, key))
+			err_msg ("invalid address key index");
+		else if (isdigit ((unsigned char)value[0]) && isxdigit ((unsigned char)value[1]) && ('\0' == value[2]))
+			page[16] = (page[16] & 0x80) | (((uint8_t)strtol (value, NULL, 16)) & 0x7F);	// keep the fixed bit
+		else
+			err_msg ("invalid sensor address");
+		}
+
+	else if (strstr (key, "fixed"))
+		{
+		snprintf (match_key, sizeof(match_key), "fixed%d", index);
+		if (strcmp (match_key, key))
+			err_msg ("invalid fixed key index");
+		else if (!strcmp ((char*)image, "MUX7"))			// MUX7 on-board sensors are always at fixed addresses
+			{
+			fprintf (stderr, "%d: warning: %s ignored\n", line_num, key);
+			warn_cnt++;
+			}
+		else
+			{
+			str_to_upper (value);
+			if (!strcmp (value, "NO"))
+				page[16] |= 0x80;							// not an absolute address so set MSB
+			else if (strcmp (value, "YES"))
+				err_msg ("invalid fixed setting");
+			}
+		}
+
+	else
+		err_msg ("unrecognized setting");
+	}
+
+
+//---------------------------< C O M P I L E >----------------------------------------------------------------
+//
+// one .ini file into image[]; returns the error count
+//
+
+static uint16_t compile (FILE* in)
+	{
+	char		line[256];
+	char*		ln;
+	char*		value;
+	uint8_t		heading = NONE;
+	boolean		seen[1 + SENSOR_PAGES] = {false};
+	uint32_t	crc;
+
+	memset (image, 0, PAGE_SIZE);
+	while (fgets (line, sizeof(line), in))
+		{
+		line_num++;
+		ln = trim (line);
+		if (('\0' == *ln) || ('#' == *ln))
+			continue;									// blank or comment
+
+		if (strchr (ln, '#'))
+			{
+			err_msg ("misplaced comment");				// comments must be on separate lines
+			continue;
+			}
+
+		value = strchr (ln, '=');
+		if (NULL == value)
+			{
+			if (!strcmp (ln, "[assembly]"))
+				heading = ASSEMBLY;
+			else if (!strncmp (ln, "[sensor ", 8) && ('1' <= ln[8]) && (('0' + SENSOR_PAGES) >= ln[8]) && !strcmp (&ln[9], "]"))
+				heading = SENSOR1 + ln[8] - '1';
+			else
+				{
+				err_msg ("not key/value pair");
+				continue;
+				}
+			seen[heading - ASSEMBLY] = true;
+			continue;
+			}
+
+		*value++ = '\0';
+		ln = trim (ln);
+		key_normalize (ln);
+		value = trim (value);
+
+		if (ASSEMBLY == heading)
+			check_assembly (ln, value);
+		else if (NONE != heading)
+			check_sensor (ln, value, heading - ASSEMBLY);
+		else
+			err_msg ("setting outside of a section");
+		}
+
+	if ('\0' == image[0])
+		{
+		fprintf (stderr, "error: missing [assembly] definition\n");
+		total_errs++;
+		}
+
+	for (uint8_t n=1; n<=SENSOR_PAGES; n++)
+		{
+		if (!seen[n] || ('\0' == image[PAGE_SIZE * n]))
+			{
+			if (seen[n])
+				{
+				fprintf (stderr, "error: [sensor %d] has no type%d\n", n, n);
+				total_errs++;
+				}
+			memset (&image[PAGE_SIZE * n], 0xFF, PAGE_SIZE);	// erased, as the loader leaves it
+			}
+		else if ((1 < n) && !seen[n - 1])
+			{
+			fprintf (stderr, "error: missing [sensor %d] definition\n", n - 1);
+			total_errs++;
+			}
+		}
+
+	crc = eep_crc32 (0, image, DATA_LEN);
+	for (uint8_t i=0; i<4; i++)
+		image[DATA_LEN + i] = (uint8_t)(crc >> (8 * i));
+	return total_errs;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	FILE*	in;
+	FILE*	out;
+
+	if (3 != argc)
+		{
+		fprintf (stderr, "usage: %s in.ini out.bin\n", argv[0]);
+		return 2;
+		}
+
+	in = fopen (argv[1], "r");
+	if (NULL == in)
+		{
+		perror (argv[1]);
+		return 2;
+		}
+	compile (in);
+	fclose (in);
+
+	if (total_errs)
+		{
+		fprintf (stderr, "%s: %d error(s); %d warning(s); image not written\n", argv[1], total_errs, warn_cnt);
+		return 1;
+		}
+
+	out = fopen (argv[2], "wb");
+	if ((NULL == out) || (IMAGE_LEN != fwrite (image, 1, IMAGE_LEN, out)) || fclose (out))
+		{
+		perror (argv[2]);
+		return 2;
+		}
+
+	printf ("%s: %d bytes; crc-32 0x%08X; %d warning(s)\n", argv[2], IMAGE_LEN,
+		(unsigned)eep_crc32 (0, image, DATA_LEN), warn_cnt);
+	return 0;
+	}
@@ -0,0 +1,105 @@
+//
+// fram_bench.cpp
+//
+// The same access patterns through Systronix_M24C32_nvram on a simulated M24C32 eeprom (tW 5ms) and a
+// simulated MB85RC256V FRAM, both on one bus at 400kHz:
+//		4 KB write		one write() of 4096 bytes at 0
+//		4 KB read		one read() of the same 4096 bytes
+//		scattered		100 typed write()s of a uint32_t, 37 bytes apart
+//
+// It reports simulated time and transactions for each.  Everything written is read back and compared; any
+// mismatch exits with status 1.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/fram_bench/fram_bench.cpp Systronix_M24C32*.cpp -o fram_bench && ./fram_bench
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_fram.h>
+#include <Systronix_M24C32_sim.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define		IMAGE_SIZE		4096
+#define		SCATTERED		100
+#define		STRIDE			37
+
+static uint8_t		image[IMAGE_SIZE];
+static uint8_t		back[IMAGE_SIZE];
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+//
+// every pattern on nv; returns false on a mismatch
+//
+
+static bool run (Systronix_M24C32_nvram& nv, Systronix_M24C32_sim& bus, const char* name)
+	{
+	uint64_t	t0;
+	double		write_ms;
+	double		read_ms;
+	double		scattered_ms;
+	uint32_t	write_tx;
+	uint32_t	read_tx;
+	uint32_t	scattered_tx;
+	uint32_t	value;
+	bool		ok;
+
+	bus.stats_clear ();
+	t0 = bus.now_ns ();
+	ok = (SUCCESS == nv.write (0, image, IMAGE_SIZE));
+	write_ms = (bus.now_ns () - t0) / 1e6;
+	write_tx = bus.stats.transactions;
+
+	bus.advance (10000);								// let the last write cycle end
+	bus.stats_clear ();
+	t0 = bus.now_ns ();
+	ok = ok && (SUCCESS == nv.read (0, back, IMAGE_SIZE)) && !memcmp (back, image, IMAGE_SIZE);
+	read_ms = (bus.now_ns () - t0) / 1e6;
+	read_tx = bus.stats.transactions;
+
+	bus.stats_clear ();
+	t0 = bus.now_ns ();
+	for (uint32_t i=0; i<SCATTERED; i++)
+		{
+		value = i * 7;
+		ok = ok && (SUCCESS == nv.write (i * STRIDE, value));
+		}
+	scattered_ms = (bus.now_ns () - t0) / 1e6;
+	scattered_tx = bus.stats.transactions;
+
+	for (uint32_t i=0; i<SCATTERED; i++)
+		ok = ok && (SUCCESS == nv.read (i * STRIDE, value)) && (value == (i * 7));
+
+	printf ("%-6s  4 KB write %6.1f ms %5u transactions   4 KB read %5.1f ms %3u transactions   %u scattered uint32_t writes %6.1f ms %4u transactions  %s\n",
+		name, write_ms, write_tx, read_ms, read_tx, SCATTERED, scattered_ms, scattered_tx, ok ? "ok" : "MISMATCH");
+	return ok;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (void)
+	{
+	Systronix_M24C32_sim		bus (400000);
+	Systronix_M24C32_sim_device	dev (0x50);
+	Systronix_M24C32_sim_fram	fram_dev (0x51);
+	Systronix_M24C32			eep;
+	Systronix_M24C32_fram		fram;
+	bool	ok;
+
+	srand (1);
+	for (int i=0; i<IMAGE_SIZE; i++)
+		image[i] = (uint8_t)rand ();
+
+	bus.attach (dev);
+	bus.attach (fram_dev);
+	eep.setup (0x50, bus);
+	eep.init ();
+	fram.setup (0x51, bus);
+	fram.init ();
+
+	ok = run (eep, bus, "eeprom");
+	ok = run (fram, bus, "FRAM") && ok;
+	return ok ? 0 : 1;
+	}
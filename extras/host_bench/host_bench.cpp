@@ -0,0 +1,348 @@
+//
+// host_bench.cpp
+//
+// Benchmark of every Systronix_M24C32 access pattern against the simulated bus and device at 100kHz, 400kHz,
+// and 1MHz.  For each pattern and rate it reports simulated time, transactions, and bytes on the bus per
+// payload byte.  All figures come from simulated time so they are exact and repeatable on any host.
+//
+// With a baseline file the run fails (exit status 1) when any figure is more than the tolerance (default 2%)
+// worse than the baseline; improvements are reported so that the baseline can be refreshed.
+//
+// build from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/host_bench/host_bench.cpp Systronix_M24C32*.cpp -o host_bench
+//
+// run:
+//		./host_bench										print the results
+//		./host_bench extras/host_bench/baseline.json		compare against the baseline; fail on regression
+//		./host_bench -w extras/host_bench/baseline.json		write a new baseline
+//		./host_bench -t 5 extras/host_bench/baseline.json	5% tolerance
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_sim.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define		RESULTS_MAX		64
+
+
+//---------------------------< R E S U L T >------------------------------------------------------------------
+
+struct result
+	{
+	char		name[48];								// pattern@rate
+	double		time_us;								// simulated time per operation
+	double		transactions;							// per operation
+	double		bus_per_payload;						// bus bytes per payload byte
+	};
+
+static struct result	results[RESULTS_MAX];
+static uint8_t			result_count;
+
+static Systronix_M24C32_sim*		bus;
+static Systronix_M24C32_sim_device*	dev;
+static Systronix_M24C32*			dut;
+static uint8_t			image[ADDRESS_MAX + 1];
+
+
+//---------------------------< P A T T E R N S >--------------------------------------------------------------
+//
+// Each runs ops operations and returns the payload bytes moved.  Writes are back to back so every write after
+// the first meets the previous write's tW, as a real burst of writes would.
+//
+
+#define		OPS			64
+
+static size_t byte_write (void)
+	{
+	for (uint16_t i=0; i<OPS; i++)
+		{
+		dut->set_addr16 (i * 37);
+		dut->control.wr_byte = (uint8_t)i;
+		dut->byte_write ();
+		}
+	return OPS;
+	}
+
+static size_t int16_write (void)
+	{
+	for (uint16_t i=0; i<OPS; i++)
+		{
+		dut->set_addr16 (i * 38);
+		dut->control.wr_int16 = i;
+		dut->int16_write ();
+		}
+	return OPS * 2;
+	}
+
+static size_t int32_write (void)
+	{
+	for (uint16_t i=0; i<OPS; i++)
+		{
+		dut->set_addr16 (i * 40);
+		dut->control.wr_int32 = i;
+		dut->int32_write ();
+		}
+	return OPS * 4;
+	}
+
+static size_t page_write (void)
+	{
+	for (uint16_t i=0; i<OPS; i++)
+		{
+		dut->set_addr16 (i * EEP_PAGE_SIZE);
+		dut->control.wr_buf_ptr = &image[i * EEP_PAGE_SIZE];
+		dut->control.rd_wr_len = EEP_PAGE_SIZE;
+		dut->page_write ();
+		}
+	return OPS * EEP_PAGE_SIZE;
+	}
+
+static size_t byte_read (void)
+	{
+	for (uint16_t i=0; i<OPS; i++)
+		{
+		dut->set_addr16 (i * 37);
+		dut->byte_read ();
+		}
+	return OPS;
+	}
+
+static size_t int16_read (void)
+	{
+	for (uint16_t i=0; i<OPS; i++)
+		{
+		dut->set_addr16 (i * 38);
+		dut->int16_read ();
+		}
+	return OPS * 2;
+	}
+
+static size_t int32_read (void)
+	{
+	for (uint16_t i=0; i<OPS; i++)
+		{
+		dut->set_addr16 (i * 40);
+		dut->int32_read ();
+		}
+	return OPS * 4;
+	}
+
+static size_t page_read (void)
+	{
+	uint8_t	buf[EEP_PAGE_SIZE];
+
+	for (uint16_t i=0; i<OPS; i++)
+		{
+		dut->set_addr16 (i * EEP_PAGE_SIZE);
+		dut->control.rd_buf_ptr = buf;
+		dut->control.rd_wr_len = EEP_PAGE_SIZE;
+		dut->page_read ();
+		}
+	return OPS * EEP_PAGE_SIZE;
+	}
+
+static size_t current_sweep (void)						// one byte_read() to set the pointer, then the rest of a 4 KB sweep
+	{
+	dut->set_addr16 (0);
+	dut->byte_read ();
+	for (uint16_t i=1; i<=ADDRESS_MAX; i++)
+		dut->current_address_read ();
+	return ADDRESS_MAX + 1;
+	}
+
+static size_t dump (void)
+	{
+	static uint8_t	buf[ADDRESS_MAX + 1];
+
+	dut->read (0, buf, sizeof(buf));
+	return sizeof(buf);
+	}
+
+static size_t program (void)
+	{
+	dut->write (0, image, sizeof(image));
+	return sizeof(image);
+	}
+
+static const struct
+	{
+	const char*	name;
+	size_t		(*run) (void);
+	uint16_t	ops;									// operations per run; results are per operation
+	} patterns[] =
+	{
+	{"byte_write", byte_write, OPS},
+	{"int16_write", int16_write, OPS},
+	{"int32_write", int32_write, OPS},
+	{"page_write", page_write, OPS},
+	{"byte_read", byte_read, OPS},
+	{"int16_read", int16_read, OPS},
+	{"int32_read", int32_read, OPS},
+	{"page_read", page_read, OPS},
+	{"current_sweep", current_sweep, 1},
+	{"dump", dump, 1},
+	{"program", program, 1},
+	};
+
+
+//---------------------------< M E A S U R E >----------------------------------------------------------------
+//
+// run every pattern at hz, each on a freshly erased device with no write cycle pending
+//
+
+static void measure (uint32_t hz)
+	{
+	Systronix_M24C32_sim		sim (hz);
+	Systronix_M24C32_sim_device	part (0x50);
+	Systronix_M24C32			m24c32;
+	size_t		payload;
+	uint64_t	t0;
+
+	bus = &sim;
+	dev = &part;
+	dut = &m24c32;
+	sim.attach (part);
+	m24c32.setup (0x50, sim);
+	m24c32.init ();
+
+	for (uint8_t p=0; p<(sizeof(patterns)/sizeof(patterns[0])); p++)
+		{
+		part.erase ();
+		sim.advance (2 * EEP_TW_MS * 1000);				// let any write cycle finish
+		sim.stats_clear ();
+		t0 = sim.now_ns ();
+
+		payload = patterns[p].run ();
+
+		struct result*	r = &results[result_count++];
+		snprintf (r->name, sizeof(r->name), "%s@%lu", patterns[p].name, (unsigned long)hz);
+		r->time_us = (sim.now_ns () - t0) / 1000.0 / patterns[p].ops;
+		r->transactions = (double)sim.stats.transactions / patterns[p].ops;
+		r->bus_per_payload = (double)sim.stats.bytes / payload;
+		}
+	}
+
+
+//---------------------------< B A S E L I N E >--------------------------------------------------------------
+//
+// The baseline is JSON with one result per line, as written by baseline_write(); baseline_check() reads it
+// back line by line.
+//
+
+static int baseline_write (const char* path)
+	{
+	FILE*	f = fopen (path, "w");
+
+	if (!f)
+		{
+		perror (path);
+		return 1;
+		}
+
+	fprintf (f, "{\n");
+	for (uint8_t i=0; i<result_count; i++)
+		fprintf (f, "\t\"%s\": {\"time_us\": %.3f, \"transactions\": %.3f, \"bus_per_payload\": %.4f}%s\n",
+			results[i].name, results[i].time_us, results[i].transactions, results[i].bus_per_payload, (i + 1 < result_count) ? "," : "");
+	fprintf (f, "}\n");
+	fclose (f);
+	printf ("baseline written to %s\n", path);
+	return 0;
+	}
+
+
+static int worse (const char* name, const char* what, double now, double then, double tolerance)
+	{
+	if (now > then * (1.0 + tolerance / 100.0))
+		{
+		printf ("REGRESSION %-24s %-16s %10.3f (baseline %.3f)\n", name, what, now, then);
+		return 1;
+		}
+	if (now < then * (1.0 - tolerance / 100.0))
+		printf ("improved   %-24s %-16s %10.3f (baseline %.3f)\n", name, what, now, then);
+	return 0;
+	}
+
+
+static int baseline_check (const char* path, double tolerance)
+	{
+	FILE*	f = fopen (path, "r");
+	char	line[256];
+	char	name[48];
+	double	time_us;
+	double	transactions;
+	double	bus_per_payload;
+	int		failures = 0;
+	int		found = 0;
+
+	if (!f)
+		{
+		perror (path);
+		return 1;
+		}
+
+	while (fgets (line, sizeof(line), f))
+		{
+		if (4 != sscanf (line, " \"%47[^\"]\": {\"time_us\": %lf, \"transactions\": %lf, \"bus_per_payload\": %lf",
+				name, &time_us, &transactions, &bus_per_payload))
+			continue;
+
+		for (uint8_t i=0; i<result_count; i++)
+			{
+			if (strcmp (name, results[i].name))
+				continue;
+			found++;
+			failures += worse (name, "time_us", results[i].time_us, time_us, tolerance);
+			failures += worse (name, "transactions", results[i].transactions, transactions, tolerance);
+			failures += worse (name, "bus_per_payload", results[i].bus_per_payload, bus_per_payload, tolerance);
+			}
+		}
+	fclose (f);
+
+	if (found != result_count)
+		{
+		printf ("baseline %s has %d of %d results; rewrite it with -w\n", path, found, result_count);
+		return 1;
+		}
+
+	printf ("%s: %d regression(s) at %.1f%% tolerance\n", path, failures, tolerance);
+	return failures ? 1 : 0;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	static const uint32_t	rates[] = {100000, 400000, 1000000};
+	const char*	path = NULL;
+	boolean		write_baseline = false;
+	double		tolerance = 2.0;
+
+	for (int i=1; i<argc; i++)
+		{
+		if (!strcmp (argv[i], "-w"))
+			write_baseline = true;
+		else if (!strcmp (argv[i], "-t") && (i + 1 < argc))
+			tolerance = atof (argv[++i]);
+		else
+			path = argv[i];
+		}
+
+	for (size_t i=0; i<sizeof(image); i++)
+		image[i] = (uint8_t)((i * 7) ^ (i >> 5));
+
+	for (uint8_t r=0; r<(sizeof(rates)/sizeof(rates[0])); r++)
+		measure (rates[r]);
+
+	printf ("%-24s %12s %14s %16s\n", "pattern@rate", "time_us/op", "transactions/op", "bus/payload byte");
+	for (uint8_t i=0; i<result_count; i++)
+		printf ("%-24s %12.1f %14.2f %16.2f\n", results[i].name, results[i].time_us, results[i].transactions, results[i].bus_per_payload);
+
+	if (!path)
+		return 0;
+	if (write_baseline)
+		return baseline_write (path);
+	return baseline_check (path, tolerance);
+	}
@@ -0,0 +1,175 @@
+//
+// inventory_bench.cpp
+//
+// Boot-time board inventory on the simulator at 400kHz: four candidate muxes at 0x70 - 0x73, of which three are
+// fitted, with 16 boards (an M24C32 at 0x57 on each) spread over their ports, and an MB85RC256V FRAM at 0x50
+// that keeps the inventory hashes.  It times:
+//		byte-wise				the loader's way: for each port of each mux, a control write, init(), and a
+//								byte_read() and 31 current_address_read()s of the identity page
+//		cold boot				Systronix_M24C32_inventory scan() with no saved hashes; every board is parsed
+//		warm boot				scan() with the hashes saved by the cold boot; nothing has changed
+//		1 changed, 1 removed	one board re-programmed and one unplugged since the warm boot
+//
+// Each inventory time runs from map.init() through load(), scan(), and save().  The board counts, the boards
+// parsed, and the states scan() reports are checked against what was set up; any difference exits with
+// status 1.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/inventory_bench/inventory_bench.cpp Systronix_M24C32*.cpp -o inventory_bench && ./inventory_bench
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_fram.h>
+#include <Systronix_M24C32_inventory.h>
+#include <Systronix_M24C32_sim.h>
+#include <stdio.h>
+
+#define		BOARDS			16
+#define		HASH_ADDR		0x100					// FRAM address of the saved hashes
+
+static uint32_t		parsed;
+
+
+//---------------------------< P A R S E >--------------------------------------------------------------------
+//
+// stands in for the loader's identity page parser; only counted
+//
+
+static void parse (uint8_t node, const uint8_t* page)
+	{
+	(void)node;
+	(void)page;
+	parsed++;
+	}
+
+
+//---------------------------< B Y T E _ W I S E >------------------------------------------------------------
+//
+// returns the boards found
+//
+
+static uint8_t byte_wise (Systronix_M24C32_sim& bus)
+	{
+	Systronix_M24C32	eep;
+	uint8_t		page[EEP_INV_PAGE_LEN];
+	uint8_t		found = 0;
+	uint64_t	t0;
+
+	eep.setup (0x57, bus);
+	parsed = 0;
+	bus.stats_clear ();
+	t0 = bus.now_ns ();
+	for (uint8_t mux=0x70; mux<=0x73; mux++)
+		{
+		for (uint8_t port=0; port<8; port++)
+			{
+			bus.beginTransmission (mux);
+			bus.write (1 << port);
+			if (SUCCESS != bus.endTransmission ())
+				break;									// mux not fitted
+			if (SUCCESS != eep.init ())
+				continue;								// no board on this port
+			eep.set_addr16 (EEP_INV_PAGE_ADDR);
+			eep.byte_read ();
+			page[0] = eep.control.rd_byte;
+			for (uint8_t i=1; i<EEP_INV_PAGE_LEN; i++)
+				{
+				eep.current_address_read ();
+				page[i] = eep.control.rd_byte;
+				}
+			found++;
+			parse (0, page);
+			}
+		bus.beginTransmission (mux);
+		bus.write (0);
+		bus.endTransmission ();
+		}
+
+	printf ("%-22s %2u boards  %6.2f ms  %4u transactions  %2u parsed\n", "byte-wise", found,
+		(bus.now_ns () - t0) / 1e6, bus.stats.transactions, parsed);
+	return found;
+	}
+
+
+//---------------------------< B O O T >----------------------------------------------------------------------
+//
+// one boot with a fresh map and inventory, as after a reset; returns false when the counts are not as expected
+//
+
+static bool boot (Systronix_M24C32_sim& bus, Systronix_M24C32_fram& fram, const char* name, uint8_t boards, uint8_t changed, uint8_t removed)
+	{
+	Systronix_M24C32			eep;
+	Systronix_M24C32_mux		map;
+	Systronix_M24C32_inventory	inventory;
+	uint8_t		present;
+	uint8_t		n[4] = {0, 0, 0, 0};					// nodes by state
+	uint64_t	t0;
+
+	eep.setup (0x57, bus);
+	map.setup (bus);
+	inventory.setup (map);
+	for (uint8_t mux=0x70; mux<=0x73; mux++)
+		inventory.candidates (mux, eep);
+
+	parsed = 0;
+	bus.stats_clear ();
+	t0 = bus.now_ns ();
+	map.init ();
+	inventory.load (fram, HASH_ADDR);
+	present = inventory.scan (parse);
+	inventory.save (fram, HASH_ADDR);
+
+	for (uint8_t i=0; i<map.nodes (); i++)
+		n[inventory.state (i)]++;
+
+	printf ("%-22s %2u boards  %6.2f ms  %4u transactions  %2u parsed  (same %u, changed %u, removed %u)\n", name,
+		present, (bus.now_ns () - t0) / 1e6, bus.stats.transactions, parsed, n[EEP_INV_SAME], n[EEP_INV_CHANGED],
+		n[EEP_INV_REMOVED]);
+	return (boards == present) && (changed == parsed) && (changed == n[EEP_INV_CHANGED]) && (removed == n[EEP_INV_REMOVED]);
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (void)
+	{
+	static const uint8_t	ports[3][8] = {{0, 1, 2, 3, 4, 5, 6, 7}, {0, 1, 2, 3, 4, 5}, {0, 3}};
+	static const uint8_t	fitted[3] = {8, 6, 2};
+	Systronix_M24C32_sim		bus (400000);
+	Systronix_M24C32_sim_mux	mux[3] = {0x70, 0x71, 0x72};
+	Systronix_M24C32_sim_fram	fram_dev (0x50);
+	Systronix_M24C32_sim_device*	board[BOARDS];
+	Systronix_M24C32_fram		fram;
+	uint8_t		k = 0;
+	bool		ok;
+
+	for (uint8_t m=0; m<3; m++)
+		bus.attach (mux[m]);
+	bus.attach (fram_dev);
+	fram.setup (0x50, bus);
+	fram.init ();
+
+	for (uint8_t m=0; m<3; m++)
+		for (uint8_t p=0; p<fitted[m]; p++)
+			{
+			board[k] = new Systronix_M24C32_sim_device (0x57);
+			mux[m].attach (ports[m][p], *board[k]);
+			snprintf ((char*)board[k]->mem, 16, "%s", m ? "TMP275" : "MUX7");	// assembly name
+			board[k]->mem[0x18] = k;							// revision
+			board[k]->mem[0x19] = 2;
+			board[k]->mem[0x1A] = 8;
+			k++;
+			}
+
+	ok = (BOARDS == byte_wise (bus));
+	ok = boot (bus, fram, "cold boot", BOARDS, BOARDS, 0) && ok;
+	ok = boot (bus, fram, "warm boot", BOARDS, 0, 0) && ok;
+
+	board[5]->mem[0x18] = 99;								// re-programmed
+	mux[1].detach (5, *board[13]);							// unplugged
+	ok = boot (bus, fram, "1 changed, 1 removed", BOARDS - 1, 1, 1) && ok;
+
+	for (uint8_t i=0; i<BOARDS; i++)
+		delete board[i];
+	return ok ? 0 : 1;
+	}
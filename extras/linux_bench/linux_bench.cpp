@@ -0,0 +1,222 @@
+//
+// linux_bench.cpp
+//
+// Benchmark of the Linux i2c-dev transport (Systronix_M24C32_linux) with the simulator standing in for the
+// kernel: sim_i2c_dev overrides the transport's system calls so that each I2C_RDWR ioctl is played onto a
+// Systronix_M24C32_sim bus (its messages in order, a repeated start between them, STOP after the last) and
+// sleeps and the clock run on simulated time.  The driver above it is unmodified.
+//
+// For each access pattern it reports system calls per KB of payload for:
+//		rdwr		this transport: one I2C_RDWR per transaction; ack polls sleep poll_us after a nack
+//		rdwr spin	the same with poll_interval_set (0)
+//		read/write	plain read() / write() on i2c-dev: one system call per bus transaction, so a random read
+//					is two (with a STOP, not a repeated start, between them) and every ack poll is one
+//
+// Every read is checked against the simulated array; any mismatch exits with status 1.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/linux_bench/linux_bench.cpp Systronix_M24C32*.cpp -o linux_bench && ./linux_bench
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_linux.h>
+#include <Systronix_M24C32_sim.h>
+#include <linux/i2c-dev.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint32_t	bad;
+
+
+//---------------------------< S I M _ I 2 C _ D E V >--------------------------------------------------------
+//
+// the transport with its system calls routed to the simulator
+//
+
+class sim_i2c_dev : public Systronix_M24C32_linux
+	{
+	protected:
+		Systronix_M24C32_sim*	_sim;
+
+		int sys_ioctl (unsigned long request, void* arg)
+			{
+			struct i2c_rdwr_ioctl_data*	data = (struct i2c_rdwr_ioctl_data*)arg;
+
+			if ((I2C_RDWR != request) || (I2C_RDWR_IOCTL_MAX_MSGS < data->nmsgs))
+				{
+				errno = EINVAL;
+				return -1;
+				}
+
+			for (uint32_t i=0; i<data->nmsgs; i++)
+				{
+				struct i2c_msg*	m = &data->msgs[i];
+				i2c_stop		stop = ((i + 1) == data->nmsgs) ? I2C_STOP : I2C_NOSTOP;
+
+				if (m->flags & I2C_M_RD)
+					{
+					if (m->len != _sim->requestFrom ((uint8_t)m->addr, m->len, stop))
+						{
+						errno = ENXIO;
+						return -1;
+						}
+					_sim->read (m->buf, m->len);
+					}
+				else
+					{
+					_sim->beginTransmission ((uint8_t)m->addr);
+					_sim->write (m->buf, m->len);
+					if (SUCCESS != _sim->endTransmission (stop))
+						{
+						errno = ENXIO;
+						return -1;
+						}
+					}
+				}
+			return data->nmsgs;
+			}
+
+		void sys_sleep_us (uint32_t us) {_sim->advance (us);}
+		uint64_t sys_now_ns (void) {return _sim->now_ns ();}
+
+	public:
+		sim_i2c_dev (Systronix_M24C32_sim& sim) : _sim (&sim) {}
+	};
+
+
+//---------------------------< M E A S U R E >----------------------------------------------------------------
+//
+// run pattern once with ack polls sleeping and once spinning; report system calls per KB of payload
+//
+
+static void measure (const char* name, uint32_t payload, void (*pattern) (Systronix_M24C32& eep, Systronix_M24C32_sim_device& dev))
+	{
+	uint32_t	calls[2];
+	uint32_t	sleeps = 0;
+	uint32_t	combined = 0;
+	uint32_t	transactions = 0;
+	double		ms[2];
+
+	for (uint8_t spin=0; spin<2; spin++)
+		{
+		Systronix_M24C32_sim			sim (400000);
+		Systronix_M24C32_sim_device		dev (0x50);
+		sim_i2c_dev						i2c_dev (sim);
+		Systronix_M24C32				eep;
+		uint64_t						t0;
+
+		for (uint32_t i=0; i<dev.size (); i++)
+			dev.mem[i] = (uint8_t)((i * 7) + (i >> 8));
+		sim.attach (dev);
+		i2c_dev.poll_interval_set (spin ? 0 : LINUX_POLL_US);
+		eep.setup (0x50, i2c_dev, (char*)"i2c-dev");
+		eep.begin ();
+		eep.init ();
+
+		memset (&i2c_dev.stats, 0, sizeof(i2c_dev.stats));
+		sim.stats_clear ();
+		t0 = sim.now_ns ();
+		pattern (eep, dev);
+		ms[spin] = (sim.now_ns () - t0) / 1e6;
+		calls[spin] = i2c_dev.syscalls ();
+		if (0 == spin)
+			{
+			sleeps = i2c_dev.stats.sleeps;
+			combined = i2c_dev.stats.combined;
+			}
+		else
+			transactions = sim.stats.transactions;		// spinning: one per poll, as read()/write() would be
+		}
+
+	printf ("%-24s %8.1f %8.1f %10.1f %9.1f   %5u %5u   %8.2f %8.2f\n", name, calls[0] * 1024.0 / payload,
+		calls[1] * 1024.0 / payload, transactions * 1024.0 / payload, sleeps * 1024.0 / payload, combined, sleeps,
+		ms[0], ms[1]);
+	}
+
+
+//---------------------------< P A T T E R N S >--------------------------------------------------------------
+
+static void dump (Systronix_M24C32& eep, Systronix_M24C32_sim_device& dev)
+	{
+	static uint8_t	buf[0x1000];
+
+	if ((SUCCESS != eep.read (0, buf, sizeof(buf))) || memcmp (buf, dev.mem, sizeof(buf)))
+		bad++;
+	}
+
+static void random16 (Systronix_M24C32& eep, Systronix_M24C32_sim_device& dev)
+	{
+	uint8_t	buf[16];
+
+	srand (1);
+	for (uint16_t i=0; i<256; i++)
+		{
+		uint32_t	addr = (rand () % 256) * 16;
+		if ((SUCCESS != eep.read (addr, buf, 16)) || memcmp (buf, &dev.mem[addr], 16))
+			bad++;
+		}
+	}
+
+static void bytes (Systronix_M24C32& eep, Systronix_M24C32_sim_device& dev)
+	{
+	for (uint16_t a=0; a<1024; a++)
+		{
+		eep.set_addr16 (a);
+		if ((SUCCESS != eep.byte_read ()) || (eep.control.rd_byte != dev.mem[a]))
+			bad++;
+		}
+	}
+
+static void program (Systronix_M24C32& eep, Systronix_M24C32_sim_device& dev)
+	{
+	static uint8_t	buf[0x1000];
+	uint8_t			x;
+
+	for (uint32_t i=0; i<sizeof(buf); i++)
+		buf[i] = (uint8_t)(i ^ 0x5A);
+	if (SUCCESS != eep.write (0, buf, sizeof(buf)))
+		bad++;
+	eep.read (0, &x, 1);								// wait out the last write cycle
+	if (memcmp (buf, dev.mem, sizeof(buf)))
+		bad++;
+	}
+
+static void update (Systronix_M24C32& eep, Systronix_M24C32_sim_device& dev)
+	{
+	uint32_t	v;
+
+	for (uint16_t i=0; i<64; i++)						// int32 read-modify-write, one per page
+		{
+		if (SUCCESS != eep.read (i * 32, v))
+			bad++;
+		v++;
+		if (SUCCESS != eep.write (i * 32, v))
+			bad++;
+		}
+	eep.read (0, v);
+	if (v != (uint32_t)(dev.mem[0] | (dev.mem[1] << 8) | (dev.mem[2] << 16) | (dev.mem[3] << 24)))
+		bad++;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (void)
+	{
+	Systronix_M24C32_linux	real;
+
+	printf ("M24C32 at 400kHz; system calls per KB of payload; ack polls sleep %dus after a nack\n\n", LINUX_POLL_US);
+	printf ("%-24s %8s %8s %10s %9s   %5s %5s   %8s %8s\n", "", "rdwr", "spin", "read/write", "sleeps", "comb", "sleep", "ms", "spin ms");
+	measure ("read() 4 KB", 4096, dump);
+	measure ("read() 16 B x 256", 4096, random16);
+	measure ("byte_read() x 1024", 1024, bytes);
+	measure ("write() 4 KB", 4096, program);
+	measure ("int32 read+write x 64", 512, update);
+
+	if (SUCCESS == real.open ((uint8_t)99))				// no such bus here; make sure the failure path is clean
+		bad++;
+
+	printf ("\n%s\n", bad ? "FAIL" : "ok");
+	return bad ? 1 : 0;
+	}
@@ -0,0 +1,109 @@
+//
+// log_bench.cpp
+//
+// Benchmark of Systronix_M24C32_log on a simulated M24C32 (tW 5ms) at 100kHz, 400kHz, and 1MHz:
+//		append rate		300 appends of 25-byte records (LOG_PAYLOAD_MAX) to an empty log over all 128 pages
+//		mount latency	mount() of logs holding 0 - 300 records (the ring wraps at 128) against a read() of the
+//						whole array, which a scanning mount would need
+//
+// Every record a mount() finds is read back and its sequence number checked; any mismatch exits with status 1.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/log_bench/log_bench.cpp Systronix_M24C32*.cpp -o log_bench && ./log_bench
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_log.h>
+#include <Systronix_M24C32_sim.h>
+#include <stdio.h>
+
+#define		APPENDS			300
+
+static const uint16_t	fills[] = {0, 1, 5, 64, 127, 128, 200, 300};
+static uint8_t			array[ADDRESS_MAX + 1];
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+//
+// one bus rate; returns false when a mounted log is wrong
+//
+
+static bool run (uint32_t hz)
+	{
+	Systronix_M24C32_sim		bus (hz);
+	Systronix_M24C32_sim_device	dev (0x50);
+	Systronix_M24C32			eep;
+	Systronix_M24C32_log		log;
+	uint8_t		rec[LOG_PAYLOAD_MAX];
+	uint8_t		len;
+	uint32_t	seq;
+	uint64_t	t0;
+	double		ms;
+	bool		ok = true;
+
+	bus.attach (dev);
+	eep.setup (0x50, bus);
+	eep.init ();
+
+	log.begin (eep);
+	log.mount ();
+	t0 = bus.now_ns ();
+	for (uint16_t i=0; i<APPENDS; i++)
+		{
+		memset (rec, (uint8_t)i, LOG_PAYLOAD_MAX);
+		if (SUCCESS != log.append (rec, LOG_PAYLOAD_MAX))
+			ok = false;
+		}
+	ms = (bus.now_ns () - t0) / 1e6;
+	printf ("%7u Hz  %u appends %.1f ms: %.0f records/s, %.0f payload bytes/s\n", hz, APPENDS, ms,
+		APPENDS / (ms / 1000), APPENDS * LOG_PAYLOAD_MAX / (ms / 1000));
+
+	for (uint16_t fill : fills)
+		{
+		Systronix_M24C32_log	mounted;
+		double		mount_ms;
+		double		read_ms;
+		bool		good = true;
+
+		dev.erase ();
+		log.begin (eep);
+		log.mount ();
+		for (uint16_t i=0; i<fill; i++)
+			{
+			rec[0] = (uint8_t)i;
+			log.append (rec, 1 + (i % LOG_PAYLOAD_MAX));
+			}
+		bus.advance (6000);								// let the last write cycle end
+
+		mounted.begin (eep);
+		t0 = bus.now_ns ();
+		mounted.mount ();
+		mount_ms = (bus.now_ns () - t0) / 1e6;
+
+		t0 = bus.now_ns ();
+		eep.read (0, array, sizeof(array));
+		read_ms = (bus.now_ns () - t0) / 1e6;
+
+		good = (mounted.newest_seq () == fill) && (mounted.count () == ((128 < fill) ? 128 : fill));
+		for (uint16_t k=0; good && (k<mounted.count ()); k++)
+			good = (SUCCESS == mounted.read (k, rec, &len, &seq)) && (seq == (uint32_t)(fill - mounted.count () + k + 1));
+		ok = ok && good;
+
+		printf ("           %3u records: mount() %5.2f ms, %2u page reads; whole-array read() %6.2f ms  %s\n",
+			fill, mount_ms, mounted.stats.mount_reads, read_ms, good ? "ok" : "MISMATCH");
+		}
+	return ok;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (void)
+	{
+	bool	ok = true;
+
+	ok = run (100000) && ok;
+	ok = run (400000) && ok;
+	ok = run (1000000) && ok;
+	return ok ? 0 : 1;
+	}
@@ -0,0 +1,533 @@
+//
+// pack_bench.cpp
+//
+// Benchmark of Systronix_M24C32_pack on representative records:
+//		reading			a sensor sample as a logger keeps it: time, sequence number, 16-byte null-padded
+//						sensor_type, address, status, temperature, pressure, humidity; 36 bytes as a struct.
+//						Three sensors (MS8607PT, HDC1080, TMP275) are read in turn every 20s.
+//		identity		the assembly page and three sensor pages of examples/mux_ini_loader_SD; 32 bytes each
+//
+// It reports host encode and decode speed, then stores 1000 readings on a simulated M24C32 at 400kHz (tW 5ms)
+// in several ways and counts write cycles, bus time, the readings the 4 KB array holds, and the time to read
+// the array back per reading held:
+//		raw, a write per reading		each struct written as it is taken
+//		raw, a page at a time			structs gathered in RAM and written 32 bytes at a time
+//		packed, a write per reading		each reading appended to the current page, which is rewritten
+//		packed, a page at a time		as above, the page written once it is full
+//		packed, 8-page blocks			a page at a time; a block's first reading is stored in full and the rest as
+//										deltas, so a longer block stores fewer full readings
+//		packed, log						as many packed readings as fit in one Systronix_M24C32_log record
+//
+// Packed pages: byte 0 counts the block's bytes in the page (0 - 31), the rest is the encoded stream; a record
+// may run on into the next page of its block.  A block ends at its first page that is not full.
+//
+// Every stored reading is read back, decoded, and compared; any mismatch exits with status 1.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/pack_bench/pack_bench.cpp Systronix_M24C32*.cpp -o pack_bench && ./pack_bench
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_log.h>
+#include <Systronix_M24C32_pack.h>
+#include <Systronix_M24C32_sim.h>
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define		READINGS		1000
+#define		PAYLOAD			(EEP_PAGE_SIZE - 1)			// stream bytes in a packed page
+#define		SPEED_PASSES	2000
+
+static uint32_t	bad;
+
+
+//---------------------------< R E C O R D S >----------------------------------------------------------------
+
+struct reading
+	{
+	uint32_t	time;									// seconds since 1970
+	uint32_t	sequence;
+	char		sensor_type[16];						// null padded
+	uint8_t		sensor_addr;
+	uint8_t		status;
+	int16_t		temperature;							// 0.01C
+	uint32_t	pressure;								// Pa; 0 from a sensor without
+	uint16_t	humidity;								// 0.01%RH; 0 from a sensor without
+	};
+
+struct assembly_page
+	{
+	char		assembly_type[16];
+	uint32_t	manufacture_date;
+	uint32_t	service_date;
+	uint16_t	assembly_revision;
+	uint8_t		ports;
+	uint8_t		unused[5];
+	};
+
+struct sensor_page
+	{
+	char		sensor_type[16];
+	uint8_t		sensor_addr;
+	uint8_t		unused[15];
+	};
+
+static const char* const	dict[] = {"MUX7", "TMP275", "HDC1080", "MS8607PT", "MS8607H"};
+
+static const struct eep_pack_field	reading_fields[] =
+	{
+	EEP_PK_FIELD (reading, time, EEP_PK_DELTA),
+	EEP_PK_FIELD (reading, sequence, EEP_PK_DELTA),
+	EEP_PK_FIELD (reading, sensor_type, EEP_PK_STR),
+	EEP_PK_FIELD (reading, sensor_addr, EEP_PK_UINT),
+	EEP_PK_FIELD (reading, status, EEP_PK_UINT),
+	EEP_PK_FIELD (reading, temperature, EEP_PK_DELTA),
+	EEP_PK_FIELD (reading, pressure, EEP_PK_DELTA),
+	EEP_PK_FIELD (reading, humidity, EEP_PK_DELTA),
+	};
+
+static const struct eep_pack_field	assembly_fields[] =
+	{
+	EEP_PK_FIELD (assembly_page, assembly_type, EEP_PK_STR),
+	EEP_PK_FIELD (assembly_page, manufacture_date, EEP_PK_UINT),
+	EEP_PK_FIELD (assembly_page, service_date, EEP_PK_UINT),
+	EEP_PK_FIELD (assembly_page, assembly_revision, EEP_PK_UINT),
+	EEP_PK_FIELD (assembly_page, ports, EEP_PK_UINT),
+	};
+
+static const struct eep_pack_field	sensor_fields[] =
+	{
+	EEP_PK_FIELD (sensor_page, sensor_type, EEP_PK_STR),
+	EEP_PK_FIELD (sensor_page, sensor_addr, EEP_PK_UINT),
+	};
+
+static Systronix_M24C32_pack	pack;
+static struct reading			readings[READINGS];
+
+
+//---------------------------< M A K E   R E A D I N G S >----------------------------------------------------
+//
+// three sensors in turn, one every 20s, slowly drifting
+//
+
+static void make_readings (void)
+	{
+	uint32_t	x = 5;
+	int16_t		t = 2150;
+	uint32_t	p = 101325;
+	uint16_t	h = 4500;
+
+	memset (readings, 0, sizeof(readings));
+	for (uint32_t i=0; i<READINGS; i++)
+		{
+		struct reading&	r = readings[i];
+
+		x = (x * 1103515245) + 12345;
+		t += (int16_t)((x >> 16) % 21) - 10;
+		p += (int32_t)((x >> 8) % 41) - 20;
+		h += (int16_t)((x >> 20) % 31) - 15;
+
+		r.time = 1760000000 + (20 * i);
+		r.sequence = 40000 + i;
+		switch (i % 3)
+			{
+			case 0:
+				strcpy (r.sensor_type, "MS8607PT");
+				r.sensor_addr = 0x76;
+				r.temperature = t;
+				r.pressure = p;
+				break;
+			case 1:
+				strcpy (r.sensor_type, "HDC1080");
+				r.sensor_addr = 0x40;
+				r.temperature = t + 12;
+				r.humidity = h;
+				break;
+			default:
+				strcpy (r.sensor_type, "TMP275");
+				r.sensor_addr = 0x48;
+				r.temperature = t - 7;
+			}
+		r.status = (0 == (x >> 24) % 97) ? 1 : 0;
+		}
+	}
+
+
+//---------------------------< S P E E D >--------------------------------------------------------------------
+//
+// host ns per reading to encode and to decode the whole set as one stream
+//
+
+static void speed (void)
+	{
+	static uint8_t			stream[READINGS * sizeof(struct reading)];
+	static struct reading	out[READINGS];
+	size_t					len = 0;
+	uint16_t				count;
+	double					enc_ns;
+	double					dec_ns;
+
+	auto	t0 = std::chrono::steady_clock::now ();
+	for (uint32_t pass=0; pass<SPEED_PASSES; pass++)
+		len = pack.encode_n (readings, READINGS, stream, sizeof(stream), &count);
+	enc_ns = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - t0).count () / SPEED_PASSES / READINGS;
+
+	t0 = std::chrono::steady_clock::now ();
+	for (uint32_t pass=0; pass<SPEED_PASSES; pass++)
+		if (READINGS != pack.decode_n (stream, len, out, READINGS))
+			bad++;
+	dec_ns = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - t0).count () / SPEED_PASSES / READINGS;
+
+	if ((READINGS != count) || memcmp (out, readings, sizeof(readings)))
+		bad++;
+
+	printf ("one stream of %u readings: %.2f bytes per reading (struct %u)\n", READINGS, (double)len / READINGS,
+		(uint32_t)sizeof(struct reading));
+	printf ("encode %.1f ns per reading (%.0f MB/s of struct); decode %.1f ns per reading (%.0f MB/s)\n\n",
+		enc_ns, sizeof(struct reading) / enc_ns * 1000, dec_ns, sizeof(struct reading) / dec_ns * 1000);
+	}
+
+
+//---------------------------< B E D >------------------------------------------------------------------------
+//
+// a fresh simulated part and driver for one way of storing the readings
+//
+
+struct bed
+	{
+	Systronix_M24C32_sim			sim;
+	Systronix_M24C32_sim_device		dev;
+	Systronix_M24C32				eep;
+	uint32_t						cycles0;
+	uint64_t						t0;
+
+	bed (void) : sim (400000), dev (0x50)
+		{
+		sim.attach (dev);
+		eep.setup (0x50, sim, (char*)"sim");
+		eep.begin ();
+		sim.clock_set (400000);							// begin() set the default rate
+		eep.init ();
+		}
+
+	void		start (void) {cycles0 = dev.write_cycles; t0 = sim.now_ns ();}
+	};
+
+
+//---------------------------< R E P O R T >------------------------------------------------------------------
+
+static void report (const char* name, bed& b, double bytes, uint32_t held)
+	{
+	uint32_t	cycles = b.dev.write_cycles - b.cycles0;
+	double		store_ms = (b.sim.now_ns () - b.t0) / 1e6;
+	static uint8_t	buf[4096];
+	uint64_t	t0;
+
+	b.sim.advance (10000);								// past the last write cycle
+	t0 = b.sim.now_ns ();
+
+	if (SUCCESS != b.eep.read (0, buf, sizeof(buf)))
+		bad++;
+	printf ("%-28s %8.2f %8u %8u %10.2f %10.3f\n", name, bytes, held, cycles, store_ms / READINGS,
+		(b.sim.now_ns () - t0) / 1e6 / held);
+	}
+
+
+//---------------------------< R A W >------------------------------------------------------------------------
+//
+// structs as they are; a ring of whole structs, written one at a time or gathered into pages
+//
+
+static void raw (boolean gather)
+	{
+	bed			b;
+	uint32_t	slots = 4096 / sizeof(struct reading);
+	uint8_t		page[EEP_PAGE_SIZE];
+	uint32_t	fill = 0;								// bytes gathered in page
+	uint32_t	at = 0;									// array address of page
+	struct reading	check;
+
+	b.start ();
+	for (uint32_t i=0; i<READINGS; i++)
+		{
+		const uint8_t*	r = (const uint8_t*)&readings[i];
+		uint32_t		addr = (i % slots) * sizeof(struct reading);
+
+		if (!gather)
+			{
+			if (SUCCESS != b.eep.write (addr, r, sizeof(struct reading)))
+				bad++;
+			continue;
+			}
+		for (size_t j=0; j<sizeof(struct reading); j++)
+			{
+			if (!fill)
+				at = addr + j;
+			page[fill++] = r[j];
+			if ((EEP_PAGE_SIZE == fill) || (0 == ((at + fill) % EEP_PAGE_SIZE)) || ((at + fill) == slots * sizeof(struct reading)))
+				{
+				if (SUCCESS != b.eep.write (at, page, fill))
+					bad++;
+				fill = 0;
+				}
+			}
+		}
+	if (fill && (SUCCESS != b.eep.write (at, page, fill)))
+		bad++;
+
+	for (uint32_t i=READINGS-slots; i<READINGS; i++)
+		{
+		memcpy (&check, &b.dev.mem[(i % slots) * sizeof(struct reading)], sizeof(check));
+		if (memcmp (&check, &readings[i], sizeof(check)))
+			bad++;
+		}
+	report (gather ? "raw, a page at a time" : "raw, a write per reading", b, sizeof(struct reading), slots);
+	}
+
+
+//---------------------------< P A C K E D >------------------------------------------------------------------
+//
+// Packed blocks of block_pages pages in a ring over the array; each page is written once it is full, or after
+// every reading when each is set.  Every block that holds readings is checked at the end.
+//
+
+static void packed (const char* name, uint16_t block_pages, boolean each)
+	{
+	bed				b;
+	uint16_t		blocks = 128 / block_pages;
+	uint32_t		first[128];							// per block slot: first reading and count stored there
+	uint32_t		count[128];
+	uint8_t			page[EEP_PAGE_SIZE];
+	uint8_t			enc[64];
+	uint16_t		block = 0;							// slot being filled
+	uint16_t		pg = 0;								// page within it
+	size_t			k;
+	uint64_t		bytes = 0;
+	uint32_t		held = 0;
+
+	auto	close_block = [&] ()						// the block ends at its first page that is not full
+		{
+		uint32_t	addr = ((block * block_pages) + pg) * EEP_PAGE_SIZE;
+
+		if (page[0] && !each && (SUCCESS != b.eep.write (addr, page, 1 + page[0])))
+			bad++;
+		if (!page[0] && (pg < block_pages) && (SUCCESS != b.eep.write (addr, page, 1)))
+			bad++;
+		};
+
+	memset (count, 0, sizeof(count));
+	memset (page, 0, sizeof(page));
+	b.start ();
+	for (uint32_t i=0; i<READINGS; i++)
+		{
+		boolean	key = (0 == count[block]);
+
+		k = pack.encode (&readings[i], key ? NULL : &readings[i-1], enc, sizeof(enc));
+		if (!key && ((size_t)(((block_pages - pg) * PAYLOAD) - page[0]) < k))
+			{
+			close_block ();
+			block = (block + 1) % blocks;
+			pg = 0;
+			page[0] = 0;
+			count[block] = 0;
+			k = pack.encode (&readings[i], NULL, enc, sizeof(enc));
+			}
+		if (0 == count[block])
+			first[block] = i;
+		count[block]++;
+		bytes += k;
+
+		for (size_t j=0; j<k; j++)
+			{
+			page[1 + page[0]++] = enc[j];
+			if (PAYLOAD == page[0])
+				{
+				if (SUCCESS != b.eep.write (((block * block_pages) + pg) * EEP_PAGE_SIZE, page, EEP_PAGE_SIZE))
+					bad++;
+				pg++;
+				page[0] = 0;
+				}
+			}
+		if (each && page[0] && (SUCCESS != b.eep.write (((block * block_pages) + pg) * EEP_PAGE_SIZE, page, 1 + page[0])))
+			bad++;
+		}
+	close_block ();
+
+	for (uint16_t s=0; s<blocks; s++)				// read every block back the way a reader would
+		{
+		uint8_t			stream[128 * PAYLOAD];
+		struct reading	out[128 * 3];
+		size_t			len = 0;
+		const uint8_t*	p;
+
+		if (!count[s])
+			continue;
+		memset (out, 0, sizeof(out));					// decode() leaves padding and fields not in the table alone
+		for (uint16_t q=0; q<block_pages; q++)
+			{
+			p = &b.dev.mem[(s * block_pages + q) * EEP_PAGE_SIZE];
+			memcpy (&stream[len], &p[1], p[0]);
+			len += p[0];
+			if (PAYLOAD != p[0])
+				break;
+			}
+		if ((count[s] != pack.decode_n (stream, len, out, sizeof(out) / sizeof(out[0]))) ||
+			memcmp (out, &readings[first[s]], count[s] * sizeof(struct reading)))
+			bad++;
+		held += count[s];
+		}
+	report (name, b, (double)bytes / READINGS, held);
+	}
+
+
+//---------------------------< L O G G E D >------------------------------------------------------------------
+//
+// as many packed readings as fit in each Systronix_M24C32_log record
+//
+
+static void logged (void)
+	{
+	bed					b;
+	Systronix_M24C32_log	log;
+	uint8_t				payload[LOG_PAYLOAD_MAX];
+	uint8_t				len;
+	std::vector<uint32_t>	first;
+	std::vector<uint16_t>	count;
+	uint32_t			i = 0;
+	uint16_t			n;
+	size_t				k;
+	uint64_t			bytes = 0;
+	uint32_t			held = 0;
+
+	log.begin (b.eep);
+	log.format ();
+	b.start ();
+	while (i < READINGS)
+		{
+		k = pack.encode_n (&readings[i], READINGS - i, payload, sizeof(payload), &n);
+		bytes += k;
+		if ((0 == n) || (SUCCESS != log.append (payload, (uint8_t)k)))
+			{
+			bad++;
+			break;
+			}
+		first.push_back (i);
+		count.push_back (n);
+		i += n;
+		}
+
+	for (uint16_t r=0; r<log.count (); r++)
+		{
+		struct reading	out[LOG_PAYLOAD_MAX];
+		size_t			at = first.size () - log.count () + r;
+
+		memset (out, 0, sizeof(out));
+		if ((SUCCESS != log.read (r, payload, &len)) || (count[at] != pack.decode_n (payload, len, out, LOG_PAYLOAD_MAX)) ||
+			memcmp (out, &readings[first[at]], count[at] * sizeof(struct reading)))
+			bad++;
+		held += count[at];
+		}
+	report ("packed, log", b, (double)bytes / READINGS, held);
+	}
+
+
+//---------------------------< I D E N T I T Y >--------------------------------------------------------------
+//
+// the assembly page and three sensor pages, as pages and packed into one
+//
+
+static void identity (void)
+	{
+	Systronix_M24C32_pack	assy;
+	Systronix_M24C32_pack	sens;
+	struct assembly_page	a;
+	struct sensor_page		s[3];
+	struct assembly_page	a_out;
+	struct sensor_page		s_out[3];
+	uint8_t					page[EEP_PAGE_SIZE];
+	uint8_t					buf[4 * EEP_PAGE_SIZE];
+	uint16_t				n;
+	size_t					k;
+	bed						raw_bed;
+	bed						pk_bed;
+	uint64_t				t0;
+
+	assy.setup (sizeof(a), assembly_fields, sizeof(assembly_fields) / sizeof(assembly_fields[0]), dict, sizeof(dict) / sizeof(dict[0]));
+	sens.setup (sizeof(s[0]), sensor_fields, sizeof(sensor_fields) / sizeof(sensor_fields[0]), dict, sizeof(dict) / sizeof(dict[0]));
+
+	memset (&a, 0, sizeof(a));
+	memset (s, 0, sizeof(s));
+	strcpy (a.assembly_type, "MUX7");
+	a.manufacture_date = 1735689600;
+	a.service_date = 1760000000;
+	a.assembly_revision = 0x0103;
+	a.ports = 7;
+	strcpy (s[0].sensor_type, "MS8607PT");
+	s[0].sensor_addr = 0x80 | 0x76;
+	strcpy (s[1].sensor_type, "MS8607H");
+	s[1].sensor_addr = 0x80 | 0x40;
+	strcpy (s[2].sensor_type, "TMP275");
+	s[2].sensor_addr = 0x48;
+
+	memcpy (&buf[0], &a, EEP_PAGE_SIZE);			// as the loader writes them: one page each
+	memcpy (&buf[EEP_PAGE_SIZE], s, 3 * EEP_PAGE_SIZE);
+	raw_bed.start ();
+	if (SUCCESS != raw_bed.eep.write (0, buf, sizeof(buf)))
+		bad++;
+	printf ("\n%-28s %6s %8s %10s %10s\n", "identity", "bytes", "writes", "store ms", "read ms");
+	raw_bed.sim.advance (10000);
+	t0 = raw_bed.sim.now_ns ();
+	raw_bed.eep.read (0, buf, sizeof(buf));
+	printf ("%-28s %6u %8u %10.2f %10.3f\n", "4 pages", (uint32_t)sizeof(buf), raw_bed.dev.write_cycles - raw_bed.cycles0,
+		(t0 - raw_bed.t0) / 1e6 - 10, (raw_bed.sim.now_ns () - t0) / 1e6);
+
+	k = assy.encode (&a, NULL, &page[1], sizeof(page) - 1);		// byte 0: the assembly's encoded length
+	page[0] = (uint8_t)k;
+	k += sens.encode_n (s, 3, &page[1 + k], sizeof(page) - 1 - k, &n);
+	if ((0 == page[0]) || (3 != n))
+		bad++;
+	pk_bed.start ();
+	if (SUCCESS != pk_bed.eep.write (0, page, 1 + k))
+		bad++;
+	pk_bed.sim.advance (10000);
+	t0 = pk_bed.sim.now_ns ();
+	pk_bed.eep.read (0, buf, EEP_PAGE_SIZE);
+	printf ("%-28s %6u %8u %10.2f %10.3f\n", "packed into one page", (uint32_t)(1 + k), pk_bed.dev.write_cycles - pk_bed.cycles0,
+		(t0 - pk_bed.t0) / 1e6 - 10, (pk_bed.sim.now_ns () - t0) / 1e6);
+
+	memset (&a_out, 0, sizeof(a_out));
+	memset (s_out, 0, sizeof(s_out));
+	if ((buf[0] != assy.decode (&buf[1], buf[0], &a_out, NULL)) ||
+		(3 != sens.decode_n (&buf[1 + buf[0]], k - buf[0], s_out, 3)) || memcmp (&a, &a_out, sizeof(a)) || memcmp (s, s_out, sizeof(s)))
+		bad++;
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (void)
+	{
+	if (SUCCESS != pack.setup (sizeof(struct reading), reading_fields, sizeof(reading_fields) / sizeof(reading_fields[0]), dict, sizeof(dict) / sizeof(dict[0])))
+		return 1;
+	make_readings ();
+	speed ();
+
+	printf ("%u readings, 400kHz, tW 5ms\n", READINGS);
+	printf ("%-28s %8s %8s %8s %10s %10s\n", "", "bytes", "held", "writes", "ms/reading", "read ms/r");
+	raw (false);
+	raw (true);
+	packed ("packed, a write per reading", 1, true);
+	packed ("packed, a page at a time", 1, false);
+	packed ("packed, 8-page blocks", 8, false);
+	logged ();
+	identity ();
+
+	if (bad)
+		{
+		printf ("\n%u check(s) failed\n", bad);
+		return 1;
+		}
+	return 0;
+	}
@@ -0,0 +1,338 @@
+//
+// ptr_check.cpp
+//
+// Randomised check of the driver's model of the device address pointer (the address phase that read(),
+// page_read(), byte_read(), int16_read(), and int32_read() leave out when the device pointer is already at the
+// address) against the simulated device's own pointer and a model of its array.  After every operation the
+// data read must match the model and, whenever the driver believes it knows the pointer, the simulated
+// device's pointer must be where the driver thinks it is.
+//
+//		parts		3000 random reads (every kind), writes, reads that wrap from the top of the array to 0,
+//					and current_address_read()s on an M24C32 and on an M24M02 (block bits), with init(), begin(),
+//					and part_set() mixed in
+//		mux			one instance shared by two boards at 0x57 behind a PCA9548A; random reads and writes
+//					through the Systronix_M24C32_mux map, and reads straight through the instance after a
+//					select(), so every path change must drop the model
+//		shared bus	two Systronix_M24C32_sched clients, each with its own instance of the same part; each
+//					instance sees the other's traffic only as a change of the client's epoch()
+//
+// It takes a seed on the command line; any mismatch exits with status 1.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -pthread -I. extras/ptr_check/ptr_check.cpp Systronix_M24C32*.cpp -o ptr_check && ./ptr_check [seed]
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_mux.h>
+#include <Systronix_M24C32_sched.h>
+#include <Systronix_M24C32_sim.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define		OPS				3000
+#define		LEN_MAX			40
+
+static uint8_t		model[EEP_SIZE_MAX];
+static uint8_t		model2[ADDRESS_MAX + 1];			// the second board in the mux and shared bus checks
+static uint32_t		errors;
+
+
+//---------------------------< P R O B E >--------------------------------------------------------------------
+//
+// the driver with its pointer model visible
+//
+
+class probe : public Systronix_M24C32
+	{
+	public:
+		boolean		known (void) {return ptr_known ();}
+		uint32_t	where (void) {return _ptr;}
+	};
+
+
+//---------------------------< A G R E E >--------------------------------------------------------------------
+//
+// the driver either does not claim to know the pointer or is right about it
+//
+
+static void agree (probe& eep, Systronix_M24C32_sim_device& dev, const char* check, uint32_t op)
+	{
+	if (eep.known () && (eep.where () != dev.pointer_get ()))
+		{
+		printf ("%s op %u: driver thinks the pointer is at 0x%05X, device has 0x%05X\n", check, op, eep.where (), dev.pointer_get ());
+		errors++;
+		}
+	}
+
+static void same (const uint8_t* data, const uint8_t* expect, size_t len, const char* check, uint32_t op, const char* what)
+	{
+	if (memcmp (data, expect, len))
+		{
+		printf ("%s op %u: %s differs from the model\n", check, op, what);
+		errors++;
+		}
+	}
+
+
+//---------------------------< P A R T S >--------------------------------------------------------------------
+
+static void parts (Systronix_M24C32_sim& bus, probe& eep, Systronix_M24C32_sim_device& dev, const struct eep_part& part, const char* check)
+	{
+	uint32_t	size = eep.size ();
+	uint32_t	skipped = eep.stats.addr_skipped;
+	uint8_t		buf[LEN_MAX];
+
+	memcpy (model, dev.mem, size);
+	for (uint32_t op=0; op<OPS; op++)
+		{
+		uint32_t	addr = (0 == (rand () % 3)) ? eep.get_addr () : (rand () % size);	// often where the last one ended
+		uint32_t	len = 1 + (rand () % LEN_MAX);
+
+		if ((addr + len) > size)
+			addr = (rand () % 2) ? (size - len) : 0;
+
+		switch (rand () % 10)
+			{
+			case 0:
+				for (uint32_t k=0; k<len; k++)
+					buf[k] = (uint8_t)rand ();
+				if (SUCCESS != eep.write (addr, buf, len))
+					errors++;
+				memcpy (&model[addr], buf, len);
+				break;
+			case 1:
+			case 2:
+				if (SUCCESS != eep.read (addr, buf, len))
+					errors++;
+				same (buf, &model[addr], len, check, op, "read()");
+				break;
+			case 3:
+				eep.set_addr (addr);
+				if (SUCCESS != eep.byte_read ())
+					errors++;
+				same (&eep.control.rd_byte, &model[addr], 1, check, op, "byte_read()");
+				break;
+			case 4:
+				eep.set_addr (addr);
+				eep.control.rd_wr_len = len;
+				eep.control.rd_buf_ptr = buf;
+				if (SUCCESS != eep.page_read ())
+					errors++;
+				same (buf, &model[addr], len, check, op, "page_read()");
+				break;
+			case 5:
+				addr &= ~3;
+				eep.set_addr (addr);
+				if (SUCCESS != eep.int32_read ())
+					errors++;
+				same ((uint8_t*)&eep.control.rd_int32, &model[addr], 4, check, op, "int32_read()");
+				break;
+			case 6:											// end at the top; the next read from 0 may skip its address
+				if (SUCCESS != eep.read (size - len, buf, len))
+					errors++;
+				if (SUCCESS != eep.read (0, buf, len))
+					errors++;
+				same (buf, model, len, check, op, "read() after the top of the array");
+				break;
+			case 7:
+				eep.set_addr (addr);
+				if (SUCCESS != eep.byte_read ())
+					errors++;
+				if (SUCCESS != eep.current_address_read ())
+					errors++;
+				same (&eep.control.rd_byte, &model[(addr + 1) % size], 1, check, op, "current_address_read()");
+				break;
+			case 8:
+				if (0 == (rand () % 4))
+					{
+					bus.advance (10000);						// a power cycle; the device is not mid write cycle
+					if (SUCCESS != eep.init ())
+						errors++;
+					}
+				else if (rand () % 2)
+					{
+					eep.begin ();
+					bus.clock_set (400000);
+					}
+				else if (SUCCESS != eep.part_set (part))
+					errors++;
+				break;
+			default:										// carry on from where the last one ended
+				addr = eep.get_addr ();
+				if (len > (size - addr))
+					len = size - addr;
+				if (SUCCESS != eep.read (addr, buf, len))
+					errors++;
+				same (buf, &model[addr], len, check, op, "read() from where the last ended");
+				break;
+			}
+		agree (eep, dev, check, op);
+		}
+
+	printf ("%-10s %u ops, %u address phases skipped\n", check, OPS, eep.stats.addr_skipped - skipped);
+	}
+
+
+//---------------------------< M U X >------------------------------------------------------------------------
+
+static void mux (void)
+	{
+	Systronix_M24C32_sim		bus (400000);
+	Systronix_M24C32_sim_mux	sim_mux (0x70);
+	Systronix_M24C32_sim_device	board[2] = {0x57, 0x57};
+	Systronix_M24C32_mux		map;
+	probe		eep;
+	uint8_t*	m[2] = {model, model2};
+	uint8_t		buf[LEN_MAX];
+	uint8_t		node;
+
+	bus.attach (sim_mux);
+	sim_mux.attach (0, board[0]);
+	sim_mux.attach (1, board[1]);
+	for (uint32_t i=0; i<=ADDRESS_MAX; i++)
+		{
+		board[0].mem[i] = model[i] = (uint8_t)(i * 5);
+		board[1].mem[i] = model2[i] = (uint8_t)(i * 11 + 1);
+		}
+
+	eep.setup (0x57, bus);
+	map.setup (bus);
+	map.add (0x70, 0, eep);
+	map.add (0x70, 1, eep);
+	map.init ();
+	map.select (0);
+	eep.init ();
+
+	for (uint32_t op=0; op<OPS; op++)
+		{
+		uint32_t	addr = (rand () % 2) ? eep.get_addr () : (rand () % (ADDRESS_MAX + 1));
+		uint32_t	len = 1 + (rand () % LEN_MAX);
+
+		node = rand () % 2;
+		if ((addr + len) > (ADDRESS_MAX + 1))
+			addr = ADDRESS_MAX + 1 - len;
+
+		switch (rand () % 4)
+			{
+			case 0:
+				for (uint32_t k=0; k<len; k++)
+					buf[k] = (uint8_t)rand ();
+				if (SUCCESS != map.write (node, addr, buf, len))
+					errors++;
+				memcpy (&m[node][addr], buf, len);
+				bus.advance (10000);						// the instance's write cycle wait would poll the other board
+				break;
+			case 1:
+				if (SUCCESS != map.read (node, addr, buf, len))
+					errors++;
+				same (buf, &m[node][addr], len, "mux", op, "map.read()");
+				break;
+			default:										// straight through the instance once the path is open
+				if (SUCCESS != map.select (node))
+					errors++;
+				if (SUCCESS != eep.read (addr, buf, len))
+					errors++;
+				same (buf, &m[node][addr], len, "mux", op, "read() after select()");
+				break;
+			}
+		agree (eep, board[node], "mux", op);
+		}
+
+	printf ("%-10s %u ops, %u address phases skipped, %u mux control writes\n", "mux", OPS, eep.stats.addr_skipped,
+		sim_mux.control_writes);
+	}
+
+
+//---------------------------< S H A R E D _ B U S >----------------------------------------------------------
+
+static void shared_bus (void)
+	{
+	Systronix_M24C32_sim			bus (400000);
+	Systronix_M24C32_sim_device		dev (0x50);
+	Systronix_M24C32_sched			sched;
+	Systronix_M24C32_sched_client	client[2];
+	probe		eep[2];
+	uint8_t		buf[LEN_MAX];
+	uint8_t		who;
+
+	bus.attach (dev);
+	for (uint32_t i=0; i<=ADDRESS_MAX; i++)
+		dev.mem[i] = model[i] = (uint8_t)(i * 13);
+
+	sched.setup (bus);
+	for (uint8_t i=0; i<2; i++)
+		{
+		client[i].setup (sched);
+		eep[i].setup (0x50, client[i]);
+		eep[i].init ();
+		}
+
+	for (uint32_t op=0; op<OPS; op++)
+		{
+		uint32_t	addr;
+		uint32_t	len = 1 + (rand () % LEN_MAX);
+
+		who = (0 == (rand () % 4)) ? 1 : 0;					// mostly one instance, so it has runs to skip in
+		addr = (rand () % 2) ? eep[who].get_addr () : (rand () % (ADDRESS_MAX + 1));
+		if ((addr + len) > (ADDRESS_MAX + 1))
+			addr = ADDRESS_MAX + 1 - len;
+
+		if (0 == (rand () % 5))
+			{
+			for (uint32_t k=0; k<len; k++)
+				buf[k] = (uint8_t)rand ();
+			if (SUCCESS != eep[who].write (addr, buf, len))
+				errors++;
+			memcpy (&model[addr], buf, len);
+			bus.advance (10000);							// the other instance does not know of this write cycle
+			}
+		else
+			{
+			if (SUCCESS != eep[who].read (addr, buf, len))
+				errors++;
+			same (buf, &model[addr], len, "shared bus", op, "read()");
+			}
+		agree (eep[0], dev, "shared bus", op);
+		agree (eep[1], dev, "shared bus", op);
+		}
+
+	printf ("%-10s %u ops, %u + %u address phases skipped, %u client switches\n", "shared bus", OPS,
+		eep[0].stats.addr_skipped, eep[1].stats.addr_skipped, sched.switches ());
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	Systronix_M24C32_sim		bus (400000);
+	Systronix_M24C32_sim_device	small (0x50);
+	Systronix_M24C32_sim_device	big (0x54, EEP_M24M02);
+	probe		small_eep;
+	probe		big_eep;
+	uint32_t	seed = (1 < argc) ? strtoul (argv[1], NULL, 0) : 5;
+
+	printf ("seed %u\n", seed);
+	srand (seed);
+
+	bus.attach (small);
+	bus.attach (big);
+	for (uint32_t i=0; i<small.size (); i++)
+		small.mem[i] = (uint8_t)(i * 7 + (i >> 8));
+	for (uint32_t i=0; i<big.size (); i++)
+		big.mem[i] = (uint8_t)(i * 3 + (i >> 8));
+
+	small_eep.setup (0x50, bus);
+	small_eep.init ();
+	big_eep.setup (0x54, bus);
+	big_eep.part_set (EEP_M24M02);
+	big_eep.init ();
+
+	parts (bus, small_eep, small, EEP_M24C32, "M24C32");
+	parts (bus, big_eep, big, EEP_M24M02, "M24M02");
+	mux ();
+	shared_bus ();
+
+	printf ("%s\n", errors ? "FAIL" : "ok");
+	return errors ? 1 : 0;
+	}
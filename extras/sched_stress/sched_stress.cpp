@@ -0,0 +1,318 @@
+//
+// sched_stress.cpp
+//
+// std::thread stress test of Systronix_M24C32_sched on the simulated bus (400kHz).  Three host threads share
+// one bus, each through its own client:
+//		boards		Systronix_M24C32_mux map: 4 KB reads of two boards that both answer at 0x50 behind a PCA9548A
+//					(ports 0 and 1)
+//		root		page writes of random data to the eeprom at 0x51 on the main bus, each followed by a 4 KB
+//					read of the whole array that is checked against a shadow copy
+//		sensor		a TMP275-like slave at 0x48 behind the same mux (port 2): open port 2, write the pointer
+//					register, repeated start, read two bytes; one read every 2 - 3 ms
+//
+// The sensor opens its own mux port, so a boards access that lost the bus between select() and the read would
+// fail; every read of every thread is checked and any mismatch or failure exits with status 1.
+//
+// Sensor latency is measured in simulated time from the moment a reading falls due to the end of the read.
+// The host threads run at whatever pace the OS gives them while simulated time runs only with bus traffic, so a
+// gate holds the other threads' bus calls once a reading is due until the sensor is in line for the bus; what
+// is measured is then the scheduler's doing and not the host's.
+//
+// Three configurations:
+//		fifo				every client at the same priority
+//		priority			sensor at EEP_PRIO_SENSOR, the others at EEP_PRIO_BULK
+//		priority + split	as priority, with split_reads (true) on the bulk clients
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -pthread -I. extras/sched_stress/sched_stress.cpp Systronix_M24C32*.cpp -o sched_stress
+//		./sched_stress [samples]							sensor readings per configuration; default 1000
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_mux.h>
+#include <Systronix_M24C32_sched.h>
+#include <Systronix_M24C32_sim.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define		PERIOD_NS		2000000						// sensor reading interval, plus up to 1 ms jitter
+
+static std::atomic<uint64_t>	sim_now (0);			// simulated time after the most recent bus call
+static std::atomic<uint32_t>	bad (0);
+static std::atomic<boolean>		stop (false);
+
+static std::atomic<boolean>		gate_armed (false);
+static std::atomic<boolean>		sensor_queued (false);	// the sensor is waiting for the bus (or has it)
+static std::atomic<uint64_t>	gate_due (0);
+static thread_local boolean		is_sensor = false;
+
+
+//---------------------------< S C H E D   O S >--------------------------------------------------------------
+//
+// the host default (std::mutex and std::condition_variable) plus a note when the sensor starts to wait
+//
+
+static std::mutex				os_mutex;
+static std::condition_variable	os_cond;
+
+static void os_lock (void* ctx) {(void)ctx; os_mutex.lock ();}
+static void os_unlock (void* ctx) {(void)ctx; os_mutex.unlock ();}
+static void os_notify (void* ctx) {(void)ctx; os_cond.notify_all ();}
+
+static void os_wait (void* ctx)
+	{
+	std::unique_lock<std::mutex>	lock (os_mutex, std::adopt_lock);
+
+	(void)ctx;
+	if (is_sensor)
+		sensor_queued = true;
+	os_cond.wait (lock);
+	lock.release ();
+	}
+
+
+//---------------------------< G A T E D   B U S >------------------------------------------------------------
+//
+// the simulator, publishing its clock after each bus call; once the sensor's reading is due a call from any
+// other thread waits until the sensor is in line
+//
+
+class gated_bus : public Systronix_M24C32_transport
+	{
+	protected:
+		Systronix_M24C32_sim*	_sim;
+
+		void gate (void)
+			{
+			sim_now = _sim->now_ns ();
+			if (is_sensor || !gate_armed || (sim_now < gate_due))
+				return;
+			while (!sensor_queued && !stop)
+				std::this_thread::yield ();
+			}
+
+	public:
+		gated_bus (Systronix_M24C32_sim& sim) : _sim (&sim) {}
+
+		void		begin (void) {_sim->begin ();}
+		void		begin (i2c_pins pins, i2c_rate rate) {_sim->begin (pins, rate);}
+		void		beginTransmission (uint8_t address) {_sim->beginTransmission (address);}
+		size_t		write (uint8_t data) {return _sim->write (data);}
+		size_t		write (const uint8_t* data, size_t quantity) {return _sim->write (data, quantity);}
+		uint8_t		endTransmission (i2c_stop sendStop) {uint8_t ret_val = _sim->endTransmission (sendStop); gate (); return ret_val;}
+		void		sendTransmission (i2c_stop sendStop) {_sim->sendTransmission (sendStop);}
+		size_t		requestFrom (uint8_t address, size_t len, i2c_stop sendStop) {size_t n = _sim->requestFrom (address, len, sendStop); gate (); return n;}
+		void		sendRequest (uint8_t address, size_t len, i2c_stop sendStop) {_sim->sendRequest (address, len, sendStop);}
+		uint8_t		readByte (void) {return _sim->readByte ();}
+		size_t		read (uint8_t* data, size_t count) {return _sim->read (data, count);}
+		uint8_t		done (void) {uint8_t ret_val = _sim->done (); gate (); return ret_val;}
+		uint8_t		status (void) {return _sim->status ();}
+		uint32_t	millis (void) {return (uint32_t)(sim_now / 1000000);}	// any thread may ask
+		uint32_t	micros (void) {return (uint32_t)(sim_now / 1000);}
+	};
+
+
+//---------------------------< S I M   S E N S O R >----------------------------------------------------------
+//
+// pointer register; a read returns the pointer and its complement, alternately
+//
+
+class sim_sensor : public Systronix_M24C32_sim_slave
+	{
+	protected:
+		uint8_t		_ptr;
+		uint8_t		_count;
+		boolean		_first;
+
+	public:
+		sim_sensor (uint8_t addr) {address = addr; _ptr = 0;}
+
+		boolean		select (boolean read, uint64_t now) {(void)now; _count = 0; _first = !read; return true;}
+		boolean		receive (uint8_t data, uint64_t now) {(void)now; if (_first) _ptr = data; _first = false; return true;}
+		uint8_t		transmit (uint64_t now) {(void)now; return (_count++ & 1) ? (uint8_t)~_ptr : _ptr;}
+		void		stop (uint64_t now) {(void)now;}
+	};
+
+
+//---------------------------< R U N >------------------------------------------------------------------------
+//
+// one configuration; prints sensor latency, bulk throughput, and scheduler counts
+//
+
+static void run (const char* name, boolean priority, boolean split, uint32_t samples)
+	{
+	Systronix_M24C32_sim			sim (400000);
+	gated_bus						bus (sim);
+	Systronix_M24C32_sim_mux		smux (0x70);
+	Systronix_M24C32_sim_device		board0 (0x50);
+	Systronix_M24C32_sim_device		board1 (0x50);
+	Systronix_M24C32_sim_device		root (0x51);
+	sim_sensor						tmp (0x48);
+
+	Systronix_M24C32_sched			sched;
+	eep_sched_os					os = {NULL, os_lock, os_unlock, os_wait, os_notify};
+	Systronix_M24C32_sched_client	boards_client;
+	Systronix_M24C32_sched_client	root_client;
+	Systronix_M24C32_sched_client	sensor_client;
+	Systronix_M24C32				boards;
+	Systronix_M24C32				eep;
+	Systronix_M24C32_mux			map;
+
+	static uint8_t		shadow[4096];
+	std::atomic<uint64_t>	bulk (0);
+	std::vector<double>	latency;
+	uint64_t			t0;
+	uint64_t			due;
+	uint64_t			t_end;
+	uint32_t			seed = 3;
+
+	sim.attach (smux);
+	sim.attach (root);
+	smux.attach (0, board0);
+	smux.attach (1, board1);
+	smux.attach (2, tmp);
+	for (uint32_t i=0; i<4096; i++)
+		{
+		board0.mem[i] = (uint8_t)(i * 3);
+		board1.mem[i] = (uint8_t)((i * 5) + 1);
+		root.mem[i] = (uint8_t)(i ^ 0xA5);
+		}
+	memcpy (shadow, root.mem, sizeof(shadow));
+
+	sched.setup (bus);
+	sched.os_set (os);
+	boards_client.setup (sched, priority ? EEP_PRIO_BULK : EEP_PRIO_NORMAL);
+	root_client.setup (sched, priority ? EEP_PRIO_BULK : EEP_PRIO_NORMAL);
+	sensor_client.setup (sched, priority ? EEP_PRIO_SENSOR : EEP_PRIO_NORMAL);
+	boards_client.split_reads (split);
+	root_client.split_reads (split);
+
+	boards.setup (0x50, boards_client, (char*)"boards");
+	eep.setup (0x51, root_client, (char*)"root");
+	boards.begin ();
+	eep.begin ();
+	sim.clock_set (400000);								// begin() set the default rate
+	map.setup (boards_client);
+	map.add (0x70, 0, boards);
+	map.add (0x70, 1, boards);
+	map.init ();
+	map.select (0);
+	boards.init ();
+	eep.init ();
+
+	t0 = sim.now_ns ();
+	sim_now = t0;
+	due = t0 + PERIOD_NS;
+	stop = false;
+	sensor_queued = false;
+	gate_due = due;
+	gate_armed = true;
+
+	std::thread boards_thread ([&]
+		{
+		static uint8_t	buf[4096];
+
+		while (!stop)
+			for (uint8_t node=0; (node<2) && !stop; node++)
+				{
+				memset (buf, 0, sizeof(buf));
+				if ((SUCCESS != map.read (node, 0, buf, sizeof(buf))) || memcmp (buf, node ? board1.mem : board0.mem, sizeof(buf)))
+					bad++;
+				bulk += sizeof(buf);
+				}
+		});
+
+	std::thread root_thread ([&]
+		{
+		static uint8_t	buf[4096];
+		uint8_t			page[32];
+		uint32_t		x = 7;
+		uint16_t		addr;
+
+		while (!stop)
+			{
+			x = (x * 1103515245) + 12345;
+			addr = ((x >> 8) % 128) * 32;
+			for (uint8_t i=0; i<32; i++)
+				page[i] = (uint8_t)((x >> (i & 15)) + i);
+			if (SUCCESS != eep.write (addr, page, sizeof(page)))
+				bad++;
+			memcpy (&shadow[addr], page, sizeof(page));
+			if ((SUCCESS != eep.read (0, buf, sizeof(buf))) || memcmp (buf, shadow, sizeof(buf)))
+				bad++;
+			bulk += sizeof(buf) + sizeof(page);
+			}
+		});
+
+	is_sensor = true;
+	for (uint32_t k=0; k<samples; k++)
+		{
+		uint8_t	ptr;
+		uint8_t	data[2] = {0, 0};
+
+		while (sim_now < due)
+			std::this_thread::yield ();
+
+		seed = (seed * 1103515245) + 12345;
+		ptr = (seed >> 16) & 3;
+		sensor_client.hold ();							// mux port and sensor read as one sequence
+		sensor_client.beginTransmission (0x70);
+		sensor_client.write (1 << 2);
+		if (sensor_client.endTransmission ())
+			bad++;
+		sensor_client.beginTransmission (0x48);
+		sensor_client.write (ptr);
+		if (sensor_client.endTransmission (I2C_NOSTOP))
+			bad++;
+		if (2 != sensor_client.requestFrom (0x48, 2, I2C_STOP))
+			bad++;
+		sensor_client.read (data, 2);
+		if ((ptr != data[0]) || ((uint8_t)~ptr != data[1]))
+			bad++;
+
+		t_end = sim.now_ns ();
+		latency.push_back ((t_end - due) / 1e6);
+		due = t_end + PERIOD_NS + ((seed >> 8) % 1000) * 1000;
+		sensor_queued = false;							// arm the gate for the next reading before letting go
+		gate_due = due;
+		sensor_client.release ();
+		}
+	is_sensor = false;
+	stop = true;
+	boards_thread.join ();
+	root_thread.join ();
+
+	std::sort (latency.begin (), latency.end ());
+	double	sum = 0;
+	for (size_t i=0; i<latency.size (); i++)
+		sum += latency[i];
+
+	printf ("%-20s %8.2f %8.2f %8.2f   %8.1f   %6u %7u %6u %9u\n", name, sum / latency.size (),
+		latency[(latency.size () * 99) / 100], latency.back (), bulk / 1024.0 / ((sim.now_ns () - t0) / 1e9),
+		sched.stats.splits, map.stats.epoch_resets, sched.stats.contended, sched.stats.grants);
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	uint32_t	samples = (1 < argc) ? atoi (argv[1]) : 1000;
+
+	if (0 == samples)
+		samples = 1;
+	printf ("sensor latency (reading due to data in hand), simulated ms; %u readings each\n\n", samples);
+	printf ("%-20s %8s %8s %8s   %8s   %6s %7s %6s %9s\n", "", "mean", "p99", "max", "bulk KB/s", "splits", "remuxes", "waits", "grants");
+	run ("fifo", false, false, samples);
+	run ("priority", true, false, samples);
+	run ("priority + split", true, true, samples);
+
+	printf ("\n%s\n", bad ? "FAIL" : "ok");
+	return bad ? 1 : 0;
+	}
@@ -0,0 +1,196 @@
+//
+// seg_bench.cpp
+//
+// readv() and writev() on a simulated M24C32 (tW 5ms) and a simulated MB85RC256V FRAM at 400kHz.
+//
+// The bench: 32 configuration fields of 1 to 8 bytes, naturally aligned, spread over 0x400 - 0x4D2 with a few
+// gaps, are written with one write() per field and then with one writev(), and read with one read() per field
+// and then with one readv().  It reports simulated time, transactions, and the seg_stats counts.
+//
+// The check: 300 random readv() / writev() calls of 1 - EEP_SEG_MAX segments (mostly short, some up to 300
+// bytes; overlapping, adjacent, and in any order) on an M24C32, an M24M02, and the FRAM, against a model of
+// each array: every readv() must return what the model holds and after every writev() the simulated array
+// must equal the model, later segments winning where they overlap.  Segments that run past the end of the
+// array must be DENIED.
+//
+// Any mismatch exits with status 1.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/seg_bench/seg_bench.cpp Systronix_M24C32*.cpp -o seg_bench && ./seg_bench [seed]
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_fram.h>
+#include <Systronix_M24C32_sim.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define		FIELDS			32
+#define		CHECK_CALLS		300
+#define		SEG_LEN_MAX		300
+
+static uint8_t		model[EEP_SIZE_MAX];
+static uint8_t		seg_buf[EEP_SEG_MAX][SEG_LEN_MAX];
+
+
+//---------------------------< C H E C K >--------------------------------------------------------------------
+//
+// random readv() / writev() on nv, whose simulated array is mem; returns the number of mismatches
+//
+
+static uint32_t check (Systronix_M24C32_nvram& nv, uint8_t* mem, const char* name)
+	{
+	struct eep_seg	seg[EEP_SEG_MAX];
+	struct eep_seg	past_end;
+	uint32_t	size = nv.size ();
+	uint32_t	bad = 0;
+	uint32_t	base;
+	uint8_t		count;
+
+	memcpy (model, mem, size);
+	for (uint32_t call=0; call<CHECK_CALLS; call++)
+		{
+		count = 1 + (rand () % EEP_SEG_MAX);
+		base = rand () % (size - 2048);
+		for (uint8_t i=0; i<count; i++)
+			{
+			seg[i].addr = base + (rand () % 1500);
+			seg[i].len = rand () % ((rand () % 8) ? 12 : SEG_LEN_MAX);
+			seg[i].buf = seg_buf[i];
+			for (size_t k=0; k<seg[i].len; k++)
+				seg_buf[i][k] = (uint8_t)rand ();
+			}
+
+		if (call & 1)
+			{
+			if (SUCCESS != nv.writev (seg, count))
+				bad++;
+			for (uint8_t i=0; i<count; i++)				// list order: later segments win
+				memcpy (&model[seg[i].addr], seg[i].buf, seg[i].len);
+			if (memcmp (model, mem, size))
+				{
+				printf ("%s: writev() %u of %u segments at 0x%05X left the array different from the model\n", name, call, count, base);
+				memcpy (model, mem, size);
+				bad++;
+				}
+			}
+		else
+			{
+			if (SUCCESS != nv.readv (seg, count))
+				bad++;
+			for (uint8_t i=0; i<count; i++)
+				if (memcmp (&model[seg[i].addr], seg[i].buf, seg[i].len))
+					{
+					printf ("%s: readv() %u segment %u (0x%05X, %u bytes) differs from the model\n", name, call, i, seg[i].addr, (unsigned)seg[i].len);
+					bad++;
+					}
+			}
+		}
+
+	past_end.addr = size - 1;
+	past_end.buf = seg_buf[0];
+	past_end.len = 2;
+	if ((DENIED != nv.readv (&past_end, 1)) || (DENIED != nv.writev (&past_end, 1)))
+		bad++;
+
+	printf ("%-8s %u random readv() / writev() calls: %u mismatched\n", name, CHECK_CALLS, bad);
+	return bad;
+	}
+
+
+//---------------------------< B E N C H >--------------------------------------------------------------------
+//
+// the configuration fields on nv, one field at a time and then vectored
+//
+
+static void bench (Systronix_M24C32_nvram& nv, Systronix_M24C32_sim& bus, const struct eep_seg* field, const char* name)
+	{
+	uint64_t	t0;
+
+	printf ("%s\n", name);
+
+	bus.advance (10000);
+	bus.stats_clear ();
+	t0 = bus.now_ns ();
+	for (uint8_t i=0; i<FIELDS; i++)
+		nv.read (field[i].addr, field[i].buf, field[i].len);
+	printf ("  read() each field  %7.2f ms  %5u transactions\n", (bus.now_ns () - t0) / 1e6, bus.stats.transactions);
+
+	memset (&nv.seg_stats, 0, sizeof(nv.seg_stats));
+	bus.stats_clear ();
+	t0 = bus.now_ns ();
+	nv.readv (field, FIELDS);
+	printf ("  readv()            %7.2f ms  %5u transactions  (%u runs, %u reads)\n", (bus.now_ns () - t0) / 1e6,
+		bus.stats.transactions, nv.seg_stats.runs, nv.seg_stats.reads);
+
+	bus.stats_clear ();
+	t0 = bus.now_ns ();
+	for (uint8_t i=0; i<FIELDS; i++)
+		nv.write (field[i].addr, field[i].buf, field[i].len);
+	printf ("  write() each field %7.2f ms  %5u transactions  (%u writes)\n", (bus.now_ns () - t0) / 1e6,
+		bus.stats.transactions, FIELDS);
+
+	bus.advance (10000);
+	bus.stats_clear ();
+	t0 = bus.now_ns ();
+	nv.writev (field, FIELDS);
+	printf ("  writev()           %7.2f ms  %5u transactions  (%u page writes, %u read-backs)\n", (bus.now_ns () - t0) / 1e6,
+		bus.stats.transactions, nv.seg_stats.page_writes, nv.seg_stats.read_backs);
+	}
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	Systronix_M24C32_sim		bus (400000);
+	Systronix_M24C32_sim_device	dev (0x50);
+	Systronix_M24C32_sim_device	big_dev (0x54, EEP_M24M02);
+	Systronix_M24C32_sim_fram	fram_dev (0x51);
+	Systronix_M24C32			eep;
+	Systronix_M24C32			big_eep;
+	Systronix_M24C32_fram		fram;
+	struct eep_seg	field[FIELDS];
+	static uint8_t	value[FIELDS][8];
+	uint32_t	seed = (1 < argc) ? strtoul (argv[1], NULL, 0) : 7;
+	uint32_t	addr = 0x400;
+	uint32_t	bad = 0;
+
+	bus.attach (dev);
+	bus.attach (big_dev);
+	bus.attach (fram_dev);
+	eep.setup (0x50, bus);
+	eep.init ();
+	big_eep.setup (0x54, bus);
+	big_eep.part_set (EEP_M24M02);
+	big_eep.init ();
+	fram.setup (0x51, bus);
+	fram.init ();
+
+	srand (3);
+	for (uint8_t i=0; i<FIELDS; i++)						// 1, 2, 4, or 8 bytes, naturally aligned; some gaps
+		{
+		field[i].len = 1 << (rand () % 4);
+		addr = (addr + field[i].len - 1) & ~(field[i].len - 1);
+		field[i].addr = addr;
+		field[i].buf = value[i];
+		addr += field[i].len + ((rand () % 3) ? 0 : (rand () % 12));
+		for (uint8_t k=0; k<8; k++)
+			value[i][k] = (uint8_t)rand ();
+		}
+	printf ("%u fields, 0x400 - 0x%03X, 400kHz\n", FIELDS, addr);
+	bench (eep, bus, field, "eeprom");
+	bench (fram, bus, field, "FRAM");
+
+	printf ("\nseed %u\n", seed);
+	srand (seed);
+	for (uint32_t i=0; i<dev.size (); i++)
+		dev.mem[i] = (uint8_t)(i * 7);
+	for (uint32_t i=0; i<big_dev.size (); i++)
+		big_dev.mem[i] = (uint8_t)(i * 3);
+	bus.advance (10000);
+	bad += check (eep, dev.mem, "M24C32");
+	bad += check (big_eep, big_dev.mem, "M24M02");
+	bad += check (fram, fram_dev.mem, "MB85RC");
+	return bad ? 1 : 0;
+	}
@@ -0,0 +1,594 @@
+//
+// trace_replay.cpp
+//
+// Offline replay of a Systronix_M24C32_trace capture.  The input is one or more dump() streams back to back (a
+// program that dumps and clears the ring whenever it fills writes several).  The tool rebuilds the bus from the
+// capture, replays every transaction on the simulator, in order and with the captured idle time between them,
+// and reports captured against replayed time by class of transaction:
+//		mux control		writes and reads of a PCA9548A (0x70 - 0x77)
+//		address set		two-byte writes: a random read's address phase (usually NOSTOP)
+//		read			master reads
+//		page write		writes of data; len includes the two address bytes
+//		ack poll wait	a run of writes nacked at the address, to the start of the one that was acked; the replay
+//						retries that one, back to back, until the simulated device acks it
+//		probe			an acked address-only write (an ack poll, a presence check)
+//		other			anything else (a generic slave's traffic, a write nacked mid-way)
+// and bus utilisation, nacked poll counts, and transactions whose status differs in the replay.
+//
+// The bus is rebuilt from the addresses that acked: 0x70 - 0x77 are muxes; an address acked while every mux
+// port was closed is on the main bus (so is any -R address); any other is placed behind the lowest port open at
+// the time, one device per port.  0x50 - 0x57 are simulated M24C32s (write cycle -w, default the part's tW), the
+// rest slaves that ack everything and read 0xFF.  Written data past the two bytes in each record is replayed as
+// 0xFF; contents do not change the timing.  Non-blocking transactions are replayed blocking; their captured
+// time runs to the done() that saw them end.
+//
+// -d runs a demo workload (a mux map of two boards behind a PCA9548A and an eeprom on the main bus, page writes
+// and reads) through the recorder on the simulator with write cycle -W, writes its dumps to the file, and then
+// replays it.  With -W equal to -w the replay should match the capture.  -d needs the recorder compiled in
+// (EEP_TRACE 1, the default); built with EEP_TRACE 0 the tool only replays.
+//
+// Exits with status 1 when a transaction's status differs in the replay or a demo read is wrong.
+//
+// build and run from the library root:
+//		g++ -std=gnu++14 -O2 -I. extras/trace_replay/trace_replay.cpp Systronix_M24C32*.cpp -o trace_replay
+//		./trace_replay [-r hz] [-w tw_us] [-R addr]... [-v] trace.bin		replay a capture
+//		./trace_replay -d trace.bin [-W tw_us] [-w tw_us] [-v]				demo capture, then replay
+//
+
+#include <Systronix_M24C32.h>
+#include <Systronix_M24C32_mux.h>
+#include <Systronix_M24C32_sim.h>
+#include <Systronix_M24C32_trace.h>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define		CL_MUX			0
+#define		CL_ADDR			1
+#define		CL_READ			2
+#define		CL_WRITE		3
+#define		CL_POLL			4
+#define		CL_PROBE		5
+#define		CL_OTHER		6
+#define		CLASSES			7
+
+#define		POLLS_MAX		65535						// give up on a replayed ack poll after this many nacks
+
+static const char*	class_name[CLASSES] = {"mux control", "address set", "read", "page write", "ack poll wait", "probe", "other"};
+
+#if EEP_TRACE
+static FILE*	dump_file;
+#endif
+
+static struct
+	{
+	uint32_t	hz;										// 0: from the capture
+	uint32_t	tw_us;									// 0: the part's tW
+	boolean		root[128];								// -R
+	boolean		verbose;
+	} opt;
+
+
+//---------------------------< A C K   S L A V E >------------------------------------------------------------
+//
+// stands in for anything that is not an eeprom
+//
+
+class ack_slave : public Systronix_M24C32_sim_slave
+	{
+	public:
+		ack_slave (uint8_t addr) {address = addr;}
+
+		boolean		select (boolean read, uint64_t now) {(void)read; (void)now; return true;}
+		boolean		receive (uint8_t data, uint64_t now) {(void)data; (void)now; return true;}
+		uint8_t		transmit (uint64_t now) {(void)now; return 0xFF;}
+		void		stop (uint64_t now) {(void)now;}
+	};
+
+
+//---------------------------< I S   M U X >------------------------------------------------------------------
+
+static boolean is_mux (uint8_t addr)
+	{
+	return (0x70 <= addr) && (0x77 >= addr);
+	}
+
+
+//---------------------------< L O A D >----------------------------------------------------------------------
+//
+// every dump in the file; false on a malformed one
+//
+
+static boolean load (const char* path, std::vector<struct eep_trace_rec>& recs, uint32_t* hz, uint32_t* dropped, uint32_t* dumps)
+	{
+	FILE*					in = fopen (path, "rb");
+	struct eep_trace_header	header;
+	struct eep_trace_rec	rec;
+	size_t					n;
+
+	if (!in)
+		{
+		perror (path);
+		return false;
+		}
+
+	while (0 != (n = fread (&header, 1, sizeof(header), in)))
+		{
+		if ((sizeof(header) != n) || memcmp (header.magic, EEP_TR_MAGIC, sizeof(header.magic)) ||
+			(EEP_TR_VERSION != header.version) || (sizeof(rec) != header.rec_size))
+			{
+			fprintf (stderr, "%s: dump %u: bad header\n", path, *dumps);
+			fclose (in);
+			return false;
+			}
+		for (uint16_t i=0; i<header.count; i++)
+			{
+			if (1 != fread (&rec, sizeof(rec), 1, in))
+				{
+				fprintf (stderr, "%s: dump %u: %u of %u records\n", path, *dumps, i, header.count);
+				fclose (in);
+				return false;
+				}
+			recs.push_back (rec);
+			}
+		if (!*hz)
+			*hz = header.hz;
+		*dropped += header.dropped;
+		(*dumps)++;
+		}
+	fclose (in);
+	return true;
+	}
+
+
+//---------------------------< C L A S S I F Y >--------------------------------------------------------------
+
+static uint8_t classify (const struct eep_trace_rec& rec)
+	{
+	if (is_mux (rec.addr & 0x7F))
+		return CL_MUX;
+	if (rec.flags & EEP_TR_POLL)
+		return CL_POLL;
+	if (rec.addr & EEP_TR_READ)
+		return CL_READ;
+	if (I2C_WAITING != (rec.flags & EEP_TR_STATUS))
+		return CL_OTHER;
+	if (0 == rec.len)
+		return CL_PROBE;
+	if (2 == rec.len)
+		return CL_ADDR;
+	if (2 < rec.len)
+		return CL_WRITE;
+	return CL_OTHER;
+	}
+
+
+//---------------------------< M A K E   S L A V E >----------------------------------------------------------
+
+static Systronix_M24C32_sim_slave* make_slave (uint8_t addr)
+	{
+	Systronix_M24C32_sim_device*	eep;
+
+	if ((0x50 > addr) || (0x57 < addr))
+		return new ack_slave (addr);
+
+	eep = new Systronix_M24C32_sim_device (addr);
+	if (opt.tw_us)
+		eep->tw_us = opt.tw_us;
+	return eep;
+	}
+
+
+//---------------------------< X F E R >----------------------------------------------------------------------
+//
+// one recorded transaction onto the simulator; returns its i2c_status
+//
+
+static uint8_t xfer (Systronix_M24C32_sim& sim, const struct eep_trace_rec& rec)
+	{
+	uint8_t		addr = rec.addr & 0x7F;
+	i2c_stop	stop = (rec.flags & EEP_TR_NOSTOP) ? I2C_NOSTOP : I2C_STOP;
+
+	if (rec.addr & EEP_TR_READ)
+		sim.requestFrom (addr, rec.len, stop);
+	else
+		{
+		sim.beginTransmission (addr);
+		for (uint16_t j=0; j<rec.len; j++)
+			sim.write ((2 > j) ? (uint8_t)(rec.data >> (8 * j)) : 0xFF);
+		sim.endTransmission (stop);
+		}
+	return sim.status () & EEP_TR_STATUS;
+	}
+
+
+//---------------------------< R E P L A Y >------------------------------------------------------------------
+//
+// rebuild the bus, replay recs, print the breakdown; returns the number of status mismatches
+//
+
+static uint32_t replay (const char* path, std::vector<struct eep_trace_rec>& recs, uint32_t hz, uint32_t dropped, uint32_t dumps)
+	{
+	Systronix_M24C32_sim				sim;
+	std::vector<Systronix_M24C32_sim_slave*>	slaves;
+	Systronix_M24C32_sim_mux*			mux[8] = {NULL};
+	boolean								root[128] = {false};
+	uint8_t								ports[128] = {0};		// per address, the mux 0 - 7 ports it sits behind
+	uint8_t								port_mux[128][8];		// which mux for each of those ports
+	uint8_t								control[8] = {0};
+
+	struct
+		{
+		uint32_t	count;
+		double		cap_us;
+		double		cap_max;
+		double		rep_us;
+		double		rep_max;
+		} cl[CLASSES];
+
+	double		cap_busy = 0;
+	double		rep_busy = 0;
+	uint32_t	cap_spins = 0;
+	uint32_t	rep_spins = 0;
+	uint32_t	saturated = 0;
+	uint32_t	mismatches = 0;
+	uint64_t	rep_start;
+	uint32_t	prev_end = 0;
+	boolean		carried = false;					// the next record has been replayed already
+	double		carried_rep = 0;
+	uint8_t		carried_status = 0;
+
+	memset (cl, 0, sizeof(cl));
+	memset (port_mux, 0, sizeof(port_mux));
+
+	if (0 == recs.size ())
+		{
+		printf ("%s: no records\n", path);
+		return 0;
+		}
+
+	for (size_t i=0; i<recs.size (); i++)			// who acked, and where
+		{
+		uint8_t	addr = recs[i].addr & 0x7F;
+		uint8_t	m;
+
+		if (I2C_WAITING != (recs[i].flags & EEP_TR_STATUS))
+			continue;
+		if (is_mux (addr))
+			{
+			if (!mux[addr & 7])
+				mux[addr & 7] = new Systronix_M24C32_sim_mux (addr);
+			if (!(recs[i].addr & EEP_TR_READ) && recs[i].len)
+				control[addr & 7] = (uint8_t)recs[i].data;
+			continue;
+			}
+		for (m=0; (m<8) && !control[m]; m++)
+			;
+		if ((8 == m) || opt.root[addr])
+			root[addr] = true;
+		else
+			{
+			uint8_t	port = 0;
+			while (!(control[m] & (1 << port)))
+				port++;
+			ports[addr] |= 1 << port;
+			port_mux[addr][port] = m;
+			}
+		}
+
+	sim.begin ();
+	sim.clock_set (hz);								// begin() set the default rate
+	printf ("%s: %u records in %u dump(s), %u dropped; %u Hz\n  bus:", path, (uint32_t)recs.size (), dumps, dropped, hz);
+	for (uint8_t a=0; a<128; a++)					// main bus first so that a mux port cannot shadow it
+		if (root[a])
+			{
+			slaves.push_back (make_slave (a));
+			sim.attach (*slaves.back ());
+			printf (" 0x%02X", a);
+			}
+	for (uint8_t m=0; m<8; m++)
+		if (mux[m])
+			{
+			sim.attach (*mux[m]);
+			printf (" mux 0x%02X", mux[m]->address);
+			}
+	for (uint8_t a=0; a<128; a++)
+		for (uint8_t p=0; (p<8) && !root[a]; p++)
+			if (ports[a] & (1 << p))
+				{
+				slaves.push_back (make_slave (a));
+				mux[port_mux[a][p]]->attach (p, *slaves.back ());
+				printf (" 0x%02X:%u 0x%02X", mux[port_mux[a][p]]->address, p, a);
+				}
+	printf ("\n");
+	if (dropped)
+		printf ("  the capture starts mid-stream; the first transactions may not replay as captured\n");
+
+	rep_start = sim.now_ns ();
+	for (size_t i=0; i<recs.size (); i++)
+		{
+		const struct eep_trace_rec&	rec = recs[i];
+		uint8_t		k = classify (rec);
+		uint8_t		expect = rec.flags & EEP_TR_STATUS;
+		uint8_t		status;
+		double		cap = rec.dur;
+		double		rep;
+		uint32_t	spins = 0;
+		int32_t		gap = (int32_t)(rec.t - prev_end);
+		uint64_t	t0;
+
+		if (0xFFFF == rec.dur)
+			saturated++;
+
+		if (carried)								// replayed as the end of the wait before it
+			{
+			rep = carried_rep;
+			status = carried_status;
+			carried = false;
+			}
+		else
+			{
+			if (i && (0 < gap))
+				sim.advance (gap);					// the time the captured program spent between transactions
+			t0 = sim.now_ns ();
+			if (CL_POLL == k)
+				{
+				struct eep_trace_rec	attempt = rec;
+				boolean		ended = (i + 1 < recs.size ()) && (rec.addr == recs[i+1].addr) &&
+								!(recs[i+1].flags & (EEP_TR_POLL | EEP_TR_STATUS));
+				uint64_t	t1;
+
+				if (ended)							// retry the transaction that was finally acked
+					{
+					attempt = recs[i+1];
+					cap = recs[i+1].t - rec.t;
+					expect = I2C_WAITING;
+					}
+				else								// an unanswered wait: poll as many times as it did
+					attempt.len = 0;
+
+				for (;;)
+					{
+					t1 = sim.now_ns ();
+					status = xfer (sim, attempt);
+					if (I2C_WAITING == status)
+						break;
+					if ((ended ? POLLS_MAX : rec.len) <= ++spins)
+						break;
+					}
+				if (ended && (I2C_WAITING == status))
+					{
+					carried = true;
+					carried_rep = (sim.now_ns () - t1) / 1000.0;
+					carried_status = status;
+					rep = (t1 - t0) / 1000.0;
+					}
+				else
+					rep = (sim.now_ns () - t0) / 1000.0;
+				cap_spins += rec.len;
+				rep_spins += spins;
+				}
+			else
+				{
+				status = xfer (sim, rec);
+				rep = (sim.now_ns () - t0) / 1000.0;
+				}
+			}
+		prev_end = rec.t + rec.dur;
+
+		if (expect != status)
+			mismatches++;
+
+		cl[k].count++;
+		cl[k].cap_us += cap;
+		cl[k].rep_us += rep;
+		if (cap > cl[k].cap_max)
+			cl[k].cap_max = cap;
+		if (rep > cl[k].rep_max)
+			cl[k].rep_max = rep;
+		cap_busy += cap;
+		rep_busy += rep;
+
+		if (opt.verbose)
+			printf ("  %6u %10u  %-13s 0x%02X %c %5u  %2u/%-2u  %8.0f %10.1f%s\n", (uint32_t)i, rec.t, class_name[k],
+				rec.addr & 0x7F, (rec.addr & EEP_TR_READ) ? 'r' : 'w', rec.len, expect, status, cap, rep,
+				((CL_POLL == k) && (spins != rec.len)) ? "  polls differ" : "");
+		}
+
+	double	cap_span = prev_end - recs[0].t;
+	double	rep_span = (sim.now_ns () - rep_start) / 1000.0;
+
+	printf ("  %-14s %6s   %12s %9s %9s   %12s %9s %9s %8s\n", "", "count", "captured ms", "mean us", "max us",
+		"replayed ms", "mean us", "max us", "delta");
+	for (uint8_t k=0; k<CLASSES; k++)
+		{
+		if (!cl[k].count)
+			continue;
+		printf ("  %-14s %6u   %12.2f %9.1f %9.0f   %12.2f %9.1f %9.1f %7.1f%%\n", class_name[k], cl[k].count,
+			cl[k].cap_us / 1000, cl[k].cap_us / cl[k].count, cl[k].cap_max,
+			cl[k].rep_us / 1000, cl[k].rep_us / cl[k].count, cl[k].rep_max,
+			cl[k].cap_us ? 100 * (cl[k].rep_us - cl[k].cap_us) / cl[k].cap_us : 0.0);
+		}
+	printf ("  span %.2f ms captured, %.2f ms replayed; in transactions %.1f%% / %.1f%%; bus driven %.1f%% in the replay\n",
+		cap_span / 1000, rep_span / 1000, 100 * cap_busy / cap_span, 100 * rep_busy / rep_span,
+		100 * (sim.stats.busy_ns / 1000.0) / rep_span);
+	printf ("  nacked polls %u captured, %u replayed; %u duration(s) saturated; %u status mismatch(es)\n",
+		cap_spins, rep_spins, saturated, mismatches);
+
+	for (size_t i=0; i<slaves.size (); i++)
+		delete slaves[i];
+	for (uint8_t m=0; m<8; m++)
+		delete mux[m];
+	return mismatches;
+	}
+
+
+#if EEP_TRACE
+//---------------------------< D U M P   O U T >--------------------------------------------------------------
+
+static void dump_out (const uint8_t* data, size_t len)
+	{
+	fwrite (data, 1, len, dump_file);
+	}
+
+
+//---------------------------< D E M O >----------------------------------------------------------------------
+//
+// capture a representative workload to path; returns the number of bad reads, or -1 when path cannot be written
+//
+
+static int demo (const char* path, uint32_t tw_us)
+	{
+	Systronix_M24C32_sim			sim (400000);
+	Systronix_M24C32_sim_mux		smux (0x70);
+	Systronix_M24C32_sim_device		board0 (0x50);
+	Systronix_M24C32_sim_device		board1 (0x50);
+	Systronix_M24C32_sim_device		root_eep (0x51);
+	Systronix_M24C32_sim_device*	dev[3] = {&board0, &board1, &root_eep};
+	Systronix_M24C32_trace			trace;
+	Systronix_M24C32				boards;
+	Systronix_M24C32				eep;
+	Systronix_M24C32_mux			map;
+
+	uint8_t		buf[512];
+	uint8_t		page[96];
+	uint32_t	x = 11;
+	int			bad = 0;
+
+	dump_file = fopen (path, "wb");
+	if (!dump_file)
+		{
+		perror (path);
+		return -1;
+		}
+
+	sim.attach (root_eep);
+	sim.attach (smux);
+	smux.attach (0, board0);
+	smux.attach (1, board1);
+	for (uint8_t d=0; d<3; d++)
+		{
+		dev[d]->tw_us = tw_us;
+		for (uint32_t i=0; i<4096; i++)
+			dev[d]->mem[i] = (uint8_t)((i * (d + 3)) + d);
+		}
+
+	trace.setup (sim);
+	trace.hz_set (400000);
+	boards.setup (0x50, trace, (char*)"boards");
+	eep.setup (0x51, trace, (char*)"main");
+	boards.begin ();
+	eep.begin ();
+	sim.clock_set (400000);							// begin() set the default rate
+	map.setup (trace);
+	map.add (0x70, 0, boards);
+	map.add (0x70, 1, boards);
+	map.add (EEP_MUX_ROOT, 0, eep);
+	map.init ();
+	map.select (0);
+	boards.init ();
+	map.select (2);
+	eep.init ();
+
+	for (uint32_t round=0; round<40; round++)
+		for (uint8_t node=0; node<3; node++)
+			{
+			uint32_t	addr;
+			size_t		len;
+
+			if ((EEP_TRACE_DEPTH - 64) < trace.count ())
+				{
+				trace.dump (dump_out);				// what a target would send over Serial
+				trace.clear ();
+				}
+
+			x = (x * 1103515245) + 12345;
+			len = (round & 3) ? 32 : sizeof(page);		// a page, or three that straddle page boundaries
+			addr = (round & 3) ? (((x >> 8) % 128) * 32) : (((x >> 8) % 4000) & ~1);
+			for (size_t i=0; i<len; i++)
+				page[i] = (uint8_t)((x >> (i & 15)) + i);
+			if (SUCCESS != map.write (node, addr, page, len))
+				bad++;
+			sim.advance (200 + ((x >> 4) % 300));		// work between accesses
+
+			addr = ((x >> 12) % 8) * 512;
+			if ((SUCCESS != map.read (node, addr, buf, sizeof(buf))) || memcmp (buf, &dev[node]->mem[addr], sizeof(buf)))
+				bad++;
+			sim.advance (100 + ((x >> 16) % 200));
+			}
+
+	trace.dump (dump_out);
+	fclose (dump_file);
+	printf ("demo: %u transactions recorded, tW %u us; %d bad read(s)\n", sim.stats.transactions, tw_us, bad);
+	return bad;
+	}
+
+#else	// EEP_TRACE
+
+static int demo (const char* path, uint32_t tw_us)
+	{
+	(void)path;
+	(void)tw_us;
+	fprintf (stderr, "-d needs the recorder; build with EEP_TRACE 1\n");	// replay of a capture still works
+	return -1;
+	}
+#endif	// EEP_TRACE
+
+
+//---------------------------< M A I N >----------------------------------------------------------------------
+
+int main (int argc, char** argv)
+	{
+	std::vector<struct eep_trace_rec>	recs;
+	const char*	path = NULL;
+	const char*	demo_path = NULL;
+	uint32_t	demo_tw = 5000;
+	uint32_t	hz = 0;
+	uint32_t	dropped = 0;
+	uint32_t	dumps = 0;
+	int			bad = 0;
+
+	memset (&opt, 0, sizeof(opt));
+	for (int i=1; i<argc; i++)
+		{
+		if (!strcmp (argv[i], "-r") && (i + 1 < argc))
+			opt.hz = strtoul (argv[++i], NULL, 0);
+		else if (!strcmp (argv[i], "-w") && (i + 1 < argc))
+			opt.tw_us = strtoul (argv[++i], NULL, 0);
+		else if (!strcmp (argv[i], "-W") && (i + 1 < argc))
+			demo_tw = strtoul (argv[++i], NULL, 0);
+		else if (!strcmp (argv[i], "-R") && (i + 1 < argc))
+			opt.root[strtoul (argv[++i], NULL, 0) & 0x7F] = true;
+		else if (!strcmp (argv[i], "-d") && (i + 1 < argc))
+			demo_path = argv[++i];
+		else if (!strcmp (argv[i], "-v"))
+			opt.verbose = true;
+		else
+			path = argv[i];
+		}
+
+	if (demo_path)
+		{
+		bad = demo (demo_path, demo_tw);
+		if (0 > bad)
+			return 1;
+		path = demo_path;
+		}
+	if (!path)
+		{
+		fprintf (stderr, "usage: %s [-r hz] [-w tw_us] [-R addr]... [-v] trace.bin\n"
+			"       %s -d trace.bin [-W tw_us] [-w tw_us] [-v]\n", argv[0], argv[0]);
+		return 1;
+		}
+
+	if (!load (path, recs, &hz, &dropped, &dumps))
+		return 1;
+	if (opt.hz)
+		hz = opt.hz;
+	if (!hz)
+		hz = 100000;								// i2c_t3's default rate
+
+	if (replay (path, recs, hz, dropped, dumps) || bad)
+		return 1;
+	return 0;
+	}